@@ -0,0 +1,75 @@
+#include <new>
+#include <cstdlib>
+#include <Benchmark.h>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// the counters of each thread, so counting needs no synchronization
+thread_local size_t numberOfAllocations = 0;
+thread_local size_t numberOfAllocatedBytes = 0;
+
+void* allocate( size_t size )
+{
+	numberOfAllocations++;
+	numberOfAllocatedBytes += size;
+	void* const memory = malloc( size == 0 ? 1 : size );
+	if( memory == nullptr ) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+} // end of anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+// the replaced global allocation functions count every allocation
+void* operator new( size_t size )
+{
+	return allocate( size );
+}
+
+void* operator new[]( size_t size )
+{
+	return allocate( size );
+}
+
+void operator delete( void* memory ) noexcept
+{
+	free( memory );
+}
+
+void operator delete[]( void* memory ) noexcept
+{
+	free( memory );
+}
+
+void operator delete( void* memory, size_t ) noexcept
+{
+	free( memory );
+}
+
+void operator delete[]( void* memory, size_t ) noexcept
+{
+	free( memory );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace MinesweeperBenchmark {
+
+size_t NumberOfAllocations()
+{
+	return numberOfAllocations;
+}
+
+size_t NumberOfAllocatedBytes()
+{
+	return numberOfAllocatedBytes;
+}
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
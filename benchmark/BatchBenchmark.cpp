@@ -0,0 +1,59 @@
+#include <iostream>
+#include <Benchmark.h>
+#include <MinesweeperBatch.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Generates batches of expert boards and plays every board by opening
+// its cells in order with the engine, compares with generation by games
+// usage: batch [boards] [threads]
+int BatchBenchmark( const vector<string>& arguments )
+{
+	const size_t rows = 16;
+	const size_t columns = 30;
+	const size_t bombs = 99;
+	const size_t boards = arguments.size() > 0 ? stoul( arguments[0] ) : 100000;
+	const size_t threads = arguments.size() > 1 ? stoul( arguments[1] ) : 0;
+
+	CMinesweeperBoardBatch batch;
+	TClock::time_point start = TClock::now();
+	batch.Generate( rows, columns, bombs, boards, 0, threads );
+	const double generation = ElapsedNanoseconds( start );
+
+	start = TClock::now();
+	batch.ForEachBoard(
+		[]( CMinesweeperEngine& engine, CMinesweeperBoardView& board, size_t ) {
+			CMinesweeperNullObserver observer;
+			for( size_t index = 0; index < board.PlaneSize()
+				&& board.State() == MGS_Active; index++ )
+			{
+				if( !board.IsOpened( index ) ) {
+					engine.Open( board, index, observer );
+				}
+			}
+		},
+		threads );
+	const double play = ElapsedNanoseconds( start );
+
+	shared_ptr<IMinesweeperGame> game = CreateGame( rows, columns, bombs );
+	start = TClock::now();
+	for( size_t i = 0; i < boards; i++ ) {
+		game->NewGame( rows, columns, bombs, i );
+	}
+	const double games = ElapsedNanoseconds( start );
+
+	cout << "batch " << rows << "x" << columns << "/" << bombs
+		<< ": boards " << boards
+		<< ", generate " << generation / boards << " ns/board"
+		<< ", play " << play / boards << " ns/board"
+		<< "; NewGame " << games / boards << " ns/board" << endl;
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
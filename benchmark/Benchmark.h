@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <Minesweeper.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+using namespace Minesweeper;
+
+typedef chrono::steady_clock TClock;
+
+// returns nanoseconds elapsed since start
+inline double ElapsedNanoseconds( TClock::time_point start )
+{
+	return chrono::duration<double, nano>( TClock::now() - start ).count();
+}
+
+// latency distribution of a set of measurements
+struct CLatency {
+	size_t Count;
+	double Mean;
+	double P50;
+	double P99;
+	double Max;
+};
+
+// sorts the samples and calculates the distribution
+CLatency CalculateLatency( vector<double>& samples );
+
+// number of allocations made by the calling thread since its start
+size_t NumberOfAllocations();
+// number of bytes requested by the allocations of the calling thread
+size_t NumberOfAllocatedBytes();
+
+////////////////////////////////////////////////////////////////////////////////
+
+// per-click latency of clicks on maximum size boards
+int FloodFillBenchmark( const vector<string>& arguments );
+// generation and play of board batches
+int BatchBenchmark( const vector<string>& arguments );
+// games played by the solver on many threads, machine readable report
+int SelfPlayBenchmark( const vector<string>& arguments );
+// replay of recorded move logs
+int ReplayBenchmark( const vector<string>& arguments );
+// generation of boards solvable without guessing and their pool
+int NoGuessBenchmark( const vector<string>& arguments );
+// strategy sweeps on the work stealing simulation runner
+int SimulationBenchmark( const vector<string>& arguments );
+// lockstep stepping of the batched environment against games one by one
+int EnvironmentBenchmark( const vector<string>& arguments );
+// board encodings against cell queries after every open
+int EncodingBenchmark( const vector<string>& arguments );
+// churn of created games against the game pool
+int PoolBenchmark( const vector<string>& arguments );
+// game moves with the event sink against no sink
+int EventsBenchmark( const vector<string>& arguments );
+// latency and allocations of every game call across shapes and densities
+int LatencyBenchmark( const vector<string>& arguments );
+// checks of the library results against simple references
+int SelfCheck( const vector<string>& arguments );
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
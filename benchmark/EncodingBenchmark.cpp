@@ -0,0 +1,104 @@
+#include <iostream>
+#include <Benchmark.h>
+#include <MinesweeperRandom.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+enum TEncodingMethod {
+	EM_None, // the baseline, only plays the games
+	EM_Cells, // queries every cell through IMinesweeperCell
+	EM_Full,
+	EM_Incremental
+};
+
+// writes the codes of all cells like MBE_Codes through the cell interface
+void encodeByCells( const IMinesweeperGame& game, vector<int8_t>& codes )
+{
+	for( size_t row = 0; row < game.Rows(); row++ ) {
+		for( size_t column = 0; column < game.Columns(); column++ ) {
+			const IMinesweeperCell& cell = *game.Cell( row, column );
+			int8_t code = MCC_Closed;
+			if( cell.IsOpened() ) {
+				code = static_cast<int8_t>( cell.IsBomb() ? size_t( MCC_Bomb )
+					: cell.NumberOfNeighborBombs() );
+			} else if( cell.Label() == MCL_Bomb ) {
+				code = MCC_LabeledBomb;
+			} else if( cell.Label() == MCL_Question ) {
+				code = MCC_LabeledQuestion;
+			}
+			codes[row * game.Columns() + column] = code;
+		}
+	}
+}
+
+// plays the games by random opens and encodes the board after every open,
+// returns the nanoseconds of all games
+double play( IMinesweeperGame& game, size_t games, TEncodingMethod method,
+	TMinesweeperBoardEncoding encoding, size_t& encodes )
+{
+	const size_t rows = game.Rows();
+	const size_t columns = game.Columns();
+	vector<int8_t> codes( rows * columns );
+	vector<uint8_t> buffer( EncodedBoardSize( encoding, rows, columns ) );
+	encodes = 0;
+	const TClock::time_point start = TClock::now();
+	for( size_t i = 0; i < games; i++ ) {
+		game.NewGame( rows, columns, game.Bombs(), MixSeed( i ) );
+		CMinesweeperRandom random( MixSeed( games + i ) );
+		while( game.GameState() == MGS_Active ) {
+			game.Cell( random.Next( rows ), random.Next( columns ) )->Open();
+			switch( method ) {
+				case EM_None:
+					break;
+				case EM_Cells:
+					encodeByCells( game, codes );
+					break;
+				case EM_Full:
+				case EM_Incremental:
+					game.EncodeBoard( encoding, buffer.data(), buffer.size(),
+						method == EM_Incremental );
+					break;
+			}
+			encodes++;
+		}
+	}
+	return ElapsedNanoseconds( start );
+}
+
+} // end of anonymous namespace
+
+// Encodes expert boards after every random open by the cell interface,
+// by whole EncodeBoard calls and by incremental ones,
+// reports nanoseconds per encoding over the play without encoding
+// usage: encoding [games]
+int EncodingBenchmark( const vector<string>& arguments )
+{
+	const size_t games = arguments.size() > 0 ? stoul( arguments[0] ) : 20000;
+	shared_ptr<IMinesweeperGame> game = CreateGame( 16, 30, 99 );
+
+	size_t encodes = 0;
+	const double baseline = play( *game, games, EM_None, MBE_Codes, encodes );
+	const double cells = play( *game, games, EM_Cells, MBE_Codes, encodes );
+	cout << "encoding 16x30/99: games " << games << ", encodes " << encodes
+		<< ", cells " << ( cells - baseline ) / encodes << " ns" << endl;
+
+	const TMinesweeperBoardEncoding encodings[] = { MBE_Codes, MBE_Nibbles, MBE_OneHot };
+	const char* const names[] = { "codes", "nibbles", "one-hot" };
+	for( size_t i = 0; i < 3; i++ ) {
+		const double full = play( *game, games, EM_Full, encodings[i], encodes );
+		const double incremental = play( *game, games, EM_Incremental, encodings[i], encodes );
+		cout << names[i] << ": full " << ( full - baseline ) / encodes << " ns"
+			<< ", incremental " << ( incremental - baseline ) / encodes << " ns" << endl;
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
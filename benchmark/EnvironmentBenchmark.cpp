@@ -0,0 +1,90 @@
+#include <iostream>
+#include <Benchmark.h>
+#include <MinesweeperEnvironment.h>
+#include <MinesweeperRandom.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Plays random opens on expert boards in the batched environment and
+// on games one by one through the cells, the finished episodes are
+// restarted after every step, reports lane steps per second
+// usage: environment [lanes] [steps]
+int EnvironmentBenchmark( const vector<string>& arguments )
+{
+	const size_t rows = 16;
+	const size_t columns = 30;
+	const size_t bombs = 99;
+	const size_t lanes = arguments.size() > 0 ? stoul( arguments[0] ) : 10240;
+	const size_t steps = arguments.size() > 1 ? stoul( arguments[1] ) : 100;
+
+	vector<uint32_t> actions( lanes * steps );
+	CMinesweeperRandom random( 0 );
+	for( size_t i = 0; i < actions.size(); i++ ) {
+		actions[i] = static_cast<uint32_t>( random.Next( rows * columns ) );
+	}
+
+	CMinesweeperEnvironment environment;
+	vector<float> rewards( lanes );
+	vector<uint8_t> done( lanes );
+	vector<int8_t> observations;
+	TClock::time_point start = TClock::now();
+	environment.Reset( rows, columns, bombs, lanes, 0 );
+	size_t episodes = 0;
+	for( size_t step = 0; step < steps; step++ ) {
+		environment.Step( actions.data() + step * lanes, rewards.data(), done.data() );
+		for( size_t lane = 0; lane < lanes; lane++ ) {
+			episodes += done[lane];
+		}
+		environment.ResetDone();
+	}
+	const double batched = ElapsedNanoseconds( start );
+
+	const size_t observes = 10;
+	observations.resize( lanes * environment.ObservationSize() );
+	environment.Observe( observations.data() );
+	start = TClock::now();
+	for( size_t i = 0; i < observes; i++ ) {
+		environment.Observe( observations.data() );
+	}
+	const double observe = ElapsedNanoseconds( start ) / observes;
+
+	vector<shared_ptr<IMinesweeperGame>> games( lanes );
+	for( size_t lane = 0; lane < lanes; lane++ ) {
+		games[lane] = CreateGame( rows, columns, bombs );
+	}
+	start = TClock::now();
+	for( size_t lane = 0; lane < lanes; lane++ ) {
+		games[lane]->NewGame( rows, columns, bombs, MixSeed( lane ) );
+	}
+	size_t gameEpisodes = 0;
+	for( size_t step = 0; step < steps; step++ ) {
+		for( size_t lane = 0; lane < lanes; lane++ ) {
+			IMinesweeperGame& game = *games[lane];
+			const uint32_t action = actions[step * lanes + lane];
+			game.Cell( action / columns, action % columns )->Open();
+			if( game.GameState() != MGS_Active ) {
+				gameEpisodes++;
+				game.NewGame( rows, columns, bombs, MixSeed( lanes + gameEpisodes ) );
+			}
+		}
+	}
+	const double sequential = ElapsedNanoseconds( start );
+
+	const double laneSteps = static_cast<double>( lanes * steps );
+	cout << "environment " << rows << "x" << columns << "/" << bombs
+		<< ": lanes " << lanes << ", steps " << steps
+		<< ", episodes " << episodes
+		<< ", batched " << laneSteps / batched * 1e9 << " lane steps/s"
+		<< ", observe " << observe / lanes << " ns/lane"
+		<< "; games " << laneSteps / sequential * 1e9 << " lane steps/s"
+		<< " (episodes " << gameEpisodes << ")" << endl;
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <Benchmark.h>
+#include <MinesweeperEvents.h>
+#include <MinesweeperRandom.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// counts the events and the opened cells like a client applying the diffs
+class CCountingSink : public IMinesweeperEventSink {
+public:
+	size_t Events;
+	size_t Opened;
+
+	CCountingSink() : Events( 0 ), Opened( 0 ) {}
+
+	virtual void OnEvents( const CMinesweeperEvent* events, size_t numberOfEvents )
+	{
+		Events += numberOfEvents;
+		for( size_t i = 0; i < numberOfEvents; i++ ) {
+			Opened += events[i].Type == MET_Opened ? 1 : 0;
+		}
+	}
+};
+
+// plays the games by random opens, returns the nanoseconds of all games
+double play( IMinesweeperGame& game, size_t games, size_t& moves, size_t& allocations )
+{
+	moves = 0;
+	const size_t before = NumberOfAllocations();
+	const TClock::time_point start = TClock::now();
+	for( size_t i = 0; i < games; i++ ) {
+		game.NewGame( game.Rows(), game.Columns(), game.Bombs(), MixSeed( i ) );
+		CMinesweeperRandom random( MixSeed( games + i ) );
+		while( game.GameState() == MGS_Active ) {
+			game.Cell( random.Next( game.Rows() ), random.Next( game.Columns() ) )->Open();
+			moves++;
+		}
+	}
+	const double elapsed = ElapsedNanoseconds( start );
+	allocations = NumberOfAllocations() - before;
+	return elapsed;
+}
+
+} // end of anonymous namespace
+
+// Random opens of expert games without an event sink and with a sink
+// fed through the event ring, reports nanoseconds and allocations per move
+// usage: events [games] [capacity]
+int EventsBenchmark( const vector<string>& arguments )
+{
+	const size_t games = arguments.size() > 0 ? stoul( arguments[0] ) : 20000;
+	const size_t capacity = arguments.size() > 1 ? stoul( arguments[1] ) : 256;
+	shared_ptr<IMinesweeperGame> game = CreateGame( 16, 30, 99 );
+
+	size_t moves = 0;
+	size_t allocations = 0;
+	const double plain = play( *game, games, moves, allocations );
+	CCountingSink sink;
+	game->SetEventSink( &sink, capacity );
+	size_t sinkAllocations = 0;
+	const double withSink = play( *game, games, moves, sinkAllocations );
+
+	cout << "events 16x30/99: games " << games << ", moves " << moves
+		<< ", capacity " << capacity
+		<< ", no sink " << plain / moves << " ns/move"
+		<< ", sink " << withSink / moves << " ns/move"
+		<< " (" << static_cast<double>( sink.Events ) / moves << " events/move, "
+		<< static_cast<double>( sinkAllocations ) / moves << " allocations/move)" << endl;
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,67 @@
+#include <random>
+#include <iostream>
+#include <Benchmark.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Plays games with random clicks on the maximum size board
+// and measures the latency of every click, the small number of bombs
+// makes most of the first clicks clear a large area of the board
+// usage: flood-fill [games]
+int FloodFillBenchmark( const vector<string>& arguments )
+{
+	const size_t rows = 24;
+	const size_t columns = 30;
+	const size_t bombsSet[] = { 10, 99, 240 };
+	const size_t games = arguments.empty() ? 10000 : stoul( arguments[0] );
+
+	mt19937 randomGenerator( 0 );
+	uniform_int_distribution<size_t> randomCell( 0, rows * columns - 1 );
+	shared_ptr<IMinesweeperGame> game = CreateGame( rows, columns, bombsSet[0] );
+	vector<pair<size_t, size_t>> modifiedCells;
+
+	for( auto bombs = begin( bombsSet ); bombs != end( bombsSet ); ++bombs ) {
+		vector<double> clicks;
+		vector<double> cascades;
+		for( size_t i = 0; i < games; i++ ) {
+			game->NewGame( rows, columns, *bombs );
+			game->ModifiedCells( modifiedCells );
+			while( game->GameState() == MGS_Active ) {
+				const size_t cell = randomCell( randomGenerator );
+				IMinesweeperCell* const target = game->Cell( cell / columns, cell % columns );
+
+				const TClock::time_point start = TClock::now();
+				target->Open();
+				const double elapsed = ElapsedNanoseconds( start );
+
+				clicks.push_back( elapsed );
+				game->ModifiedCells( modifiedCells );
+				if( modifiedCells.size() > 1 ) {
+					cascades.push_back( elapsed );
+				}
+			}
+		}
+
+		const CLatency all = CalculateLatency( clicks );
+		const CLatency cascade = CalculateLatency( cascades );
+		cout << "flood-fill " << rows << "x" << columns << "/" << *bombs
+			<< ": games " << games
+			<< ", clicks " << all.Count
+			<< ", mean " << all.Mean << " ns"
+			<< ", p50 " << all.P50 << " ns"
+			<< ", p99 " << all.P99 << " ns"
+			<< ", max " << all.Max << " ns"
+			<< "; cascades " << cascade.Count
+			<< ", mean " << cascade.Mean << " ns"
+			<< ", p99 " << cascade.P99 << " ns" << endl;
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,256 @@
+#include <iostream>
+#include <Benchmark.h>
+#include <MinesweeperRandom.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// The game of a shape and the buffers of the calls
+struct CCase {
+	size_t Rows;
+	size_t Columns;
+	size_t Bombs;
+	CMinesweeperSizePolicy Policy;
+	bool IsTiled;
+	shared_ptr<IMinesweeperGame> Game;
+	shared_ptr<IMinesweeperGame> Created;
+	CMinesweeperRandom Random;
+	uint64_t NextSeed;
+	// the cell of the measured call
+	size_t Row;
+	size_t Column;
+	vector<pair<size_t, size_t>> Cells;
+	vector<CMinesweeperCellSpan> Spans;
+	vector<uint8_t> Encoded;
+	vector<uint8_t> Snapshot;
+};
+
+// the results of queries, so the queries are not optimized away
+volatile size_t sink = 0;
+
+void newGame( CCase& c )
+{
+	c.Game->NewGame( c.Rows, c.Columns, c.Bombs, MixSeed( c.NextSeed++ ) );
+}
+
+void openCenter( CCase& c )
+{
+	c.Game->Cell( c.Rows / 2, c.Columns / 2 )->Open();
+}
+
+// starts new games until the first open leaves the game active
+// (tiled games have no protection of the first open)
+void play( CCase& c )
+{
+	do {
+		newGame( c );
+		openCenter( c );
+	} while( c.Game->GameState() != MGS_Active );
+}
+
+// picks a random closed cell which is not labeled of the active game
+void pickClosed( CCase& c )
+{
+	do {
+		c.Row = c.Random.Next( c.Rows );
+		c.Column = c.Random.Next( c.Columns );
+	} while( c.Game->Cell( c.Row, c.Column )->IsOpened()
+		|| c.Game->Cell( c.Row, c.Column )->Label() != MCL_None );
+}
+
+void playAndPickClosed( CCase& c )
+{
+	play( c );
+	pickClosed( c );
+}
+
+void nothing( CCase& ) {}
+
+// A call of the game API, the prepare is not measured
+struct COperation {
+	const char* Name;
+	// snapshots of tiled games have every cell, so they are not measured
+	bool IsFlatOnly;
+	void ( *Prepare )( CCase& c );
+	void ( *Run )( CCase& c );
+};
+
+const COperation Operations[] = {
+	{ "CreateGame", false,
+		[]( CCase& c ) { c.Created.reset(); },
+		[]( CCase& c ) { c.Created = CreateGame( c.Rows, c.Columns, c.Bombs, c.Policy ); } },
+	{ "CreateFixedSizeGame", true,
+		[]( CCase& c ) { c.Created.reset(); },
+		[]( CCase& c ) { c.Created = CreateFixedSizeGame( c.Rows, c.Columns, c.Bombs ); } },
+	{ "NewGame", false, nothing, newGame },
+	{ "NewGame unseeded", false, nothing,
+		[]( CCase& c ) { c.Game->NewGame( c.Rows, c.Columns, c.Bombs ); } },
+	{ "first Open", false, newGame, openCenter },
+	{ "Open", false, playAndPickClosed,
+		[]( CCase& c ) { c.Game->Cell( c.Row, c.Column )->Open(); } },
+	{ "SetLabel", false, playAndPickClosed,
+		[]( CCase& c ) { c.Game->Cell( c.Row, c.Column )->SetLabel( MCL_Bomb ); } },
+	{ "RestartGame", false,
+		[]( CCase& c ) {
+			play( c );
+			for( size_t i = 0; i < 8 && c.Game->GameState() == MGS_Active; i++ ) {
+				pickClosed( c );
+				c.Game->Cell( c.Row, c.Column )->Open();
+			}
+		},
+		[]( CCase& c ) { c.Game->RestartGame(); } },
+	{ "Cell", false,
+		[]( CCase& c ) {
+			c.Row = c.Random.Next( c.Rows );
+			c.Column = c.Random.Next( c.Columns );
+		},
+		[]( CCase& c ) { sink = c.Game->Cell( c.Row, c.Column )->IsOpened() ? 1 : 0; } },
+	{ "ModifiedCells", false, play,
+		[]( CCase& c ) { c.Game->ModifiedCells( c.Cells ); } },
+	{ "ModifiedCells vector", false, play,
+		[]( CCase& c ) { c.Cells = c.Game->ModifiedCells(); } },
+	{ "ModifiedSpans", false, play,
+		[]( CCase& c ) { c.Game->ModifiedSpans( c.Spans ); } },
+	{ "ChordableCells", false, play,
+		[]( CCase& c ) { c.Game->ChordableCells( c.Cells ); } },
+	{ "EncodeBoard", false, play,
+		[]( CCase& c ) {
+			c.Game->EncodeBoard( MBE_Codes, c.Encoded.data(), c.Encoded.size(), false );
+		} },
+	{ "EncodeBoard incremental", false,
+		[]( CCase& c ) {
+			play( c );
+			c.Game->EncodeBoard( MBE_Codes, c.Encoded.data(), c.Encoded.size(), false );
+			pickClosed( c );
+			c.Game->Cell( c.Row, c.Column )->Open();
+		},
+		[]( CCase& c ) {
+			c.Game->EncodeBoard( MBE_Codes, c.Encoded.data(), c.Encoded.size(), true );
+		} },
+	{ "Serialize", true,
+		[]( CCase& c ) {
+			play( c );
+			c.Snapshot.clear();
+		},
+		[]( CCase& c ) { c.Game->Serialize( c.Snapshot ); } },
+	{ "Deserialize", true,
+		[]( CCase& c ) {
+			play( c );
+			c.Snapshot.clear();
+			c.Game->Serialize( c.Snapshot );
+		},
+		[]( CCase& c ) { c.Game->Deserialize( c.Snapshot.data(), c.Snapshot.size() ); } },
+	{ "Statistics", false, nothing,
+		[]( CCase& c ) { sink = static_cast<size_t>( c.Game->Statistics().Opens ); } },
+	{ "Fork", false,
+		[]( CCase& c ) {
+			play( c );
+			c.Created.reset();
+		},
+		[]( CCase& c ) { c.Created = c.Game->Fork(); } },
+	// the moves of the game keep undo states from now on
+	{ "Open undo", false,
+		[]( CCase& c ) {
+			c.Created.reset();
+			c.Game->SetUndoDepth( 8 );
+			playAndPickClosed( c );
+		},
+		[]( CCase& c ) { c.Game->Cell( c.Row, c.Column )->Open(); } },
+	{ "UndoMove", false,
+		[]( CCase& c ) {
+			c.Game->SetUndoDepth( 8 );
+			playAndPickClosed( c );
+			c.Game->Cell( c.Row, c.Column )->Open();
+		},
+		[]( CCase& c ) { c.Game->UndoMove(); } }
+};
+
+// Shape of the boards, the tiled boards are bigger than the flat boards
+// of the unlimited size policy
+struct CShape {
+	size_t Rows;
+	size_t Columns;
+	size_t Bombs;
+	bool IsTiled;
+};
+
+const CShape Shapes[] = {
+	{ 9, 9, 10, false },
+	{ 16, 16, 40, false },
+	{ 16, 30, 99, false },
+	{ 24, 30, 72, false },
+	{ 24, 30, 216, false },
+	// the maximum density 0.93 of the classic policy
+	{ 16, 30, 446, false },
+	{ 24, 30, 669, false },
+	{ 2048, 2048, 629145, true }
+};
+
+} // end of anonymous namespace
+
+// Latency of every call of the game API (Minesweeper.h) on the shapes
+// and densities up to the maximum 0.93, each sample is one call prepared
+// by unmeasured calls, reports the distribution and the allocations
+// and allocated bytes per call
+// usage: latency [samples] [operation]
+int LatencyBenchmark( const vector<string>& arguments )
+{
+	const size_t samples = arguments.size() > 0 ? stoul( arguments[0] ) : 1000;
+	const string only = arguments.size() > 1 ? arguments[1] : string();
+
+	vector<double> latencies( samples );
+	for( auto shape = begin( Shapes ); shape != end( Shapes ); ++shape ) {
+		CCase c;
+		c.Rows = shape->Rows;
+		c.Columns = shape->Columns;
+		c.Bombs = shape->Bombs;
+		c.Policy = shape->IsTiled ? UnlimitedSizePolicy() : ClassicSizePolicy();
+		c.IsTiled = shape->IsTiled;
+		c.Game = CreateGame( c.Rows, c.Columns, c.Bombs, c.Policy );
+		c.Random.Seed( 0 );
+		c.NextSeed = 0;
+		c.Row = 0;
+		c.Column = 0;
+		c.Encoded.resize( EncodedBoardSize( MBE_Codes, c.Rows, c.Columns ) );
+
+		for( auto operation = begin( Operations ); operation != end( Operations ); ++operation ) {
+			if( ( operation->IsFlatOnly && c.IsTiled )
+				|| ( !only.empty() && only != operation->Name ) )
+			{
+				continue;
+			}
+			size_t allocations = 0;
+			size_t bytes = 0;
+			for( size_t i = 0; i < samples; i++ ) {
+				operation->Prepare( c );
+				const size_t allocationsBefore = NumberOfAllocations();
+				const size_t bytesBefore = NumberOfAllocatedBytes();
+				const TClock::time_point start = TClock::now();
+				operation->Run( c );
+				latencies[i] = ElapsedNanoseconds( start );
+				allocations += NumberOfAllocations() - allocationsBefore;
+				bytes += NumberOfAllocatedBytes() - bytesBefore;
+			}
+			const CLatency latency = CalculateLatency( latencies );
+			cout << "latency " << c.Rows << "x" << c.Columns << "/" << c.Bombs
+				<< " " << operation->Name
+				<< ": samples " << latency.Count
+				<< ", mean " << latency.Mean << " ns"
+				<< ", p50 " << latency.P50 << " ns"
+				<< ", p99 " << latency.P99 << " ns"
+				<< ", max " << latency.Max << " ns"
+				<< ", " << static_cast<double>( allocations ) / samples << " allocations"
+				<< ", " << static_cast<double>( bytes ) / samples << " bytes" << endl;
+		}
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <algorithm>
+#include <exception>
+#include <Benchmark.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+CLatency CalculateLatency( vector<double>& samples )
+{
+	CLatency latency = { samples.size(), 0, 0, 0, 0 };
+	if( samples.empty() ) {
+		return latency;
+	}
+
+	sort( samples.begin(), samples.end() );
+	double sum = 0;
+	for( auto i = samples.cbegin(); i != samples.cend(); ++i ) {
+		sum += *i;
+	}
+	latency.Mean = sum / samples.size();
+	latency.P50 = samples[( samples.size() - 1 ) / 2];
+	latency.P99 = samples[( samples.size() - 1 ) * 99 / 100];
+	latency.Max = samples.back();
+	return latency;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace MinesweeperBenchmark;
+
+struct CBenchmark {
+	const char* Name;
+	int ( *Run )( const vector<string>& arguments );
+};
+
+const CBenchmark Benchmarks[] = {
+	{ "flood-fill", FloodFillBenchmark },
+	{ "batch", BatchBenchmark },
+	{ "self-play", SelfPlayBenchmark },
+	{ "replay", ReplayBenchmark },
+	{ "no-guess", NoGuessBenchmark },
+	{ "simulation", SimulationBenchmark },
+	{ "environment", EnvironmentBenchmark },
+	{ "encoding", EncodingBenchmark },
+	{ "pool", PoolBenchmark },
+	{ "events", EventsBenchmark },
+	{ "latency", LatencyBenchmark },
+	{ "self-check", SelfCheck }
+};
+
+int main( int argc, const char* argv[] )
+{
+	const string name = argc > 1 ? argv[1] : Benchmarks[0].Name;
+	const vector<string> arguments( argv + min( argc, 2 ), argv + argc );
+
+	try {
+		for( auto i = begin( Benchmarks ); i != end( Benchmarks ); ++i ) {
+			if( name == i->Name ) {
+				return i->Run( arguments );
+			}
+		}
+	} catch( exception& e ) {
+		cerr << e.what() << endl;
+		return 1;
+	}
+
+	cerr << "usage: MinesweeperBenchmark <benchmark> [arguments]" << endl;
+	for( auto i = begin( Benchmarks ); i != end( Benchmarks ); ++i ) {
+		cerr << "  " << i->Name << endl;
+	}
+	return 1;
+}
@@ -0,0 +1,61 @@
+#include <iostream>
+#include <Benchmark.h>
+#include <MinesweeperNoGuess.h>
+#include <MinesweeperRandom.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Generates boards solvable without guessing on all threads and measures
+// the latency of new games started from a filled pool of such boards
+// usage: no-guess [rows] [columns] [bombs] [boards] [threads]
+int NoGuessBenchmark( const vector<string>& arguments )
+{
+	const size_t rows = arguments.size() > 0 ? stoul( arguments[0] ) : 16;
+	const size_t columns = arguments.size() > 1 ? stoul( arguments[1] ) : 30;
+	const size_t bombs = arguments.size() > 2 ? stoul( arguments[2] ) : 99;
+	const size_t boards = arguments.size() > 3 ? stoul( arguments[3] ) : 200;
+	const size_t threads = arguments.size() > 4 ? stoul( arguments[4] ) : 0;
+
+	vector<CMinesweeperNoGuessBoard> generated;
+	const TClock::time_point start = TClock::now();
+	GenerateNoGuessBoards( rows, columns, bombs, rows / 2, columns / 2,
+		boards, GenerateSeed(), generated, threads );
+	const double elapsed = ElapsedNanoseconds( start );
+
+	cout << "no-guess " << rows << "x" << columns << "/" << bombs
+		<< ": boards " << generated.size()
+		<< ", " << generated.size() / ( elapsed * 1e-9 ) << " boards/s" << endl;
+
+	// the pool is filled first, so every new game takes a ready board
+	CMinesweeperNoGuessPool pool( boards, threads );
+	pool.Add( rows, columns, bombs );
+	pool.Fill();
+	shared_ptr<IMinesweeperGame> game = CreateGame( rows, columns, bombs,
+		UnlimitedSizePolicy() );
+	vector<double> samples;
+	size_t firstRow;
+	size_t firstColumn;
+	for( size_t i = 0; i < boards; i++ ) {
+		const TClock::time_point gameStart = TClock::now();
+		if( !pool.NewGame( *game, rows, columns, bombs, firstRow, firstColumn ) ) {
+			break;
+		}
+		samples.push_back( ElapsedNanoseconds( gameStart ) );
+	}
+	const CLatency latency = CalculateLatency( samples );
+
+	cout << "no-guess pool new game: games " << latency.Count
+		<< ", mean " << latency.Mean << " ns"
+		<< ", p50 " << latency.P50 << " ns"
+		<< ", p99 " << latency.P99 << " ns"
+		<< ", max " << latency.Max << " ns" << endl;
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
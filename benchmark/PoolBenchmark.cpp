@@ -0,0 +1,80 @@
+#include <thread>
+#include <iostream>
+#include <Benchmark.h>
+#include <MinesweeperGamePool.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// creates the games one by one, opens one cell of each and drops it,
+// adds the allocations of the thread
+template<typename TCreate>
+void churn( size_t games, TCreate create, size_t& allocations )
+{
+	const size_t before = NumberOfAllocations();
+	for( size_t i = 0; i < games; i++ ) {
+		shared_ptr<IMinesweeperGame> game = create();
+		game->Cell( 8, 15 )->Open();
+	}
+	allocations = NumberOfAllocations() - before;
+}
+
+// runs the churn on the threads, returns nanoseconds per game
+template<typename TCreate>
+double run( size_t games, size_t threads, TCreate create, double& allocationsPerGame )
+{
+	vector<size_t> allocations( threads );
+	vector<thread> workers;
+	const TClock::time_point start = TClock::now();
+	for( size_t t = 0; t < threads; t++ ) {
+		workers.emplace_back( [&, t] { churn( games, create, allocations[t] ); } );
+	}
+	for( size_t t = 0; t < threads; t++ ) {
+		workers[t].join();
+	}
+	const double elapsed = ElapsedNanoseconds( start );
+	size_t total = 0;
+	for( size_t t = 0; t < threads; t++ ) {
+		total += allocations[t];
+	}
+	allocationsPerGame = static_cast<double>( total ) / ( games * threads );
+	return elapsed / ( games * threads );
+}
+
+} // end of anonymous namespace
+
+// Churn of expert games created, opened once and dropped on each thread,
+// by CreateGame and by the warm game pool
+// usage: pool [games per thread] [threads]
+int PoolBenchmark( const vector<string>& arguments )
+{
+	const size_t games = arguments.size() > 0 ? stoul( arguments[0] ) : 20000;
+	const size_t threads = arguments.size() > 1 ? stoul( arguments[1] ) : 1;
+
+	double created = 0;
+	const double create = run( games, threads, [] {
+		return CreateGame( 16, 30, 99 );
+	}, created );
+
+	CMinesweeperGamePool pool;
+	pool.Reserve( threads, 16, 30, 99 );
+	double pooled = 0;
+	const double acquire = run( games, threads, [&pool] {
+		return pool.Acquire( 16, 30, 99 );
+	}, pooled );
+
+	cout << "pool 16x30/99: games " << games << ", threads " << threads
+		<< ", create " << create << " ns/game " << created << " allocations/game"
+		<< "; pool " << acquire << " ns/game " << pooled << " allocations/game"
+		<< " (games " << pool.NumberOfGames() << ")" << endl;
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <Benchmark.h>
+#include <MinesweeperMoveLog.h>
+#include <MinesweeperSolver.h>
+#include <MinesweeperProbability.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Records move logs of expert games played by the solver and replays them,
+// checks that every replay ends in the state of its game
+// usage: replay [games] [repeats]
+int ReplayBenchmark( const vector<string>& arguments )
+{
+	const size_t rows = 16;
+	const size_t columns = 30;
+	const size_t bombs = 99;
+	const size_t games = arguments.size() > 0 ? stoul( arguments[0] ) : 1000;
+	const size_t repeats = arguments.size() > 1 ? stoul( arguments[1] ) : 10;
+
+	shared_ptr<IMinesweeperGame> game = CreateGame( rows, columns, bombs );
+	CMinesweeperSolver solver;
+	CMinesweeperProbability probability;
+	vector<CMinesweeperMoveLog> logs;
+	vector<TMinesweeperGameState> states;
+	size_t moves = 0;
+	size_t bytes = 0;
+	for( size_t seed = 0; seed < games; seed++ ) {
+		game->NewGame( rows, columns, bombs, seed );
+		solver.Reset( *game );
+		while( game->GameState() == MGS_Active ) {
+			size_t row;
+			size_t column;
+			solver.Solve();
+			if( !solver.NextSafeCell( row, column ) ) {
+				probability.Calculate( solver );
+				if( !probability.SafestCell( row, column ) ) {
+					break;
+				}
+			}
+			game->Cell( row, column )->Open();
+			solver.Update( *game, game->ModifiedCells() );
+		}
+		logs.push_back( game->MoveLog() );
+		states.push_back( game->GameState() );
+		moves += game->MoveLog().NumberOfMoves();
+		bytes += game->MoveLog().Size();
+	}
+
+	CMinesweeperReplay replay;
+	const TClock::time_point start = TClock::now();
+	for( size_t r = 0; r < repeats; r++ ) {
+		for( size_t i = 0; i < logs.size(); i++ ) {
+			replay.Replay( logs[i] );
+			if( replay.GameState() != states[i] ) {
+				cerr << "replay of game " << i << " differs from the game" << endl;
+				return 1;
+			}
+		}
+	}
+	const double elapsed = ElapsedNanoseconds( start );
+	const double replayed = static_cast<double>( moves ) * repeats;
+
+	cout << "replay " << rows << "x" << columns << "/" << bombs
+		<< ": games " << games
+		<< ", moves " << moves
+		<< ", " << static_cast<double>( bytes ) / ( moves > 0 ? moves : 1 ) << " bytes/move"
+		<< ", " << replayed / ( elapsed * 1e-9 ) << " moves/s"
+		<< ", " << elapsed / ( static_cast<double>( games ) * repeats ) << " ns/game" << endl;
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,261 @@
+#include <iostream>
+#include <cmath>
+#include <Benchmark.h>
+#include <MinesweeperBits.h>
+#include <MinesweeperRandom.h>
+#include <MinesweeperSolver.h>
+#include <MinesweeperProbability.h>
+#include <MinesweeperEnvironment.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// The opens of labeled cells do nothing, so the first open of a closed
+// cell after them is still safe (MFC_Opening)
+size_t checkLabeledFirstClick( size_t cases )
+{
+	size_t failures = 0;
+	const size_t rows = 9;
+	const size_t columns = 9;
+	const size_t bombs = 70;
+	shared_ptr<IMinesweeperGame> game = CreateGame( rows, columns, bombs );
+	for( size_t seed = 0; seed < cases; seed++ ) {
+		game->NewGame( rows, columns, bombs, seed );
+		IMinesweeperCell* const labeled = game->Cell( 0, 0 );
+		labeled->SetLabel( seed % 2 == 0 ? MCL_Bomb : MCL_Question );
+		labeled->Open();
+		IMinesweeperCell* const opened = game->Cell( rows - 1, columns - 1 );
+		opened->Open();
+		if( labeled->IsOpened() || game->GameState() == MGS_Failure
+			|| !opened->IsOpened() || opened->NumberOfNeighborBombs() != 0 )
+		{
+			failures++;
+		}
+	}
+	return failures;
+}
+
+// Compares the probabilities of the closed cells with the numbers of all
+// bomb layouts of the closed cells which agree with the opened cells,
+// the boards have at most 32 cells, so a layout is a mask of the cells
+size_t compareProbabilities( const IMinesweeperGame& game,
+	CMinesweeperSolver& solver, CMinesweeperProbability& probability )
+{
+	const size_t rows = game.Rows();
+	const size_t columns = game.Columns();
+	solver.Reset( game );
+	solver.Solve();
+	probability.Calculate( solver );
+
+	vector<size_t> closed;
+	vector<pair<uint32_t, size_t>> constraints;
+	for( size_t row = 0; row < rows; row++ ) {
+		for( size_t column = 0; column < columns; column++ ) {
+			const IMinesweeperCell* const cell = game.Cell( row, column );
+			if( !cell->IsOpened() ) {
+				closed.push_back( row * columns + column );
+				continue;
+			}
+			uint32_t neighbors = 0;
+			for( size_t r = row > 0 ? row - 1 : 0; r <= row + 1 && r < rows; r++ ) {
+				for( size_t c = column > 0 ? column - 1 : 0; c <= column + 1 && c < columns; c++ ) {
+					neighbors |= uint32_t( 1 ) << ( r * columns + c );
+				}
+			}
+			constraints.push_back( make_pair( neighbors, cell->NumberOfNeighborBombs() ) );
+		}
+	}
+
+	// the layouts are the combinations of the bombs out of the closed cells
+	const size_t bombs = game.Bombs();
+	vector<size_t> chosen( bombs );
+	for( size_t i = 0; i < bombs; i++ ) {
+		chosen[i] = i;
+	}
+	double layouts = 0;
+	vector<double> bombLayouts( rows * columns, 0 );
+	while( true ) {
+		uint32_t mask = 0;
+		for( size_t i = 0; i < bombs; i++ ) {
+			mask |= uint32_t( 1 ) << closed[chosen[i]];
+		}
+		bool agrees = true;
+		for( auto i = constraints.cbegin(); i != constraints.cend() && agrees; ++i ) {
+			agrees = PopulationCount( mask & i->first ) == i->second;
+		}
+		if( agrees ) {
+			layouts++;
+			for( size_t i = 0; i < bombs; i++ ) {
+				bombLayouts[closed[chosen[i]]]++;
+			}
+		}
+		size_t i = bombs;
+		while( i > 0 && chosen[i - 1] == closed.size() - bombs + i - 1 ) {
+			i--;
+		}
+		if( i == 0 ) {
+			break;
+		}
+		chosen[i - 1]++;
+		for( size_t j = i; j < bombs; j++ ) {
+			chosen[j] = chosen[j - 1] + 1;
+		}
+	}
+
+	size_t failures = 0;
+	for( auto i = closed.cbegin(); i != closed.cend(); ++i ) {
+		const double expected = bombLayouts[*i] / layouts;
+		if( fabs( probability.Probability( *i / columns, *i % columns ) - expected ) > 1e-9 ) {
+			failures++;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
+
+// The probabilities of the positions of random opens on small boards
+// against the brute force enumeration of the bomb layouts
+size_t checkProbability( size_t cases )
+{
+	struct CShape {
+		size_t Rows;
+		size_t Columns;
+		size_t Bombs;
+	};
+	const CShape shapes[] = { { 5, 5, 4 }, { 4, 6, 6 }, { 3, 8, 5 }, { 4, 8, 3 } };
+	const size_t opensPerGame = 4;
+
+	size_t failures = 0;
+	CMinesweeperSolver solver;
+	CMinesweeperProbability probability;
+	CMinesweeperRandom random( 0 );
+	// the classic policy has no boards this small
+	shared_ptr<IMinesweeperGame> game = CreateGame( 5, 5, 4, UnlimitedSizePolicy() );
+	for( size_t seed = 0; seed < cases; seed++ ) {
+		const CShape& shape = shapes[seed % ( sizeof( shapes ) / sizeof( shapes[0] ) )];
+		game->NewGame( shape.Rows, shape.Columns, shape.Bombs, seed );
+		for( size_t open = 0; open < opensPerGame && game->GameState() == MGS_Active; open++ ) {
+			size_t row;
+			size_t column;
+			do {
+				row = static_cast<size_t>( random.Next( shape.Rows ) );
+				column = static_cast<size_t>( random.Next( shape.Columns ) );
+			} while( game->Cell( row, column )->IsOpened() );
+			game->Cell( row, column )->Open();
+			if( game->GameState() == MGS_Active ) {
+				failures += compareProbabilities( *game, solver, probability );
+			}
+		}
+	}
+	return failures;
+}
+
+// The lanes of the batched environment against games of the same seeds
+// played by the same random opens: the observations, the rewards,
+// the done flags and the next episodes must be the same, the lanes fill
+// two groups and a part of the third one, the cases are the episodes
+size_t checkEnvironment( size_t cases )
+{
+	const size_t rows = 9;
+	const size_t columns = 9;
+	const size_t bombs = 10;
+	const size_t lanes = 2 * CMinesweeperEnvironment::LanesPerGroup + 5;
+	const size_t cells = rows * columns;
+
+	CMinesweeperEnvironment environment;
+	environment.Reset( rows, columns, bombs, lanes, 0 );
+	vector<shared_ptr<IMinesweeperGame>> games( lanes );
+	for( size_t lane = 0; lane < lanes; lane++ ) {
+		games[lane] = CreateGame( rows, columns, bombs );
+		games[lane]->NewGame( rows, columns, bombs, environment.Seed( lane ) );
+	}
+
+	size_t failures = 0;
+	CMinesweeperRandom random( 0 );
+	vector<uint32_t> actions( lanes );
+	vector<float> rewards( lanes );
+	vector<uint8_t> done( lanes );
+	vector<int8_t> observations( lanes * environment.ObservationSize() );
+	vector<int8_t> codes( EncodedBoardSize( MBE_Codes, rows, columns ) );
+	for( size_t episodes = 0; episodes < cases; ) {
+		for( size_t lane = 0; lane < lanes; lane++ ) {
+			actions[lane] = static_cast<uint32_t>( random.Next( cells ) );
+		}
+		environment.Step( actions.data(), rewards.data(), done.data() );
+		environment.Observe( observations.data() );
+		for( size_t lane = 0; lane < lanes; lane++ ) {
+			IMinesweeperGame& game = *games[lane];
+			const size_t opened = game.NumberOfOpenedCells();
+			// the environment does nothing for opened cells and for done lanes,
+			// the game would chord or fail
+			IMinesweeperCell* const cell = game.Cell( actions[lane] / columns, actions[lane] % columns );
+			if( game.GameState() == MGS_Active && !cell->IsOpened() ) {
+				cell->Open();
+			}
+			const bool isDone = game.GameState() != MGS_Active;
+			const float reward = game.GameState() == MGS_Failure ? -1.0f
+				: static_cast<float>( game.NumberOfOpenedCells() - opened ) / ( cells - bombs );
+			game.EncodeBoard( MBE_Codes, codes.data(), codes.size(), false );
+			bool isSame = ( done[lane] != 0 ) == isDone && fabs( rewards[lane] - reward ) < 1e-6f
+				&& environment.State( lane ) == game.GameState()
+				&& environment.NumberOfOpenedCells( lane ) == game.NumberOfOpenedCells();
+			for( size_t i = 0; i < cells && isSame; i++ ) {
+				isSame = observations[lane * cells + i] == codes[i];
+			}
+			if( !isSame ) {
+				failures++;
+			}
+		}
+		environment.ResetDone();
+		for( size_t lane = 0; lane < lanes; lane++ ) {
+			if( done[lane] != 0 ) {
+				episodes++;
+				games[lane]->NewGame( rows, columns, bombs, environment.Seed( lane ) );
+			}
+		}
+	}
+	return failures;
+}
+
+// A check of the results of the library, returns the number of failed cases
+struct CCheck {
+	const char* Name;
+	size_t ( *Run )( size_t cases );
+};
+
+const CCheck Checks[] = {
+	{ "labeled-first-click", checkLabeledFirstClick },
+	{ "probability", checkProbability },
+	{ "environment", checkEnvironment }
+};
+
+} // end of anonymous namespace
+
+// Runs the checks of the library results against simple references,
+// fails if any case of a check fails
+// usage: self-check [cases] [check]
+int SelfCheck( const vector<string>& arguments )
+{
+	const size_t cases = arguments.size() > 0 ? stoul( arguments[0] ) : 1000;
+	const string only = arguments.size() > 1 ? arguments[1] : string();
+
+	size_t failures = 0;
+	for( auto check = begin( Checks ); check != end( Checks ); ++check ) {
+		if( !only.empty() && only != check->Name ) {
+			continue;
+		}
+		const size_t checkFailures = check->Run( cases );
+		cout << "self-check " << check->Name << ": cases " << cases
+			<< ", failures " << checkFailures << endl;
+		failures += checkFailures;
+	}
+	return failures == 0 ? 0 : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,209 @@
+#include <thread>
+#include <cstdio>
+#include <iostream>
+#include <Benchmark.h>
+#include <MinesweeperSolver.h>
+#include <MinesweeperProbability.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct CConfiguration {
+	string Name;
+	size_t Rows;
+	size_t Columns;
+	size_t Bombs;
+};
+
+// results of the games played by one thread
+struct CResult {
+	size_t Games;
+	size_t Wins;
+	size_t Clicks;
+	size_t Allocations;
+	vector<double> Latencies;
+};
+
+// plays the games [first, last), the game index is the seed of the game,
+// so the results do not depend on the number of threads
+void playGames( const CConfiguration& configuration, size_t first, size_t last,
+	CResult& result )
+{
+	// the standard configurations are played by the specialized games
+	shared_ptr<IMinesweeperGame> game = ClassicSizePolicy().Allows( configuration.Rows,
+			configuration.Columns, configuration.Bombs )
+		? CreateFixedSizeGame( configuration.Rows, configuration.Columns, configuration.Bombs )
+		: CreateGame( configuration.Rows, configuration.Columns, configuration.Bombs,
+			UnlimitedSizePolicy() );
+	CMinesweeperSolver solver;
+	CMinesweeperProbability probability;
+	vector<pair<size_t, size_t>> modifiedCells;
+
+	result = CResult{ 0, 0, 0, 0, vector<double>() };
+	const size_t allocations = NumberOfAllocations();
+	for( size_t seed = first; seed < last; seed++ ) {
+		game->NewGame( configuration.Rows, configuration.Columns,
+			configuration.Bombs, seed );
+		game->ModifiedCells( modifiedCells );
+		solver.Reset( *game );
+
+		while( game->GameState() == MGS_Active ) {
+			size_t row;
+			size_t column;
+			solver.Solve();
+			if( !solver.NextSafeCell( row, column ) ) {
+				probability.Calculate( solver );
+				if( !probability.SafestCell( row, column ) ) {
+					break;
+				}
+			}
+
+			IMinesweeperCell* const cell = game->Cell( row, column );
+			const TClock::time_point start = TClock::now();
+			cell->Open();
+			const double elapsed = ElapsedNanoseconds( start );
+			game->ModifiedCells( modifiedCells );
+			solver.Update( *game, modifiedCells );
+
+			// the measurements should not be counted as allocations of the game
+			const size_t before = NumberOfAllocations();
+			result.Latencies.push_back( elapsed );
+			result.Allocations -= NumberOfAllocations() - before;
+			result.Clicks++;
+		}
+
+		result.Games++;
+		if( game->GameState() == MGS_Success ) {
+			result.Wins++;
+		}
+	}
+	result.Allocations += NumberOfAllocations() - allocations;
+}
+
+bool parseConfiguration( const string& text, CConfiguration& configuration )
+{
+	unsigned long rows = 0;
+	unsigned long columns = 0;
+	unsigned long bombs = 0;
+	if( sscanf( text.c_str(), "%lux%lux%lu", &rows, &columns, &bombs ) != 3 ) {
+		return false;
+	}
+	configuration = CConfiguration{ "custom-" + text, rows, columns, bombs };
+	return true;
+}
+
+} // end of anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Plays games of every configuration by the solver and the probability
+// engine on a number of threads, each thread has its own game instance,
+// reports the games and clicks throughput, the latency of clicks
+// (the time spent in IMinesweeperCell::Open), allocations and win rate
+// usage: self-play [games] [threads] [csv|json] [RxCxB ...]
+int SelfPlayBenchmark( const vector<string>& arguments )
+{
+	const size_t games = arguments.size() > 0 ? stoul( arguments[0] ) : 10000;
+	size_t threads = arguments.size() > 1 ? stoul( arguments[1] ) : 0;
+	if( threads == 0 ) {
+		threads = max<size_t>( thread::hardware_concurrency(), 1 );
+	}
+	const bool json = arguments.size() > 2 && arguments[2] == "json";
+
+	vector<CConfiguration> configurations = {
+		{ "beginner", 9, 9, 10 },
+		{ "intermediate", 16, 16, 40 },
+		{ "expert", 16, 30, 99 }
+	};
+	for( size_t i = 3; i < arguments.size(); i++ ) {
+		CConfiguration configuration;
+		if( !parseConfiguration( arguments[i], configuration ) ) {
+			cerr << "bad configuration " << arguments[i] << endl;
+			return 1;
+		}
+		configurations.push_back( configuration );
+	}
+
+	if( json ) {
+		cout << "[" << endl;
+	} else {
+		cout << "configuration,rows,columns,bombs,games,threads,seconds,"
+			"games_per_second,clicks_per_second,click_p50_ns,click_p99_ns,"
+			"allocations_per_game,win_rate" << endl;
+	}
+
+	for( size_t c = 0; c < configurations.size(); c++ ) {
+		const CConfiguration& configuration = configurations[c];
+		vector<CResult> results( threads );
+		vector<thread> workers;
+
+		const TClock::time_point start = TClock::now();
+		for( size_t i = 0; i < threads; i++ ) {
+			workers.emplace_back( playGames, cref( configuration ),
+				games * i / threads, games * ( i + 1 ) / threads, ref( results[i] ) );
+		}
+		for( size_t i = 0; i < threads; i++ ) {
+			workers[i].join();
+		}
+		const double seconds = ElapsedNanoseconds( start ) * 1e-9;
+
+		CResult total = { 0, 0, 0, 0, vector<double>() };
+		for( auto i = results.begin(); i != results.end(); ++i ) {
+			total.Games += i->Games;
+			total.Wins += i->Wins;
+			total.Clicks += i->Clicks;
+			total.Allocations += i->Allocations;
+			total.Latencies.insert( total.Latencies.end(),
+				i->Latencies.begin(), i->Latencies.end() );
+		}
+		const CLatency latency = CalculateLatency( total.Latencies );
+		const double numberOfGames = total.Games > 0 ? total.Games : 1;
+
+		const double values[] = {
+			total.Games / seconds,
+			total.Clicks / seconds,
+			latency.P50,
+			latency.P99,
+			total.Allocations / numberOfGames,
+			total.Wins / numberOfGames
+		};
+		if( json ) {
+			cout << "  { \"configuration\": \"" << configuration.Name << "\""
+				<< ", \"rows\": " << configuration.Rows
+				<< ", \"columns\": " << configuration.Columns
+				<< ", \"bombs\": " << configuration.Bombs
+				<< ", \"games\": " << total.Games
+				<< ", \"threads\": " << threads
+				<< ", \"seconds\": " << seconds
+				<< ", \"games_per_second\": " << values[0]
+				<< ", \"clicks_per_second\": " << values[1]
+				<< ", \"click_p50_ns\": " << values[2]
+				<< ", \"click_p99_ns\": " << values[3]
+				<< ", \"allocations_per_game\": " << values[4]
+				<< ", \"win_rate\": " << values[5]
+				<< " }" << ( c + 1 < configurations.size() ? "," : "" ) << endl;
+		} else {
+			cout << configuration.Name << "," << configuration.Rows
+				<< "," << configuration.Columns << "," << configuration.Bombs
+				<< "," << total.Games << "," << threads << "," << seconds;
+			for( auto value = begin( values ); value != end( values ); ++value ) {
+				cout << "," << *value;
+			}
+			cout << endl;
+		}
+	}
+
+	if( json ) {
+		cout << "]" << endl;
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
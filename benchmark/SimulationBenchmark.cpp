@@ -0,0 +1,54 @@
+#include <iostream>
+#include <Benchmark.h>
+#include <MinesweeperSimulation.h>
+
+namespace MinesweeperBenchmark {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Runs the strategy on the classic difficulties with the work stealing
+// simulation runner, reports the throughput, win rates and cascade histograms
+// usage: simulation [games] [threads] [solver|random]
+int SimulationBenchmark( const vector<string>& arguments )
+{
+	const size_t games = arguments.size() > 0 ? stoul( arguments[0] ) : 10000;
+	const size_t threads = arguments.size() > 1 ? stoul( arguments[1] ) : 0;
+	const bool random = arguments.size() > 2 && arguments[2] == "random";
+
+	const vector<CMinesweeperSimulationConfiguration> configurations = {
+		{ 9, 9, 10, MFC_Opening, 0, games },
+		{ 16, 16, 40, MFC_Opening, 0, games },
+		{ 16, 30, 99, MFC_Opening, 0, games }
+	};
+	CMinesweeperSimulation simulation( threads );
+	vector<CMinesweeperSimulationStatistics> statistics;
+	const TClock::time_point start = TClock::now();
+	simulation.Run( configurations, random ? CreateRandomStrategy : CreateSolverStrategy,
+		statistics );
+	const double seconds = ElapsedNanoseconds( start ) * 1e-9;
+
+	cout << "simulation " << ( random ? "random" : "solver" )
+		<< ": threads " << simulation.NumberOfThreads()
+		<< ", steals " << simulation.NumberOfSteals()
+		<< ", " << 3 * games / seconds << " games/s" << endl;
+	for( size_t c = 0; c < configurations.size(); c++ ) {
+		const CMinesweeperSimulationStatistics& result = statistics[c];
+		const double numberOfGames = result.Games > 0 ? static_cast<double>( result.Games ) : 1;
+		cout << configurations[c].Rows << "x" << configurations[c].Columns
+			<< "/" << configurations[c].Bombs
+			<< ": win rate " << result.Wins / numberOfGames
+			<< ", clicks/game " << result.Clicks / numberOfGames
+			<< ", cascades";
+		for( size_t i = 0; i < CMinesweeperSimulationStatistics::NumberOfCascadeBuckets; i++ ) {
+			cout << " " << result.Cascades[i];
+		}
+		cout << endl;
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of MinesweeperBenchmark namespace
+
+////////////////////////////////////////////////////////////////////////////////
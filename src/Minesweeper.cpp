@@ -1,23 +1,22 @@
 #include <set>
 #include <memory>
-#include <random>
 #include <string>
 #include <vector>
-#include <iostream>
+#include <limits>
 #include <exception>
 #include <unordered_map>
-#include <unordered_set>
 #include <Minesweeper.h>
-
-////////////////////////////////////////////////////////////////////////////////
-
-#define internal_check( condition ) \
-	do { \
-		if( !( condition ) ) { \
-			throw logic_error( "internal program error at " \
-				+ to_string( __LINE__ ) + " line in file " + __FILE__ ); \
-		} \
-	} while( false )
+#include <MinesweeperCommon.h>
+#include <MinesweeperBoard.h>
+#include <MinesweeperFixedBoard.h>
+#include <MinesweeperEngine.h>
+#include <MinesweeperDirtyCells.h>
+#include <MinesweeperEncoding.h>
+#include <MinesweeperEvents.h>
+#include <MinesweeperSnapshot.h>
+#include <MinesweeperMoveLog.h>
+#include <MinesweeperRandom.h>
+#include <MinesweeperTiledGame.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation
@@ -26,185 +25,202 @@ namespace Minesweeper {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-class CMinesweeperCell;
-
-class IMinesweeperCellCallback {
-public:
-	virtual void OnOpen( CMinesweeperCell* cell ) = 0;
-	virtual void OnModified( CMinesweeperCell* cell ) = 0;
-};
+template<typename TBoard>
+class CMinesweeperGame;
 
+// Lightweight proxy handle of a board cell
+// the cell state lives in the board planes, the proxy only knows its index
+// and reaches its game through a plain reference, the proxies are owned
+// by the game, so they never outlive it
+template<typename TBoard>
 class CMinesweeperCell : public IMinesweeperCell {
 public:
-	CMinesweeperCell( weak_ptr<IMinesweeperCellCallback> callback, size_t index );
-	CMinesweeperCell( const CMinesweeperCell& ) = delete;
-	CMinesweeperCell& operator=( const CMinesweeperCell& ) = delete;
+	CMinesweeperCell( CMinesweeperGame<TBoard>& game, const TBoard& board,
+		size_t index );
 
-	void Close();
 	size_t Index() const { return index; }
-	void SetIsBomb( bool isBomb = true );
-	bool GetIsBomb() const { return isBomb; }
-	void SetNumberOfNeighborBombs( size_t numberOfNeighborBombs );
-	size_t GetNumberOfNeighborBombs() { return numberOfNeighborBombs; }
-	void InternalOpen();
 
 	// IMinesweeperCell
-	virtual bool IsOpened() const { return isOpened; }
+	virtual bool IsOpened() const { return board.IsOpened( index ); }
 	virtual bool IsBomb() const;
 	virtual size_t NumberOfNeighborBombs() const;
-	virtual TMinesweeperCellLabel Label() const { return label; }
+	virtual TMinesweeperCellLabel Label() const { return board.Label( index ); }
 	virtual void SetLabel( TMinesweeperCellLabel newLabel );
 	virtual void Open();
 
 private:
-	const weak_ptr<IMinesweeperCellCallback> callback;
+	CMinesweeperGame<TBoard>& game;
+	const TBoard& board;
 	const size_t index;
-	bool isBomb;
-	bool isOpened;
-	TMinesweeperCellLabel label;
-	size_t numberOfNeighborBombs;
-
-	void onModified();
 };
 
-CMinesweeperCell::CMinesweeperCell( weak_ptr<IMinesweeperCellCallback> _callback,
-	size_t _index ) :
-	callback( _callback ),
-	index( _index ),
-	isBomb( false ),
-	isOpened( false ),
-	label( MCL_None ),
-	numberOfNeighborBombs( 0 )
+template<typename TBoard>
+CMinesweeperCell<TBoard>::CMinesweeperCell( CMinesweeperGame<TBoard>& _game,
+	const TBoard& _board, size_t _index ) :
+	game( _game ),
+	board( _board ),
+	index( _index )
 {
 }
 
-void CMinesweeperCell::Close()
-{
-	isOpened = false;
-	label = MCL_None;
-	onModified();
-}
-
-void CMinesweeperCell::SetIsBomb( bool _isBomb )
-{
-	internal_check( !IsOpened() );
-	isBomb = _isBomb;
-	numberOfNeighborBombs = 0;
-}
-
-void CMinesweeperCell::SetNumberOfNeighborBombs( size_t _numberOfNeighborBombs )
-{
-	internal_check( !IsOpened() );
-	isBomb = false;
-	numberOfNeighborBombs = _numberOfNeighborBombs;
-}
-
-void CMinesweeperCell::InternalOpen()
-{
-	if( !isOpened ) {
-		isOpened = true;
-		onModified();
-	}
-}
-
-bool CMinesweeperCell::IsBomb() const
+template<typename TBoard>
+bool CMinesweeperCell<TBoard>::IsBomb() const
 {
 	internal_check( IsOpened() );
-	return isBomb;
+	return board.IsBomb( index );
 }
 
-size_t CMinesweeperCell::NumberOfNeighborBombs() const
+template<typename TBoard>
+size_t CMinesweeperCell<TBoard>::NumberOfNeighborBombs() const
 {
 	internal_check( !IsBomb() );
-	return numberOfNeighborBombs;
-}
-
-void CMinesweeperCell::SetLabel( TMinesweeperCellLabel newLabel )
-{
-	internal_check( !IsOpened() );
-	if( label != newLabel ) {
-		label = newLabel;
-		onModified();
-	}
-}
-
-void CMinesweeperCell::Open()
-{
-	callback.lock()->OnOpen( this );
-}
-
-void CMinesweeperCell::onModified()
-{
-	callback.lock()->OnModified( this );
+	return board.NumberOfNeighborBombs( index );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-class CMinesweeperGame :
-	public IMinesweeperGame,
-	public IMinesweeperCellCallback,
-	public enable_shared_from_this<CMinesweeperGame>
-{
-	friend shared_ptr<IMinesweeperGame> CreateGame( size_t, size_t, size_t );
-
+// Game on a flat board
+// TBoard is CMinesweeperBoard for any dimensions or a CMinesweeperFixedBoard
+// which keeps only its own dimensions
+template<typename TBoard>
+class CMinesweeperGame : public IMinesweeperGame {
 public:
+	// creates the game and starts it (throw an exception if failed)
+	static shared_ptr<IMinesweeperGame> Create( const CMinesweeperSizePolicy& policy,
+		size_t rows, size_t columns, size_t bombs );
+
 	CMinesweeperGame( const CMinesweeperGame& ) = delete;
 	CMinesweeperGame& operator=( const CMinesweeperGame& ) = delete;
 
 	// IMinesweeperGame
-	virtual TMinesweeperGameState GameState() const { return state; }
+	virtual TMinesweeperGameState GameState() const { return board.State(); }
 	virtual size_t Rows() const { return rows; }
 	virtual size_t Columns() const { return columns; }
 	virtual size_t Bombs() const { return bombs; }
+	virtual uint64_t Seed() const { return board.Seed(); }
+	virtual size_t NumberOfOpenedCells() const { return board.NumberOfOpenedCells(); }
 	virtual void NewGame( size_t rows, size_t columns, size_t bombs );
+	virtual void NewGame( size_t rows, size_t columns, size_t bombs, uint64_t seed );
 	virtual void NewGame();
 	virtual void RestartGame();
-	virtual CMinesweeperCell* Cell( size_t row, size_t column );
-	virtual const CMinesweeperCell* Cell( size_t row, size_t column ) const;
+	virtual void SetFirstClick( TMinesweeperFirstClick newFirstClick ) { firstClick = newFirstClick; }
+	virtual TMinesweeperFirstClick FirstClick() const { return firstClick; }
+	virtual void Serialize( vector<uint8_t>& buffer ) const;
+	virtual void Deserialize( const void* data, size_t size );
+	virtual void EncodeBoard( TMinesweeperBoardEncoding encoding, void* buffer,
+		size_t size, bool incremental ) const;
+	virtual void SetEventSink( IMinesweeperEventSink* sink, size_t capacity );
+	virtual const CMinesweeperMoveLog& MoveLog() const { return moveLog; }
+	virtual shared_ptr<IMinesweeperGame> Fork() const;
+	virtual void SetUndoDepth( size_t depth );
+	virtual size_t UndoDepth() const { return undoStates.size(); }
+	virtual size_t NumberOfUndoMoves() const { return numberOfUndoStates; }
+	virtual void UndoMove();
+	virtual CMinesweeperCell<TBoard>* Cell( size_t row, size_t column );
+	virtual const CMinesweeperCell<TBoard>* Cell( size_t row, size_t column ) const;
+	virtual void ChordableCells( vector<pair<size_t, size_t>>& cells ) const;
+	virtual CMinesweeperStatistics Statistics() const;
+	virtual void ResetStatistics();
 	virtual vector<pair<size_t, size_t>> ModifiedCells() const;
+	virtual void ModifiedCells( vector<pair<size_t, size_t>>& cells ) const;
+	virtual void ModifiedSpans( vector<CMinesweeperCellSpan>& spans ) const;
 
-	// IMinesweeperCellCallback
-	virtual void OnOpen( CMinesweeperCell* cell );
-	virtual void OnModified( CMinesweeperCell* cell );
+	// called by the cells, the calls are not virtual
+	void OnOpen( size_t index );
+	void OnSetLabel( size_t index, TMinesweeperCellLabel newLabel );
 
 private:
-	TMinesweeperGameState state;
+	// collects the cells modified by the engine and reports their events
+	// unless Events is nullptr
+	struct CModifiedCells {
+		CMinesweeperDirtyCells& Cells;
+		CMinesweeperDirtyCells& EncodedCells;
+		CMinesweeperCounters& Counters;
+		CMinesweeperEventRing* Events;
+		const TBoard& Board;
+
+		void OnModified( size_t index );
+		void OnModifiedMask( size_t word, uint64_t mask );
+		void OnCascadeBegin( size_t index );
+		void OnCascadeEnd( size_t index );
+		// pushes the event of the opened or labeled cell
+		void Report( size_t index );
+	};
+
+	// the state of the game before a move, the board shares the planes
+	struct CUndoState {
+		TBoard Board;
+		size_t MoveLogSize;
+		size_t NumberOfMoves;
+
+		CUndoState() : MoveLogSize( 0 ), NumberOfMoves( 0 ) {}
+	};
+
+	const CMinesweeperSizePolicy policy;
 	size_t rows;
 	size_t columns;
 	size_t bombs;
-	vector<unique_ptr<CMinesweeperCell>> cells;
-	size_t numberOfOpenedCells;
-	mutable unordered_set<size_t> modifiedCellIndices;
-
-	void reset();
-	vector<CMinesweeperCell*> findNeighbors( size_t index ) const;
-	void plantBombs();
-	void plantBomb( size_t index );
-	bool open( size_t index );
-	void openBombs();
-	void openNeighbors( size_t index );
-	size_t CalculateNumberOfNeighborCellsLabeledAsBombs( size_t index ) const;
-	bool hasSuccess();
-
-	CMinesweeperGame();
+	TMinesweeperFirstClick firstClick;
+	TBoard board;
+	CMinesweeperEngine engine;
+	vector<CMinesweeperCell<TBoard>> cells;
+	mutable CMinesweeperDirtyCells modifiedCells;
+	// the cells modified since the previous encoding
+	mutable CMinesweeperDirtyCells encodedCells;
+	mutable bool encodeAll;
+	mutable TMinesweeperBoardEncoding lastEncoding;
+	CMinesweeperEventRing events;
+	CMinesweeperMoveLog moveLog;
+	// the ring of the states before the last moves, the undo depth long
+	vector<unique_ptr<CUndoState>> undoStates;
+	size_t firstUndoState;
+	size_t numberOfUndoStates;
+
+	void start( uint64_t seed );
+	void resize();
+	void makeCells();
+	// keeps the state before the move and gets the board ready for the move
+	void beginMove();
+	void dropUndoStates();
+	int8_t cellCode( size_t index ) const;
+	CModifiedCells observer( bool reportsEvents );
+	void reportState( TMinesweeperGameState previousState );
+
+	explicit CMinesweeperGame( const CMinesweeperSizePolicy& policy );
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
-CMinesweeperGame::CMinesweeperGame() :
-	state( MGS_Failure ),
+template<typename TBoard>
+CMinesweeperGame<TBoard>::CMinesweeperGame( const CMinesweeperSizePolicy& _policy ) :
+	policy( _policy ),
 	rows( 0 ),
 	columns( 0 ),
 	bombs( 0 ),
-	numberOfOpenedCells( 0 )
+	firstClick( MFC_Opening ),
+	encodeAll( true ),
+	lastEncoding( MBE_Codes ),
+	firstUndoState( 0 ),
+	numberOfUndoStates( 0 )
+{
+}
+
+template<typename TBoard>
+shared_ptr<IMinesweeperGame> CMinesweeperGame<TBoard>::Create(
+	const CMinesweeperSizePolicy& policy, size_t rows, size_t columns, size_t bombs )
 {
+	shared_ptr<CMinesweeperGame<TBoard>> game( new CMinesweeperGame<TBoard>( policy ) );
+	game->NewGame( rows, columns, bombs );
+	return game;
 }
 
-void CMinesweeperGame::NewGame( size_t _rows, size_t _columns, size_t _bombs )
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::NewGame( size_t _rows, size_t _columns, size_t _bombs )
 {
-	internal_check( _rows >= 9 && _rows <= 24 );
-	internal_check( _columns >= 9 && _columns <= 30 );
-	internal_check( _bombs >= 10 && _bombs <= static_cast<size_t>( 0.93 * _rows * _columns ) );
+	internal_check( policy.Allows( _rows, _columns, _bombs ) );
+	// bigger boards are played by the tiled game
+	internal_check( _rows * _columns <= policy.MaxFlatCells );
+	internal_check( TBoard::Fits( _rows, _columns ) );
 
 	rows = _rows;
 	columns = _columns;
@@ -214,310 +230,548 @@ void CMinesweeperGame::NewGame( size_t _rows, size_t _columns, size_t _bombs )
 	NewGame();
 }
 
-void CMinesweeperGame::NewGame()
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::NewGame( size_t _rows, size_t _columns, size_t _bombs,
+	uint64_t _seed )
 {
-	reset();
-
-	//shared_ptr<CMinesweeperGame> ptr( this );
+	internal_check( policy.Allows( _rows, _columns, _bombs ) );
+	internal_check( _rows * _columns <= policy.MaxFlatCells );
+	internal_check( TBoard::Fits( _rows, _columns ) );
 
-	cells.resize( rows * columns );
-	for( size_t index = 0; index < cells.size(); index++ ) {
-		cells[index].reset( new CMinesweeperCell( shared_from_this(), index ) );
-	}
+	rows = _rows;
+	columns = _columns;
+	bombs = _bombs;
 
-	plantBombs();
+	start( _seed );
 }
 
-void CMinesweeperGame::RestartGame()
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::NewGame()
 {
-	reset();
-
-	for( size_t index = 0; index < cells.size(); index++ ) {
-		cells[index]->Close();
-	}
+	start( GenerateSeed() );
 }
 
-CMinesweeperCell* CMinesweeperGame::Cell( size_t row, size_t column )
-{
-	internal_check( row < rows );
-	internal_check( column < columns );
-	return cells[row * columns + column].get();
+// a game of the same size reuses all storage, only the bombs are planted
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::start( uint64_t seed )
+{
+	dropUndoStates();
+	resize();
+	board.Unshare();
+	engine.Start( board, bombs, seed, firstClick );
+	encodeAll = true;
+	moveLog.Reset( rows, columns, bombs, seed, firstClick );
+	events.Push( MET_NewGame, 0, rows, columns );
+	events.Flush();
 }
 
-const CMinesweeperCell* CMinesweeperGame::Cell( size_t row, size_t column ) const
+// the board planes are cleared by the engine on the start
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::resize()
 {
-	return const_cast<CMinesweeperGame&>( *this ).Cell( row, column );
+	if( rows == board.Rows() && columns == board.Columns() && !cells.empty() ) {
+		modifiedCells.Clear();
+		return;
+	}
+
+	board.Reset( rows, columns );
+	engine.Reset( board );
+	modifiedCells.Reset( board );
+	encodedCells.Reset( board );
+	makeCells();
 }
 
-vector<pair<size_t, size_t>> CMinesweeperGame::ModifiedCells() const
+// the cell proxies depend only on the board dimensions
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::makeCells()
 {
-	vector<pair<size_t, size_t>> result;
-	result.reserve( modifiedCellIndices.size() );
-	for( auto i = modifiedCellIndices.cbegin(); i != modifiedCellIndices.cend(); ++i ) {
-		result.push_back( make_pair( ( *i ) / columns, ( *i ) % columns ) );
+	cells.clear();
+	cells.reserve( board.Size() );
+	for( size_t row = 0; row < rows; row++ ) {
+		for( size_t column = 0; column < columns; column++ ) {
+			cells.emplace_back( *this, board, board.Index( row, column ) );
+		}
 	}
-	modifiedCellIndices.clear();
-	return move( result );
 }
 
-void CMinesweeperGame::OnOpen( CMinesweeperCell* cell )
-{
-	internal_check( cell != nullptr );
-	internal_check( state == MGS_Active );
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::RestartGame()
+{
+	beginMove();
+	modifiedCells.Clear();
+	// the cells are reported before they are closed, so only the restart is an event
+	CModifiedCells modified = observer( false );
+	engine.Restart( board, modified );
+	moveLog.Append( MMT_Restart, 0 );
+	events.Push( MET_Restart, 0, 0, 0 );
+	events.Flush();
+}
+
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::Serialize( vector<uint8_t>& buffer ) const
+{
+	// the policy may allow flat boards bigger than the header fields
+	internal_check( rows <= UINT32_MAX && columns <= UINT32_MAX );
+	internal_check( bombs <= UINT32_MAX );
+	CMinesweeperSnapshotHeader header = {};
+	header.Magic = CMinesweeperSnapshotHeader::SnapshotMagic;
+	header.Version = CMinesweeperSnapshotHeader::CurrentVersion;
+	header.HeaderSize = sizeof( CMinesweeperSnapshotHeader );
+	header.Rows = static_cast<uint32_t>( rows );
+	header.Columns = static_cast<uint32_t>( columns );
+	header.Bombs = static_cast<uint32_t>( bombs );
+	header.State = static_cast<uint8_t>( board.State() );
+	header.PendingFirstClick = static_cast<uint8_t>( board.PendingFirstClick() );
+	header.Seed = board.Seed();
+
+	WriteSnapshot( header,
+		[this]( size_t row, size_t column ) { return board.IsBomb( board.Index( row, column ) ); },
+		[this]( size_t row, size_t column ) { return board.IsOpened( board.Index( row, column ) ); },
+		[this]( size_t row, size_t column ) { return board.Label( board.Index( row, column ) ); },
+		buffer );
+}
 
-	const size_t index = cell->Index();
-	internal_check( index < cells.size() );
-	internal_check( cells[index].get() == cell );
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::Deserialize( const void* data, size_t size )
+{
+	const CMinesweeperSnapshotView snapshot( data, size );
+	internal_check( policy.Allows( snapshot.Rows(), snapshot.Columns(), snapshot.Bombs() ) );
+	internal_check( snapshot.Rows() * snapshot.Columns() <= policy.MaxFlatCells );
+	internal_check( TBoard::Fits( snapshot.Rows(), snapshot.Columns() ) );
+
+	// the moves before the snapshot are unknown
+	moveLog.ResetNotReplayable( snapshot.Rows(), snapshot.Columns(),
+		snapshot.Bombs(), snapshot.Seed() );
+	rows = snapshot.Rows();
+	columns = snapshot.Columns();
+	bombs = snapshot.Bombs();
+	dropUndoStates();
+	resize();
+	board.Unshare();
+	if( snapshot.PendingFirstClick() != MFC_Any ) {
+		// the bombs are planted by the first open as in the saved game
+		engine.Start( board, bombs, snapshot.Seed(), snapshot.PendingFirstClick() );
+	} else {
+		engine.Start( board, snapshot.BombMask(), snapshot.Seed() );
+		internal_check( board.Bombs() == bombs );
+	}
 
-	if( cell->IsOpened() ) {
-		if( cell->GetNumberOfNeighborBombs() == CalculateNumberOfNeighborCellsLabeledAsBombs( index ) ) {
-			openNeighbors( index );
+	for( size_t row = 0; row < rows; row++ ) {
+		for( size_t column = 0; column < columns; column++ ) {
+			const size_t index = board.Index( row, column );
+			if( snapshot.IsOpened( row, column ) ) {
+				board.SetIsOpened( index );
+			}
+			// revealed bombs keep their labels
+			board.SetLabel( index, snapshot.Label( row, column ) );
+			modifiedCells.Mark( index );
 		}
-	} else if( open( index ) ) {
-		if( !hasSuccess() && cell->GetNumberOfNeighborBombs() == 0 ) {
-			openNeighbors( index );
+	}
+	board.SetNumberOfOpenedCells( board.CountOpenedSafeCells() );
+	board.SetState( snapshot.GameState() );
+	encodeAll = true;
+	if( events.IsEnabled() ) {
+		events.Push( MET_NewGame, 0, rows, columns );
+		CModifiedCells modified = observer( true );
+		for( size_t row = 0; row < rows; row++ ) {
+			for( size_t column = 0; column < columns; column++ ) {
+				const size_t index = board.Index( row, column );
+				if( board.IsOpened( index ) || board.Label( index ) != MCL_None ) {
+					modified.Report( index );
+				}
+			}
 		}
+		reportState( MGS_Active );
+		events.Flush();
 	}
 }
 
-void CMinesweeperGame::OnModified( CMinesweeperCell* cell )
-{
-	internal_check( cell != nullptr );
-	internal_check( state == MGS_Active );
-
-	const size_t index = cell->Index();
-	internal_check( index < cells.size() );
-	internal_check( cells[index].get() == cell );
+// the cells taken from the bitmap are in row major order, so the writes
+// of an incremental encoding move forward through the buffer
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::EncodeBoard( TMinesweeperBoardEncoding encoding,
+	void* buffer, size_t size, bool incremental ) const
+{
+	internal_check( size >= EncodedBoardSize( encoding, rows, columns ) );
+	CMinesweeperBoardEncoder encoder( encoding, buffer, rows * columns );
+	if( !incremental || encodeAll || encoding != lastEncoding ) {
+		encodedCells.Clear();
+		for( size_t row = 0; row < rows; row++ ) {
+			const size_t first = board.Index( row, 0 );
+			for( size_t column = 0; column < columns; column++ ) {
+				encoder.Set( row * columns + column, cellCode( first + column ) );
+			}
+		}
+		encodeAll = false;
+		lastEncoding = encoding;
+		return;
+	}
 
-	modifiedCellIndices.insert( index );
+	encodedCells.Take( [this, &encoder]( size_t row, size_t column ) {
+		encoder.Set( row * columns + column, cellCode( board.Index( row, column ) ) );
+	} );
 }
 
-void CMinesweeperGame::reset()
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::SetEventSink( IMinesweeperEventSink* sink, size_t capacity )
 {
-	state = MGS_Active;
-	modifiedCellIndices.clear();
-	numberOfOpenedCells = 0;
+	events.Reset( sink, capacity );
 }
 
-vector<CMinesweeperCell*> CMinesweeperGame::findNeighbors( size_t index ) const
-{
-	internal_check( index < cells.size() );
+// the engine of the fork prepares its buffers by its first flood fill
+// and the cell proxies are made by the first Cell(), so only the game
+// and the bitmaps of modified cells are allocated
+template<typename TBoard>
+shared_ptr<IMinesweeperGame> CMinesweeperGame<TBoard>::Fork() const
+{
+	shared_ptr<CMinesweeperGame<TBoard>> fork( new CMinesweeperGame<TBoard>( policy ) );
+	fork->rows = rows;
+	fork->columns = columns;
+	fork->bombs = bombs;
+	fork->firstClick = firstClick;
+	fork->board.Share( board );
+	fork->modifiedCells.Reset( board );
+	fork->encodedCells.Reset( board );
+	fork->moveLog = moveLog;
+	return fork;
+}
 
-	const size_t row = index / columns;
-	const size_t column = index % columns;
-	const bool top = row > 0;
-	const bool bottom = row < ( rows - 1 );
-	const bool left = column > 0;
-	const bool right = column < ( columns - 1 );
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::SetUndoDepth( size_t depth )
+{
+	dropUndoStates();
+	undoStates.clear();
+	undoStates.reserve( depth );
+	for( size_t i = 0; i < depth; i++ ) {
+		undoStates.emplace_back( new CUndoState );
+	}
+}
 
-	vector<CMinesweeperCell*> neighbors;
-	if( top ) {
-		if( left ) {
-			neighbors.push_back( cells[index - columns - 1].get() );
-		}
-		neighbors.push_back( cells[index - columns].get() );
-		if( right ) {
-			neighbors.push_back( cells[index - columns + 1].get() );
+// only opened or labeled cells are changed by moves, the cells are reported
+// by their restored codes
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::UndoMove()
+{
+	internal_check( numberOfUndoStates > 0 );
+	numberOfUndoStates--;
+	CUndoState& undoState =
+		*undoStates[( firstUndoState + numberOfUndoStates ) % undoStates.size()];
+	const TMinesweeperGameState previousState = board.State();
+	events.Push( MET_Undo, 0, 0, 0 );
+	if( !board.SharesPlanes( undoState.Board ) ) {
+		CModifiedCells modified = { modifiedCells, encodedCells, engine.Counters(),
+			events.IsEnabled() ? &events : nullptr, undoState.Board };
+		const uint8_t* const isOpened = board.OpenedPlane();
+		const uint8_t* const labels = board.LabelPlane();
+		const uint8_t* const wasOpened = undoState.Board.OpenedPlane();
+		const uint8_t* const wasLabels = undoState.Board.LabelPlane();
+		for( size_t row = 0; row < rows; row++ ) {
+			const size_t first = board.Index( row, 0 );
+			for( size_t index = first; index < first + columns; index++ ) {
+				if( isOpened[index] != wasOpened[index] || labels[index] != wasLabels[index] ) {
+					modified.OnModified( index );
+				}
+			}
 		}
 	}
+	// the state is dropped, so the board takes its planes without sharing them
+	board.Share( undoState.Board );
+	undoState.Board.Release();
+	moveLog.Truncate( undoState.MoveLogSize, undoState.NumberOfMoves );
+	reportState( previousState );
+	events.Flush();
+}
 
-	if( left ) {
-		neighbors.push_back( cells[index - 1].get() );
-	}
-	if( right ) {
-		neighbors.push_back( cells[index + 1].get() );
+template<typename TBoard>
+int8_t CMinesweeperGame<TBoard>::cellCode( size_t index ) const
+{
+	return CellCode( board.IsOpened( index ), board.IsBomb( index ),
+		board.NumberOfNeighborBombs( index ), board.Label( index ) );
+}
+
+template<typename TBoard>
+CMinesweeperCell<TBoard>* CMinesweeperGame<TBoard>::Cell( size_t row, size_t column )
+{
+	internal_check( row < rows );
+	internal_check( column < columns );
+	if( cells.empty() ) {
+		makeCells();
 	}
+	return &cells[row * columns + column];
+}
 
-	if( bottom ) {
-		if( left ) {
-			neighbors.push_back( cells[index + columns - 1].get() );
-		}
-		neighbors.push_back( cells[index + columns].get() );
-		if( right ) {
-			neighbors.push_back( cells[index + columns + 1].get() );
+template<typename TBoard>
+const CMinesweeperCell<TBoard>* CMinesweeperGame<TBoard>::Cell( size_t row, size_t column ) const
+{
+	return const_cast<CMinesweeperGame<TBoard>&>( *this ).Cell( row, column );
+}
+
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::ChordableCells( vector<pair<size_t, size_t>>& cells ) const
+{
+	cells.clear();
+	if( board.State() != MGS_Active ) {
+		return;
+	}
+	for( size_t row = 0; row < rows; row++ ) {
+		const size_t first = board.Index( row, 0 );
+		for( size_t column = 0; column < columns; column++ ) {
+			if( CMinesweeperEngine::IsChordable( board, first + column ) ) {
+				cells.push_back( make_pair( row, column ) );
+			}
 		}
 	}
+}
 
-	return move( neighbors );
+template<typename TBoard>
+CMinesweeperStatistics CMinesweeperGame<TBoard>::Statistics() const
+{
+	return engine.Counters().Snapshot();
 }
 
-void CMinesweeperGame::plantBombs()
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::ResetStatistics()
 {
-	random_device randomDevice;
-	uniform_int_distribution<size_t> randomGenerator( 0, cells.size() - 1 );
+	engine.Counters().Reset();
+}
 
-	for( size_t numberOfPlantedBombs = 0; numberOfPlantedBombs < bombs; ) {
-		const size_t index = randomGenerator( randomDevice );
-		if( !cells[index]->GetIsBomb() ) {
-			plantBomb( index );
-			numberOfPlantedBombs++;
-		}
-	}
+template<typename TBoard>
+vector<pair<size_t, size_t>> CMinesweeperGame<TBoard>::ModifiedCells() const
+{
+	vector<pair<size_t, size_t>> result;
+	result.reserve( modifiedCells.Count() );
+	modifiedCells.Take( result );
+	return result;
 }
 
-void CMinesweeperGame::plantBomb( size_t index )
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::ModifiedCells( vector<pair<size_t, size_t>>& cells ) const
 {
-	internal_check( !cells[index]->GetIsBomb() );
-	cells[index]->SetIsBomb();
+	modifiedCells.Take( cells );
+}
 
-	vector<CMinesweeperCell*> neighbors = findNeighbors( index );
-	for( auto i = neighbors.begin(); i != neighbors.end(); ++i ) {
-		CMinesweeperCell* cell = *i;
-		cell->SetNumberOfNeighborBombs( cell->GetNumberOfNeighborBombs() + 1 );
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::ModifiedSpans( vector<CMinesweeperCellSpan>& spans ) const
+{
+	modifiedCells.TakeSpans( spans );
+}
+
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::OnOpen( size_t index )
+{
+	const TMinesweeperMoveType type = board.IsOpened( index ) ? MMT_Chord : MMT_Open;
+	const TMinesweeperGameState previousState = board.State();
+	// the checks of the engine are made first, so failed moves keep no state
+	internal_check( board.State() == MGS_Active );
+	// the opens of labeled cells and the chords which open no neighbors
+	// change nothing, so they are not moves
+	if( type == MMT_Chord ? !CMinesweeperEngine::IsChordable( board, index )
+		: board.Label( index ) != MCL_None )
+	{
+		engine.Counters().Add( MC_Opens, 1 );
+		return;
 	}
+	beginMove();
+	CModifiedCells modified = observer( true );
+	engine.Open( board, index, modified );
+	moveLog.Append( type, board.Row( index ) * columns + board.Column( index ) );
+	reportState( previousState );
+	events.Flush();
 }
 
-bool CMinesweeperGame::open( size_t index )
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::OnSetLabel( size_t index, TMinesweeperCellLabel newLabel )
 {
-	CMinesweeperCell* cell = cells[index].get();
-	if( !cell->IsOpened() && cell->Label() == MCL_None ) {
-		cell->InternalOpen();
+	internal_check( !board.IsOpened( index ) );
+	// setting the same label changes nothing, so it is not a move
+	if( board.Label( index ) == newLabel ) {
+		return;
+	}
+	internal_check( board.State() == MGS_Active );
+	beginMove();
+	CModifiedCells modified = observer( true );
+	engine.SetLabel( board, index, newLabel, modified );
+	moveLog.Append( static_cast<TMinesweeperMoveType>( MMT_LabelNone + newLabel ),
+		board.Row( index ) * columns + board.Column( index ) );
+	events.Flush();
+}
 
-		if( cell->GetIsBomb() ) {
-			openBombs();
-			return false;
+// the oldest state is dropped once the ring is full
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::beginMove()
+{
+	if( !undoStates.empty() ) {
+		if( numberOfUndoStates == undoStates.size() ) {
+			firstUndoState = ( firstUndoState + 1 ) % undoStates.size();
+			numberOfUndoStates--;
 		}
+		CUndoState& undoState =
+			*undoStates[( firstUndoState + numberOfUndoStates ) % undoStates.size()];
+		undoState.Board.Share( board );
+		undoState.MoveLogSize = moveLog.Size();
+		undoState.NumberOfMoves = moveLog.NumberOfMoves();
+		numberOfUndoStates++;
+	}
+	// the bombs stay shared unless the move plants them
+	if( board.PendingFirstClick() != MFC_Any ) {
+		board.Unshare();
+	} else {
+		board.UnshareMovePlanes();
+	}
+}
 
-		numberOfOpenedCells++;
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::dropUndoStates()
+{
+	// the kept boards share the planes, so the game would copy them by its next move
+	for( size_t i = 0; i < numberOfUndoStates; i++ ) {
+		undoStates[( firstUndoState + i ) % undoStates.size()]->Board.Release();
 	}
-	return true;
+	firstUndoState = 0;
+	numberOfUndoStates = 0;
 }
 
-void CMinesweeperGame::openBombs()
+template<typename TBoard>
+typename CMinesweeperGame<TBoard>::CModifiedCells CMinesweeperGame<TBoard>::observer(
+	bool reportsEvents )
 {
-	for( auto i = cells.begin(); i != cells.end(); ++i ) {
-		CMinesweeperCell* cell = i->get();
-		if( cell->GetIsBomb() ) {
-			cell->InternalOpen();
-		}
+	CModifiedCells modified = { modifiedCells, encodedCells, engine.Counters(),
+		reportsEvents && events.IsEnabled() ? &events : nullptr, board };
+	return modified;
+}
+
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::reportState( TMinesweeperGameState previousState )
+{
+	if( board.State() != previousState ) {
+		events.Push( MET_StateChanged, static_cast<int8_t>( board.State() ), 0, 0 );
 	}
-	state = MGS_Failure;
-}
-
-// OnOpen
-// I. The cell is not opened:
-//    1. The cell is bomb:
-//       Boom!
-//    2. The cell has N > 0 bombs in its neighbors:
-//       Just open the cell!
-//    3. The cell has no bombs in its neighbors:
-//       Open the cell and its neighbors (recursively)
-// II. The cell is already opened:
-//     2. Number of labeled neighbor bombs equal to number of neighbor bombs:
-//        Open neighbors
-
-void CMinesweeperGame::openNeighbors( size_t index )
-{
-	unordered_set<size_t> unprocessed;
-	unprocessed.insert( index );
-
-	while( !unprocessed.empty() ) {
-		const size_t current = *unprocessed.begin();
-		unprocessed.erase( unprocessed.begin() );
-
-		vector<CMinesweeperCell*> neighbors = findNeighbors( current );
-		for( auto i = neighbors.begin(); i != neighbors.end(); ++i ) {
-			const size_t neighborIndex = ( *i )->Index();
-			if( !cells[neighborIndex]->IsOpened() ) {
-				if( !open( neighborIndex ) ) {
-					return;
-				}
-				if( cells[neighborIndex]->GetNumberOfNeighborBombs() == 0 ) {
-					unprocessed.insert( neighborIndex );
-				}
-			}
-		}
+}
+
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::CModifiedCells::OnModified( size_t index )
+{
+	Cells.Mark( index );
+	EncodedCells.Mark( index );
+	Counters.Add( MC_ModifiedCells, 1 );
+	if( Events != nullptr ) {
+		Report( index );
 	}
 }
 
-size_t CMinesweeperGame::CalculateNumberOfNeighborCellsLabeledAsBombs( size_t index ) const
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::CModifiedCells::OnModifiedMask( size_t word, uint64_t mask )
 {
-	vector<CMinesweeperCell*> neighbors = findNeighbors( index );
-	size_t numberOfNeighborCellsLabeledAsBombs = 0;
-	for( auto i = neighbors.cbegin(); i != neighbors.cend(); ++i ) {
-		CMinesweeperCell* cell = *i;
-		if( !cell->IsOpened() && cell->Label() == MCL_Bomb ) {
-			numberOfNeighborCellsLabeledAsBombs++;
+	Cells.MarkMask( word, mask );
+	EncodedCells.MarkMask( word, mask );
+	Counters.Add( MC_ModifiedCells, PopulationCount( mask ) );
+	if( Events != nullptr ) {
+		for( ; mask != 0; mask &= mask - 1 ) {
+			const size_t index = word * 64 + CountTrailingZeros( mask );
+			Events->Push( MET_Opened, MCC_Bomb, Board.Row( index ), Board.Column( index ) );
 		}
 	}
-	return numberOfNeighborCellsLabeledAsBombs;
 }
 
-bool CMinesweeperGame::hasSuccess()
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::CModifiedCells::Report( size_t index )
 {
-	internal_check( state == MGS_Active );
-	const size_t numberOfSafeCells = cells.size() - bombs;
-	internal_check( numberOfOpenedCells <= numberOfSafeCells );
-	if( numberOfOpenedCells == numberOfSafeCells ) {
-		state = MGS_Success;
-	}
-	return ( state == MGS_Success );
+	const bool isOpened = Board.IsOpened( index );
+	Events->Push( isOpened ? MET_Opened : MET_Labeled,
+		CellCode( isOpened, Board.IsBomb( index ), Board.NumberOfNeighborBombs( index ),
+			Board.Label( index ) ),
+		Board.Row( index ), Board.Column( index ) );
 }
 
-////////////////////////////////////////////////////////////////////////////////
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::CModifiedCells::OnCascadeBegin( size_t index )
+{
+	if( Events != nullptr ) {
+		Events->Push( MET_CascadeBegin, 0, Board.Row( index ), Board.Column( index ) );
+	}
+}
 
-shared_ptr<IMinesweeperGame> CreateGame( size_t rows, size_t columns,
-	size_t bombs )
+template<typename TBoard>
+void CMinesweeperGame<TBoard>::CModifiedCells::OnCascadeEnd( size_t index )
 {
-	shared_ptr<CMinesweeperGame> game( new CMinesweeperGame );
-	game->NewGame( rows, columns, bombs );
-	return game;
+	if( Events != nullptr ) {
+		Events->Push( MET_CascadeEnd, 0, Board.Row( index ), Board.Column( index ) );
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-} // end of Minesweeper namespace
+template<typename TBoard>
+void CMinesweeperCell<TBoard>::SetLabel( TMinesweeperCellLabel newLabel )
+{
+	game.OnSetLabel( index, newLabel );
+}
+
+template<typename TBoard>
+void CMinesweeperCell<TBoard>::Open()
+{
+	game.OnOpen( index );
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
-using namespace Minesweeper;
-
-void Draw( const IMinesweeperGame* game )
-{
-	for( size_t i = 0; i < game->Rows(); i++ ) {
-		for( size_t j = 0; j < game->Columns(); j++ ) {
-			const IMinesweeperCell* cell = game->Cell( i, j );
-			if( cell->IsOpened() ) {
-				if( cell->IsBomb() ) {
-					cout << "*";
-				} else {
-					size_t bombs = cell->NumberOfNeighborBombs();
-					if( bombs == 0 ) {
-						cout << "O";
-					} else {
-						cout << bombs;
-					}
-				}
-			} else {
-				cout << "-";
-			}
-		}
-		cout << endl;
-	}
-	cout << endl;
+bool CMinesweeperSizePolicy::Allows( size_t rows, size_t columns, size_t bombs ) const
+{
+	return rows >= MinRows && rows <= MaxRows
+		&& columns >= MinColumns && columns <= MaxColumns
+		&& ( columns == 0 || rows <= numeric_limits<size_t>::max() / columns )
+		&& bombs >= MinBombs
+		&& bombs <= static_cast<size_t>( MaxBombsRatio * rows * columns );
+}
+
+CMinesweeperSizePolicy ClassicSizePolicy()
+{
+	const CMinesweeperSizePolicy policy = { 9, 24, 9, 30, 10, 0.93, 24 * 30 };
+	return policy;
 }
 
-int main( int argc, const char* argv[] )
+CMinesweeperSizePolicy UnlimitedSizePolicy()
 {
-	try {
-		shared_ptr<IMinesweeperGame> game = CreateGame();
-		Draw( game.get() );
+	const CMinesweeperSizePolicy policy = { 1, numeric_limits<size_t>::max(),
+		1, numeric_limits<size_t>::max(), 0, 0.93, 1024 * 1024 };
+	return policy;
+}
 
-		random_device randomDevice;
-		size_t max = game->Rows() * game->Columns() - 1;
-		uniform_int_distribution<size_t> randomGenerator( 0, max );
+shared_ptr<IMinesweeperGame> CreateGame( size_t rows, size_t columns,
+	size_t bombs )
+{
+	return CreateGame( rows, columns, bombs, ClassicSizePolicy() );
+}
 
-		while( game->GameState() == MGS_Active ) {
-			const size_t index = randomGenerator( randomDevice );
-			const size_t row = index / game->Columns();
-			const size_t column = index % game->Columns();
-			game->Cell( row, column )->Open();
-			Draw( game.get() );
-		}
-	} catch( exception& e ) {
-		cerr << e.what() << endl;
-		return 1;
+shared_ptr<IMinesweeperGame> CreateGame( size_t rows, size_t columns,
+	size_t bombs, const CMinesweeperSizePolicy& policy )
+{
+	internal_check( policy.Allows( rows, columns, bombs ) );
+	if( rows * columns > policy.MaxFlatCells ) {
+		return CreateTiledGame( rows, columns, bombs, policy );
 	}
 
-	return 0;
+	return CMinesweeperGame<CMinesweeperBoard>::Create( policy, rows, columns, bombs );
+}
+
+shared_ptr<IMinesweeperGame> CreateFixedSizeGame( size_t rows, size_t columns,
+	size_t bombs )
+{
+	if( CMinesweeperBeginnerBoard::Fits( rows, columns ) ) {
+		return CMinesweeperGame<CMinesweeperBeginnerBoard>::Create( ClassicSizePolicy(),
+			rows, columns, bombs );
+	} else if( CMinesweeperIntermediateBoard::Fits( rows, columns ) ) {
+		return CMinesweeperGame<CMinesweeperIntermediateBoard>::Create( ClassicSizePolicy(),
+			rows, columns, bombs );
+	} else if( CMinesweeperExpertBoard::Fits( rows, columns ) ) {
+		return CMinesweeperGame<CMinesweeperExpertBoard>::Create( ClassicSizePolicy(),
+			rows, columns, bombs );
+	}
+	return CreateGame( rows, columns, bombs );
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -20,7 +21,7 @@ enum TMinesweeperCellLabel {
 class IMinesweeperCell {
 public:
 	// destructor
-	virtual ~IMinesweeperCell() = 0 {}
+	virtual ~IMinesweeperCell() = 0;
 
 	// whether the cell is opened (exception safe)
 	virtual bool IsOpened() const = 0;
@@ -41,6 +42,10 @@ public:
 	virtual void Open() = 0;
 };
 
+inline IMinesweeperCell::~IMinesweeperCell()
+{
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 // The state of the game
@@ -50,10 +55,74 @@ enum TMinesweeperGameState {
 	MGS_Success
 };
 
+// How the first open of a game is protected from bombs
+enum TMinesweeperFirstClick {
+	MFC_Any, // the bombs are planted by NewGame, the first open may hit a bomb
+	MFC_Safe, // the bombs are planted by the first open, never at the opened cell
+	MFC_Opening // the same, also never at the neighbors, so the first open opens an area
+};
+
+// Codes of the visible cells, opened cells which are not bombs
+// are coded by their numbers of neighbor bombs 0..8
+enum TMinesweeperCellCode {
+	MCC_Closed = -1,
+	MCC_Bomb = 9, // opened bomb, only failed games have them
+	MCC_LabeledBomb = 10, // closed cell labeled as bomb
+	MCC_LabeledQuestion = 11, // closed cell labeled as question
+	MCC_NumberOfCodes = 13 // including closed cells
+};
+
+// Layouts of the visible board, the cell i is ( row * columns + column )
+enum TMinesweeperBoardEncoding {
+	// the byte i is the code of the cell i (int8_t)
+	MBE_Codes,
+	// the lower 4 bits of the codes, the cell i is the low half of the byte
+	// i / 2 for even i and the high half for odd i, closed cells are 15
+	MBE_Nibbles,
+	// MCC_NumberOfCodes planes of rows * columns bytes, the byte i of the plane
+	// p is 1 if the cell i has the code p and 0 otherwise, the last plane is
+	// the plane of closed cells
+	MBE_OneHot
+};
+
+// returns the size of the visible board in the encoding in bytes (exception safe)
+size_t EncodedBoardSize( TMinesweeperBoardEncoding encoding, size_t rows, size_t columns );
+
+// Run of cells of a row: the columns [FirstColumn, EndColumn) of the Row
+struct CMinesweeperCellSpan {
+	size_t Row;
+	size_t FirstColumn;
+	size_t EndColumn;
+};
+
+// Counters of the work done by a game
+struct CMinesweeperStatistics {
+	// calls of IMinesweeperCell::Open
+	uint64_t Opens;
+	// flood fills (cascades and openings of neighbors of opened cells)
+	uint64_t FloodFills;
+	// cells queued by flood fills
+	uint64_t FloodFillIterations;
+	// scans of the neighbors of a cell by moves: by flood fills (a failed
+	// flood fill stops at the bomb) and by changes of labels as bombs
+	uint64_t NeighborScans;
+	// cells opened by flood fills and the biggest single flood fill
+	uint64_t CascadeCells;
+	uint64_t MaxCascadeCells;
+	// modifications of cells reported through ModifiedCells
+	uint64_t ModifiedCells;
+	// bomb plantings and the time spent in them
+	uint64_t PlantBombs;
+	uint64_t PlantBombsNanoseconds;
+};
+
+class CMinesweeperMoveLog;
+class IMinesweeperEventSink;
+
 class IMinesweeperGame {
 public:
 	// destructor
-	virtual ~IMinesweeperGame() = 0 {}
+	virtual ~IMinesweeperGame() = 0;
 
 	// returns current game status (exception safe)
 	virtual TMinesweeperGameState GameState() const = 0;
@@ -62,26 +131,155 @@ public:
 	virtual size_t Rows() const = 0;
 	virtual size_t Columns() const = 0;
 	virtual size_t Bombs() const = 0;
+	// returns the seed the bombs of current game were planted from (exception safe)
+	// or the seed of the generation of a no-guess board (MinesweeperNoGuess.h)
+	virtual uint64_t Seed() const = 0;
+	// returns the number of opened cells which are not bombs (exception safe)
+	// the game is won when all ( Rows() * Columns() - Bombs() ) such cells are opened
+	virtual size_t NumberOfOpenedCells() const = 0;
 
 	// starts a new game with passed parameters (throw an exception if failed)
 	virtual void NewGame( size_t rows, size_t columns, size_t bombs ) = 0;
+	// starts a new game with passed parameters and bombs planted from the seed,
+	// the same parameters, seed and first open give the same board
+	// (throw an exception if failed)
+	virtual void NewGame( size_t rows, size_t columns, size_t bombs, uint64_t seed ) = 0;
 	// starts a new game with current (or default) parameters (throw an exception if failed)
 	virtual void NewGame() = 0;
 	// restarts current game (throw an exception if failed)
 	virtual void RestartGame() = 0;
 
+	// sets the protection of the first open of next games
+	// (throw an exception if the game does not support it)
+	virtual void SetFirstClick( TMinesweeperFirstClick firstClick ) = 0;
+	// returns the protection of the first open, MFC_Opening by default
+	// for flat boards, tiled boards support only MFC_Any (exception safe)
+	virtual TMinesweeperFirstClick FirstClick() const = 0;
+
+	// appends the packed snapshot of the game to the buffer (MinesweeperSnapshot.h)
+	virtual void Serialize( vector<uint8_t>& buffer ) const = 0;
+	// restores the game from the snapshot (throw an exception if failed)
+	// all cells are reported as modified
+	virtual void Deserialize( const void* data, size_t size ) = 0;
+
+	// writes the visible board into the buffer of EncodedBoardSize( encoding,
+	// Rows(), Columns() ) bytes, if incremental only the cells modified since
+	// the previous encoding are written, so the buffer must keep the previous
+	// encoding, a new game or another encoding is written whole anyway
+	// note: the encoding does not reset the modified cells of ModifiedCells
+	// (throw an exception if the buffer is too small)
+	virtual void EncodeBoard( TMinesweeperBoardEncoding encoding, void* buffer,
+		size_t size, bool incremental ) const = 0;
+
+	// sets the sink of the events of the game (MinesweeperEvents.h), the events
+	// of a move are delivered once the move is done through the event ring
+	// of the capacity, nullptr stops the events, the sink is not owned
+	// (throw an exception if failed)
+	virtual void SetEventSink( IMinesweeperEventSink* sink, size_t capacity ) = 0;
+
+	// returns the log of the moves of current game (MinesweeperMoveLog.h)
+	// the log is cleared by a new game, a restart is recorded as a move
+	virtual const CMinesweeperMoveLog& MoveLog() const = 0;
+
+	// returns a new game in the same state with the same parameters and move
+	// log, the board is shared copy on write (the planes of flat boards, the tiles
+	// of tiled boards), so no cells are copied by the fork, the storage changed
+	// by a move of either game is copied first, the fork has no modified cells,
+	// no event sink and no undo states (throw an exception if failed)
+	virtual shared_ptr<IMinesweeperGame> Fork() const = 0;
+	// keeps the states before the last moves of the log up to the depth,
+	// the states share the board copy on write like forks (the opens and
+	// labelings which change nothing are not moves), zero depth keeps
+	// no states, the kept states are dropped by a new game or a new depth
+	// (throw an exception if failed)
+	virtual void SetUndoDepth( size_t depth ) = 0;
+	// returns the undo depth, zero by default (exception safe)
+	virtual size_t UndoDepth() const = 0;
+	// returns the number of moves which can be undone (exception safe)
+	virtual size_t NumberOfUndoMoves() const = 0;
+	// takes back the last move, the cells changed back are reported as modified
+	// (throw an exception if there is no move to undo)
+	virtual void UndoMove() = 0;
+
 	// access to the game cells
+	// the cells are owned by the game and are valid until it is destroyed
+	// or a new game changes the dimensions, use ShareCell to keep the game
 	virtual IMinesweeperCell* Cell( size_t row, size_t column ) = 0;
 	virtual const IMinesweeperCell* Cell( size_t row, size_t column ) const = 0;
+	// fills the buffer by the positions of the opened cells which open their
+	// neighbors when opened again, in row major order: the numbers of their
+	// neighbor bombs and of their neighbors labeled as bombs match and some
+	// neighbor is closed and not labeled, empty unless the game is active
+	virtual void ChordableCells( vector<pair<size_t, size_t>>& cells ) const = 0;
+
+	// returns a snapshot of the statistics of the game (exception safe)
+	// all counters are zero unless built with MINESWEEPER_STATISTICS
+	virtual CMinesweeperStatistics Statistics() const = 0;
+	// resets all counters of the statistics (exception safe)
+	virtual void ResetStatistics() = 0;
 
 	// returns positions of cells which have been modified since previous call
 	// note: the method resets the internal cell modified flag
 	// I believe such methods should be qualified as const
 	virtual vector<pair<size_t, size_t>> ModifiedCells() const = 0; // move semantic
+	// the same in row major order into the buffer (its capacity is reused,
+	// so the polling allocates nothing once the buffer is big enough)
+	virtual void ModifiedCells( vector<pair<size_t, size_t>>& cells ) const = 0;
+	// the same as runs of modified cells in row major order
+	virtual void ModifiedSpans( vector<CMinesweeperCellSpan>& spans ) const = 0;
 };
 
+inline IMinesweeperGame::~IMinesweeperGame()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Limits of the game parameters
+struct CMinesweeperSizePolicy {
+	size_t MinRows;
+	size_t MaxRows;
+	size_t MinColumns;
+	size_t MaxColumns;
+	size_t MinBombs;
+	// maximum ratio of bombs to cells of the board
+	double MaxBombsRatio;
+	// boards with more cells are stored in lazily generated tiles,
+	// so the memory used is proportional to the explored area of the board
+	size_t MaxFlatCells;
+
+	// checks the game parameters against the limits (exception safe)
+	bool Allows( size_t rows, size_t columns, size_t bombs ) const;
+};
+
+// the classic limits: 9-24 rows, 9-30 columns, 10 bombs up to 93% of cells
+CMinesweeperSizePolicy ClassicSizePolicy();
+// any board which cells can be numbered by size_t, huge boards are tiled
+CMinesweeperSizePolicy UnlimitedSizePolicy();
+
+////////////////////////////////////////////////////////////////////////////////
+
 shared_ptr<IMinesweeperGame> CreateGame( size_t rows = 9, size_t columns = 9,
 	size_t bombs = 10 );
+// creates a game which NewGame accepts the parameters allowed by the policy,
+// a flat game (up to MaxFlatCells of the policy) accepts only flat boards,
+// so bigger boards need a game created for them
+shared_ptr<IMinesweeperGame> CreateGame( size_t rows, size_t columns,
+	size_t bombs, const CMinesweeperSizePolicy& policy );
+
+// creates a game specialized for its dimensions if they are standard
+// (9x9, 16x16 or 16x30), NewGame of such game accepts only the same
+// dimensions, other dimensions get the game of CreateGame
+shared_ptr<IMinesweeperGame> CreateFixedSizeGame( size_t rows, size_t columns,
+	size_t bombs );
+
+// returns the cell which shares the ownership of its game, so the cell
+// cannot outlive the game (only getting the cell touches the reference count)
+inline shared_ptr<IMinesweeperCell> ShareCell( const shared_ptr<IMinesweeperGame>& game,
+	size_t row, size_t column )
+{
+	return shared_ptr<IMinesweeperCell>( game, game->Cell( row, column ) );
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <limits>
+#include <MinesweeperBatch.h>
+#include <MinesweeperRandom.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperBoardBatch::CMinesweeperBoardBatch() :
+	rows( 0 ),
+	columns( 0 ),
+	bombs( 0 ),
+	seed( 0 ),
+	numberOfBoards( 0 )
+{
+}
+
+void CMinesweeperBoardBatch::Generate( size_t _rows, size_t _columns, size_t _bombs,
+	size_t _numberOfBoards, uint64_t _seed, size_t numberOfThreads )
+{
+	internal_check( _rows > 0 && _columns > 0 );
+	internal_check( _rows <= numeric_limits<size_t>::max() / _columns );
+	internal_check( _bombs <= _rows * _columns );
+
+	const size_t planesSize = CMinesweeperBoardView::NumberOfPlanes
+		* CMinesweeperBoardView::PlaneSize( _rows, _columns );
+	const size_t boardSize = ( planesSize + BoardAlignment - 1 )
+		/ BoardAlignment * BoardAlignment;
+	internal_check( _numberOfBoards <= numeric_limits<size_t>::max() / boardSize );
+
+	rows = _rows;
+	columns = _columns;
+	bombs = _bombs;
+	seed = _seed;
+	numberOfBoards = _numberOfBoards;
+
+	// the extra bytes align the first board
+	arena.resize( numberOfBoards * boardSize + BoardAlignment );
+	const size_t misalignment = reinterpret_cast<uintptr_t>( arena.data() ) % BoardAlignment;
+	uint8_t* const first = arena.data() + ( BoardAlignment - misalignment ) % BoardAlignment;
+
+	const shared_ptr<const CMinesweeperBoardGeometry> geometry =
+		CMinesweeperBoardGeometry::Get( rows, columns );
+	boards.resize( numberOfBoards );
+	for( size_t i = 0; i < numberOfBoards; i++ ) {
+		boards[i].Attach( first + i * boardSize, geometry );
+	}
+
+	ForEachBoard(
+		[this]( CMinesweeperEngine& engine, CMinesweeperBoardView& board, size_t index ) {
+			engine.Start( board, bombs, seed ^ MixSeed( index ) );
+		},
+		numberOfThreads );
+}
+
+size_t CMinesweeperBoardBatch::threadsFor( size_t numberOfThreads ) const
+{
+	if( numberOfThreads == 0 ) {
+		numberOfThreads = max<size_t>( thread::hardware_concurrency(), 1 );
+	}
+	return min( numberOfThreads, numberOfBoards );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <exception>
+#include <MinesweeperBoard.h>
+#include <MinesweeperEngine.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Batch of boards of the same configuration
+// all boards live in a single contiguous arena and are accessed through
+// board views, so the engine plays them without any per board allocation,
+// the board i is planted from the seed ( seed ^ MixSeed( i ) )
+class CMinesweeperBoardBatch {
+public:
+	// boards start at cache line boundaries, so threads never share a line
+	static const size_t BoardAlignment = 64;
+
+	CMinesweeperBoardBatch();
+	CMinesweeperBoardBatch( const CMinesweeperBoardBatch& ) = delete;
+	CMinesweeperBoardBatch& operator=( const CMinesweeperBoardBatch& ) = delete;
+
+	// fills the batch by new boards in parallel (throw an exception if failed)
+	// zero number of threads means the number of hardware threads
+	// (allocates only if the batch grows)
+	void Generate( size_t rows, size_t columns, size_t bombs,
+		size_t numberOfBoards, uint64_t seed, size_t numberOfThreads = 0 );
+
+	size_t Rows() const { return rows; }
+	size_t Columns() const { return columns; }
+	size_t Bombs() const { return bombs; }
+	uint64_t Seed() const { return seed; }
+	size_t Size() const { return numberOfBoards; }
+
+	CMinesweeperBoardView& Board( size_t index );
+	const CMinesweeperBoardView& Board( size_t index ) const;
+
+	// calls function( engine, board, index ) for all boards of the batch,
+	// the boards are split between the threads in contiguous ranges,
+	// each thread has its own engine prepared for the boards
+	template<typename TFunction>
+	void ForEachBoard( TFunction function, size_t numberOfThreads = 0 );
+
+private:
+	size_t rows;
+	size_t columns;
+	size_t bombs;
+	uint64_t seed;
+	size_t numberOfBoards;
+	vector<uint8_t> arena;
+	vector<CMinesweeperBoardView> boards;
+
+	size_t threadsFor( size_t numberOfThreads ) const;
+	template<typename TFunction>
+	void forEachBoard( TFunction& function, size_t begin, size_t end );
+};
+
+inline CMinesweeperBoardView& CMinesweeperBoardBatch::Board( size_t index )
+{
+	internal_check( index < numberOfBoards );
+	return boards[index];
+}
+
+inline const CMinesweeperBoardView& CMinesweeperBoardBatch::Board( size_t index ) const
+{
+	return const_cast<CMinesweeperBoardBatch&>( *this ).Board( index );
+}
+
+template<typename TFunction>
+void CMinesweeperBoardBatch::ForEachBoard( TFunction function, size_t numberOfThreads )
+{
+	const size_t threads = threadsFor( numberOfThreads );
+	if( threads <= 1 ) {
+		forEachBoard( function, 0, numberOfBoards );
+		return;
+	}
+
+	vector<exception_ptr> errors( threads );
+	vector<thread> workers;
+	workers.reserve( threads - 1 );
+	for( size_t i = 1; i < threads; i++ ) {
+		const size_t begin = numberOfBoards * i / threads;
+		const size_t end = numberOfBoards * ( i + 1 ) / threads;
+		workers.emplace_back( [this, &function, &errors, i, begin, end]() {
+			try {
+				forEachBoard( function, begin, end );
+			} catch( ... ) {
+				errors[i] = current_exception();
+			}
+		} );
+	}
+	// the calling thread takes the first range
+	try {
+		forEachBoard( function, 0, numberOfBoards / threads );
+	} catch( ... ) {
+		errors[0] = current_exception();
+	}
+	for( size_t i = 0; i < workers.size(); i++ ) {
+		workers[i].join();
+	}
+	for( size_t i = 0; i < errors.size(); i++ ) {
+		if( errors[i] ) {
+			rethrow_exception( errors[i] );
+		}
+	}
+}
+
+template<typename TFunction>
+void CMinesweeperBoardBatch::forEachBoard( TFunction& function, size_t begin, size_t end )
+{
+	if( begin == end ) {
+		return;
+	}
+	CMinesweeperEngine engine;
+	engine.Reset( boards[begin] );
+	for( size_t index = begin; index < end; index++ ) {
+		function( engine, boards[index], index );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,174 @@
+#include <MinesweeperBitboard.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// the value of the column ( c - 1 ) moved to the column c
+inline uint64_t fromLeft( const uint64_t* row, size_t word )
+{
+	return ( row[word] << 1 ) | ( word > 0 ? row[word - 1] >> 63 : 0 );
+}
+
+// the value of the column ( c + 1 ) moved to the column c
+inline uint64_t fromRight( const uint64_t* row, size_t word, size_t wordsPerRow )
+{
+	return ( row[word] >> 1 ) | ( word + 1 < wordsPerRow ? row[word + 1] << 63 : 0 );
+}
+
+inline void fullAdder( uint64_t a, uint64_t b, uint64_t c, uint64_t& sum, uint64_t& carry )
+{
+	const uint64_t halfSum = a ^ b;
+	sum = halfSum ^ c;
+	carry = ( a & b ) | ( halfSum & c );
+}
+
+} // end of anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperBitboard::CMinesweeperBitboard() :
+	rows( 0 ),
+	columns( 0 ),
+	wordsPerRow( 0 ),
+	lastWordMask( 0 )
+{
+}
+
+void CMinesweeperBitboard::Reset( size_t _rows, size_t _columns )
+{
+	rows = _rows;
+	columns = _columns;
+	wordsPerRow = ( columns + 63 ) / 64;
+	lastWordMask = ( columns % 64 == 0 ) ? ~uint64_t( 0 )
+		: ( uint64_t( 1 ) << ( columns % 64 ) ) - 1;
+
+	bombs.assign( ( rows + 2 ) * wordsPerRow, 0 );
+	for( size_t plane = 0; plane < NumberOfCountPlanes; plane++ ) {
+		counts[plane].assign( MaskSize(), 0 );
+	}
+	zero.assign( MaskSize(), 0 );
+	dilated.assign( ( rows + 2 ) * wordsPerRow, 0 );
+}
+
+void CMinesweeperBitboard::SetBomb( size_t row, size_t column )
+{
+	internal_check( row < rows && column < columns );
+	bombs[( row + 1 ) * wordsPerRow + column / 64] |= uint64_t( 1 ) << ( column % 64 );
+}
+
+// Eight neighbor bits of every cell are summed up by a tree of adders
+// working on 64 cells at once:
+//   three full adders and a half adder give the bit 0 and four carries,
+//   the carries (weight 2) are summed up into the bits 1, 2 and 3
+void CMinesweeperBitboard::CalculateNumberOfNeighborBombs()
+{
+	for( size_t row = 0; row < rows; row++ ) {
+		const uint64_t* const above = bombs.data() + row * wordsPerRow;
+		const uint64_t* const middle = above + wordsPerRow;
+		const uint64_t* const below = middle + wordsPerRow;
+
+		for( size_t word = 0; word < wordsPerRow; word++ ) {
+			uint64_t sum1, carry1, sum2, carry2, sum4, carry4, sum5, carry5;
+			fullAdder( fromLeft( above, word ), above[word],
+				fromRight( above, word, wordsPerRow ), sum1, carry1 );
+			fullAdder( fromLeft( below, word ), below[word],
+				fromRight( below, word, wordsPerRow ), sum2, carry2 );
+			const uint64_t left = fromLeft( middle, word );
+			const uint64_t right = fromRight( middle, word, wordsPerRow );
+			const uint64_t sum3 = left ^ right;
+			const uint64_t carry3 = left & right;
+			fullAdder( sum1, sum2, sum3, sum4, carry4 );
+			fullAdder( carry1, carry2, carry3, sum5, carry5 );
+			const uint64_t bit1 = sum5 ^ carry4;
+			const uint64_t carry6 = sum5 & carry4;
+
+			const size_t index = row * wordsPerRow + word;
+			const uint64_t mask = wordMask( word );
+			counts[0][index] = sum4 & mask;
+			counts[1][index] = bit1 & mask;
+			counts[2][index] = ( carry5 ^ carry6 ) & mask;
+			counts[3][index] = ( carry5 & carry6 ) & mask;
+			zero[index] = ~( sum4 | bit1 | carry5 | carry6 | middle[word] ) & mask;
+		}
+	}
+}
+
+size_t CMinesweeperBitboard::NumberOfNeighborBombs( size_t row, size_t column ) const
+{
+	const size_t index = row * wordsPerRow + column / 64;
+	const size_t shift = column % 64;
+	size_t numberOfNeighborBombs = 0;
+	for( size_t plane = 0; plane < NumberOfCountPlanes; plane++ ) {
+		numberOfNeighborBombs |= ( ( counts[plane][index] >> shift ) & 1 ) << plane;
+	}
+	return numberOfNeighborBombs;
+}
+
+void CMinesweeperBitboard::StoreNumberOfNeighborBombs( CMinesweeperBoardView& board ) const
+{
+	internal_check( board.Rows() == rows && board.Columns() == columns );
+
+	for( size_t row = 0; row < rows; row++ ) {
+		size_t index = board.Index( row, 0 );
+		for( size_t word = 0; word < wordsPerRow; word++ ) {
+			const size_t maskIndex = row * wordsPerRow + word;
+			const uint64_t bit0 = counts[0][maskIndex];
+			const uint64_t bit1 = counts[1][maskIndex];
+			const uint64_t bit2 = counts[2][maskIndex];
+			const uint64_t bit3 = counts[3][maskIndex];
+			const size_t bits = ( word + 1 < wordsPerRow ) ? 64 : columns - word * 64;
+			for( size_t bit = 0; bit < bits; bit++, index++ ) {
+				board.SetNumberOfNeighborBombs( index, ( ( bit0 >> bit ) & 1 )
+					| ( ( ( bit1 >> bit ) & 1 ) << 1 )
+					| ( ( ( bit2 >> bit ) & 1 ) << 2 )
+					| ( ( ( bit3 >> bit ) & 1 ) << 3 ) );
+			}
+		}
+	}
+}
+
+void CMinesweeperBitboard::FloodFill( uint64_t* opened, const uint64_t* blocked ) const
+{
+	uint64_t* const expanding = dilated.data() + wordsPerRow;
+
+	for( bool changed = true; changed; ) {
+		// horizontal dilation of opened cells without neighbor bombs
+		for( size_t row = 0; row < rows; row++ ) {
+			const size_t first = row * wordsPerRow;
+			for( size_t word = 0; word < wordsPerRow; word++ ) {
+				const size_t index = first + word;
+				const uint64_t current = opened[index] & zero[index];
+				const uint64_t previous = ( word > 0 ) ? opened[index - 1] & zero[index - 1] : 0;
+				const uint64_t next = ( word + 1 < wordsPerRow ) ? opened[index + 1] & zero[index + 1] : 0;
+				expanding[index] = current | ( current << 1 ) | ( previous >> 63 )
+					| ( current >> 1 ) | ( next << 63 );
+			}
+		}
+
+		// vertical dilation masked by not blocked cells
+		changed = false;
+		for( size_t row = 0; row < rows; row++ ) {
+			const uint64_t* const middle = expanding + row * wordsPerRow;
+			const uint64_t* const above = middle - wordsPerRow;
+			const uint64_t* const below = middle + wordsPerRow;
+			for( size_t word = 0; word < wordsPerRow; word++ ) {
+				const size_t index = row * wordsPerRow + word;
+				const uint64_t reached = ( above[word] | middle[word] | below[word] )
+					& ~blocked[index] & wordMask( word );
+				if( ( reached & ~opened[index] ) != 0 ) {
+					opened[index] |= reached;
+					changed = true;
+				}
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <MinesweeperBoard.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Bitboard representation of the board
+// each row of the board is a sequence of 64-bit words, the column c of
+// the row is the bit ( c % 64 ) of the word ( c / 64 ), the numbers of
+// neighbor bombs are calculated for all cells at once by bit-sliced adders
+// and kept as four bit planes (the binary digits of the number)
+class CMinesweeperBitboard {
+public:
+	static const size_t NumberOfCountPlanes = 4;
+
+	CMinesweeperBitboard();
+	CMinesweeperBitboard( const CMinesweeperBitboard& ) = delete;
+	CMinesweeperBitboard& operator=( const CMinesweeperBitboard& ) = delete;
+
+	// resizes the bitboard and clears it
+	void Reset( size_t rows, size_t columns );
+
+	size_t Rows() const { return rows; }
+	size_t Columns() const { return columns; }
+	size_t WordsPerRow() const { return wordsPerRow; }
+	// number of words in a mask which covers the whole board
+	size_t MaskSize() const { return rows * wordsPerRow; }
+
+	void SetBomb( size_t row, size_t column );
+	bool IsBomb( size_t row, size_t column ) const;
+	// the bomb mask without the sentinel rows
+	const uint64_t* BombMask() const { return bombs.data() + wordsPerRow; }
+
+	// calculates the numbers of neighbor bombs of all cells
+	void CalculateNumberOfNeighborBombs();
+	size_t NumberOfNeighborBombs( size_t row, size_t column ) const;
+	// cells which are not bombs and have no neighbor bombs
+	const uint64_t* ZeroMask() const { return zero.data(); }
+	// copies calculated numbers of neighbor bombs into the board plane
+	void StoreNumberOfNeighborBombs( CMinesweeperBoardView& board ) const;
+
+	// extends the opened mask by all cells reachable from it through
+	// cells without neighbor bombs, the blocked cells are never opened
+	// (iterated dilation masked by cells without neighbor bombs)
+	// the opened and blocked masks have MaskSize() words
+	void FloodFill( uint64_t* opened, const uint64_t* blocked ) const;
+
+private:
+	size_t rows;
+	size_t columns;
+	size_t wordsPerRow;
+	// valid bits of the last word of a row
+	uint64_t lastWordMask;
+	// bomb mask with an empty sentinel row above and below the board
+	vector<uint64_t> bombs;
+	vector<uint64_t> counts[NumberOfCountPlanes];
+	vector<uint64_t> zero;
+	// dilation buffer with sentinel rows
+	mutable vector<uint64_t> dilated;
+
+	uint64_t wordMask( size_t word ) const;
+};
+
+inline bool CMinesweeperBitboard::IsBomb( size_t row, size_t column ) const
+{
+	const uint64_t word = bombs[( row + 1 ) * wordsPerRow + column / 64];
+	return ( ( word >> ( column % 64 ) ) & 1 ) != 0;
+}
+
+inline uint64_t CMinesweeperBitboard::wordMask( size_t word ) const
+{
+	return ( word + 1 == wordsPerRow ) ? lastWordMask : ~uint64_t( 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Bit operations on 64-bit words
+// compiler intrinsics where they are available, portable code otherwise
+
+// number of set bits
+inline unsigned PopulationCount( uint64_t word )
+{
+#if defined( __GNUC__ )
+	return static_cast<unsigned>( __builtin_popcountll( word ) );
+#elif defined( _MSC_VER ) && defined( _M_X64 )
+	return static_cast<unsigned>( __popcnt64( word ) );
+#else
+	word = word - ( ( word >> 1 ) & 0x5555555555555555ULL );
+	word = ( word & 0x3333333333333333ULL ) + ( ( word >> 2 ) & 0x3333333333333333ULL );
+	word = ( word + ( word >> 4 ) ) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<unsigned>( ( word * 0x0101010101010101ULL ) >> 56 );
+#endif
+}
+
+// index of the lowest set bit (the word must not be zero)
+inline unsigned CountTrailingZeros( uint64_t word )
+{
+#if defined( __GNUC__ )
+	return static_cast<unsigned>( __builtin_ctzll( word ) );
+#elif defined( _MSC_VER ) && defined( _M_X64 )
+	unsigned long index;
+	_BitScanForward64( &index, word );
+	return static_cast<unsigned>( index );
+#elif defined( _MSC_VER )
+	unsigned long index;
+	if( _BitScanForward( &index, static_cast<unsigned long>( word ) ) ) {
+		return static_cast<unsigned>( index );
+	}
+	_BitScanForward( &index, static_cast<unsigned long>( word >> 32 ) );
+	return static_cast<unsigned>( index + 32 );
+#else
+	unsigned index = 0;
+	while( ( word & 1 ) == 0 ) {
+		word >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+// packs the lowest bits of the bytes of the word (little endian),
+// the bit i of the result is the lowest bit of the byte i
+inline unsigned PackByteBits( uint64_t bytes )
+{
+	return static_cast<unsigned>( ( ( bytes & 0x0101010101010101ULL )
+		* 0x0102040810204080ULL ) >> 56 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <MinesweeperBoard.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// the neighbor offsets of the views which are not attached
+static const ptrdiff_t noNeighborOffsets[CMinesweeperBoardView::NumberOfNeighbors] = {};
+
+CMinesweeperBoardView::CMinesweeperBoardView() :
+	rows( 0 ),
+	columns( 0 ),
+	stride( 2 ),
+	planeSize( 0 ),
+	neighborOffsets( noNeighborOffsets ),
+	isBomb( nullptr ),
+	isOpened( nullptr ),
+	labels( nullptr ),
+	numberOfNeighborBombs( nullptr ),
+	numberOfNeighborLabeledBombs( nullptr ),
+	state( MGS_Failure ),
+	bombs( 0 ),
+	seed( 0 ),
+	numberOfOpenedCells( 0 ),
+	pendingFirstClick( MFC_Any )
+{
+}
+
+// a view attached again to the same shape keeps its geometry without the lookup
+void CMinesweeperBoardView::Attach( uint8_t* planes, size_t _rows, size_t _columns )
+{
+	if( !geometry || geometry->Rows() != _rows || geometry->Columns() != _columns ) {
+		Attach( planes, CMinesweeperBoardGeometry::Get( _rows, _columns ) );
+	} else {
+		Attach( planes, geometry );
+	}
+}
+
+// the move planes follow the bomb planes
+void CMinesweeperBoardView::Attach( uint8_t* planes,
+	const shared_ptr<const CMinesweeperBoardGeometry>& _geometry )
+{
+	Attach( planes, planes + NumberOfBombPlanes * _geometry->PlaneSize(), _geometry );
+}
+
+void CMinesweeperBoardView::Attach( uint8_t* bombPlanes, uint8_t* movePlanes,
+	const shared_ptr<const CMinesweeperBoardGeometry>& _geometry )
+{
+	geometry = _geometry;
+	rows = geometry->Rows();
+	columns = geometry->Columns();
+	stride = geometry->Stride();
+	planeSize = geometry->PlaneSize();
+	neighborOffsets = geometry->NeighborOffsets();
+
+	isBomb = bombPlanes;
+	numberOfNeighborBombs = isBomb + planeSize;
+	isOpened = movePlanes;
+	labels = isOpened + planeSize;
+	numberOfNeighborLabeledBombs = labels + planeSize;
+}
+
+void CMinesweeperBoardView::Clear()
+{
+	fill( isBomb, isBomb + planeSize, 0 );
+	fill( numberOfNeighborBombs, numberOfNeighborBombs + planeSize, 0 );
+	Close();
+}
+
+void CMinesweeperBoardView::Close()
+{
+	fill( isOpened, isOpened + planeSize, 0 );
+	fill( labels, labels + planeSize, static_cast<uint8_t>( MCL_None ) );
+	fill( numberOfNeighborLabeledBombs, numberOfNeighborLabeledBombs + planeSize, 0 );
+	openBorder();
+}
+
+// the border cells are opened and are not bombs
+size_t CMinesweeperBoardView::CountOpenedSafeCells() const
+{
+	size_t count = 0;
+	size_t index = 0;
+	for( ; index + 8 <= planeSize; index += 8 ) {
+		uint64_t bombWord;
+		uint64_t openedWord;
+		memcpy( &bombWord, isBomb + index, sizeof( bombWord ) );
+		memcpy( &openedWord, isOpened + index, sizeof( openedWord ) );
+		count += PopulationCount( openedWord & ~bombWord & 0x0101010101010101ULL );
+	}
+	for( ; index < planeSize; index++ ) {
+		count += isOpened[index] & ~isBomb[index] & 1;
+	}
+	return count - ( planeSize - Size() );
+}
+
+void CMinesweeperBoardView::openBorder()
+{
+	const size_t lastRow = ( rows + 1 ) * stride;
+	fill( isOpened, isOpened + stride, 1 );
+	fill( isOpened + lastRow, isOpened + planeSize, 1 );
+	for( size_t index = stride; index < lastRow; index += stride ) {
+		isOpened[index] = 1;
+		isOpened[index + stride - 1] = 1;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CMinesweeperBoard::Reset( size_t rows, size_t columns )
+{
+	const size_t planeSize = PlaneSize( rows, columns );
+	if( !bombPlanes || !IsExclusivelyOwned( bombPlanes ) ) {
+		bombPlanes = make_shared<vector<uint8_t>>();
+	}
+	if( !movePlanes || !IsExclusivelyOwned( movePlanes ) ) {
+		movePlanes = make_shared<vector<uint8_t>>();
+	}
+	bombPlanes->resize( NumberOfBombPlanes * planeSize );
+	movePlanes->resize( NumberOfMovePlanes * planeSize );
+	if( !Geometry() || Geometry()->Rows() != rows || Geometry()->Columns() != columns ) {
+		Attach( bombPlanes->data(), movePlanes->data(),
+			CMinesweeperBoardGeometry::Get( rows, columns ) );
+	} else {
+		attach();
+	}
+	Clear();
+}
+
+void CMinesweeperBoard::Share( const CMinesweeperBoard& other )
+{
+	CMinesweeperBoardView::operator=( other );
+	bombPlanes = other.bombPlanes;
+	movePlanes = other.movePlanes;
+}
+
+void CMinesweeperBoard::Unshare()
+{
+	if( bombPlanes && !IsExclusivelyOwned( bombPlanes ) ) {
+		bombPlanes = make_shared<vector<uint8_t>>( *bombPlanes );
+		attach();
+	}
+	UnshareMovePlanes();
+}
+
+void CMinesweeperBoard::UnshareMovePlanes()
+{
+	if( movePlanes && !IsExclusivelyOwned( movePlanes ) ) {
+		movePlanes = make_shared<vector<uint8_t>>( *movePlanes );
+		attach();
+	}
+}
+
+void CMinesweeperBoard::Release()
+{
+	bombPlanes.reset();
+	movePlanes.reset();
+	CMinesweeperBoardView::operator=( CMinesweeperBoardView() );
+}
+
+// the view keeps its play state and its geometry, only the planes move
+void CMinesweeperBoard::attach()
+{
+	Attach( bombPlanes->data(), movePlanes->data(), Geometry() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <Minesweeper.h>
+#include <MinesweeperCommon.h>
+#include <MinesweeperBits.h>
+#include <MinesweeperGeometry.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Flat board storage view
+// every cell attribute lives in its own contiguous byte plane,
+// the planes have a one cell sentinel border around the board:
+// the cell ( row, column ) has index ( ( row + 1 ) * stride + column + 1 ),
+// where stride is ( columns + 2 ), the border cells are always opened
+// so neighbor iteration needs no edge checks,
+// the numbers of neighbors labeled as bombs are kept by SetLabel,
+// so the chords compare two bytes instead of scanning the neighbors,
+// the bomb planes (bombs and numbers of neighbor bombs) are written only
+// by planting and the move planes (opened cells, labels and numbers of
+// neighbors labeled as bombs) by the moves, so they may be stored apart,
+// the view does not own the planes, it also keeps the play state
+// of the board so the game rules can run on any view, the layout
+// of the planes is the geometry shared by all boards of the shape
+class CMinesweeperBoardView {
+public:
+	static const size_t NumberOfNeighbors = CMinesweeperBoardGeometry::NumberOfNeighbors;
+	static const size_t NumberOfBombPlanes = 2;
+	static const size_t NumberOfMovePlanes = 3;
+	static const size_t NumberOfPlanes = NumberOfBombPlanes + NumberOfMovePlanes;
+
+	CMinesweeperBoardView();
+
+	// size of each plane of the board including the sentinel border
+	static size_t PlaneSize( size_t rows, size_t columns );
+	// points the view to NumberOfPlanes * PlaneSize( rows, columns ) bytes
+	// (throw an exception if the shape does not fit CMinesweeperBoardGeometry)
+	void Attach( uint8_t* planes, size_t rows, size_t columns );
+	void Attach( uint8_t* planes, const shared_ptr<const CMinesweeperBoardGeometry>& geometry );
+	// points the view to NumberOfBombPlanes and NumberOfMovePlanes planes
+	void Attach( uint8_t* bombPlanes, uint8_t* movePlanes,
+		const shared_ptr<const CMinesweeperBoardGeometry>& geometry );
+	// clears all planes
+	void Clear();
+	// clears opened and label planes, bombs and numbers of neighbor bombs are kept
+	void Close();
+
+	size_t Rows() const { return rows; }
+	size_t Columns() const { return columns; }
+	// number of board cells
+	size_t Size() const { return rows * columns; }
+	// distance between vertically adjacent cells in the planes
+	size_t Stride() const { return stride; }
+	// size of each plane including the sentinel border
+	size_t PlaneSize() const { return planeSize; }
+
+	size_t Index( size_t row, size_t column ) const { return ( row + 1 ) * stride + column + 1; }
+	size_t Row( size_t index ) const { return geometry->Row( index ); }
+	size_t Column( size_t index ) const { return geometry->Column( index ); }
+	// offsets from a cell index to all its neighbor indices
+	const ptrdiff_t* NeighborOffsets() const { return neighborOffsets; }
+	const shared_ptr<const CMinesweeperBoardGeometry>& Geometry() const { return geometry; }
+
+	bool IsBomb( size_t index ) const { return isBomb[index] != 0; }
+	bool IsOpened( size_t index ) const { return isOpened[index] != 0; }
+	TMinesweeperCellLabel Label( size_t index ) const;
+	size_t NumberOfNeighborBombs( size_t index ) const { return numberOfNeighborBombs[index]; }
+	// number of neighbors labeled as bombs (MCL_Bomb), whether opened or not
+	size_t NumberOfNeighborLabeledBombs( size_t index ) const { return numberOfNeighborLabeledBombs[index]; }
+
+	void SetIsBomb( size_t index ) { isBomb[index] = 1; }
+	void ClearIsBomb( size_t index ) { isBomb[index] = 0; }
+	void SetIsOpened( size_t index ) { isOpened[index] = 1; }
+	// also updates the numbers of neighbors labeled as bombs of the neighbors
+	void SetLabel( size_t index, TMinesweeperCellLabel label );
+	void SetNumberOfNeighborBombs( size_t index, size_t count );
+
+	// direct access to the planes for engines
+	const uint8_t* BombPlane() const { return isBomb; }
+	const uint8_t* OpenedPlane() const { return isOpened; }
+	const uint8_t* LabelPlane() const { return labels; }
+	const uint8_t* NumberOfNeighborBombsPlane() const { return numberOfNeighborBombs; }
+	const uint8_t* NumberOfNeighborLabeledBombsPlane() const { return numberOfNeighborLabeledBombs; }
+
+	// bulk operations on the planes, the bomb and opened bytes are 0 or 1,
+	// so 8 cells are processed at once in a 64-bit word
+	// opens all closed bombs and calls opened( word, mask ) for every
+	// 64 indices with opened bombs, the bit i of the mask is the index 64 * word + i
+	template<typename TOpened>
+	void OpenBombs( TOpened opened );
+	// counts the opened cells which are not bombs
+	size_t CountOpenedSafeCells() const;
+
+	// play state of the board
+	TMinesweeperGameState State() const { return state; }
+	void SetState( TMinesweeperGameState newState ) { state = newState; }
+	size_t Bombs() const { return bombs; }
+	void SetBombs( size_t numberOfBombs ) { bombs = numberOfBombs; }
+	uint64_t Seed() const { return seed; }
+	void SetSeed( uint64_t newSeed ) { seed = newSeed; }
+	size_t NumberOfOpenedCells() const { return numberOfOpenedCells; }
+	void SetNumberOfOpenedCells( size_t number ) { numberOfOpenedCells = number; }
+	// the bombs are planted by the first open unless MFC_Any
+	TMinesweeperFirstClick PendingFirstClick() const { return pendingFirstClick; }
+	void SetPendingFirstClick( TMinesweeperFirstClick firstClick ) { pendingFirstClick = firstClick; }
+
+private:
+	size_t rows;
+	size_t columns;
+	size_t stride;
+	size_t planeSize;
+	shared_ptr<const CMinesweeperBoardGeometry> geometry;
+	const ptrdiff_t* neighborOffsets;
+	uint8_t* isBomb;
+	uint8_t* isOpened;
+	uint8_t* labels;
+	uint8_t* numberOfNeighborBombs;
+	uint8_t* numberOfNeighborLabeledBombs;
+	TMinesweeperGameState state;
+	size_t bombs;
+	uint64_t seed;
+	size_t numberOfOpenedCells;
+	TMinesweeperFirstClick pendingFirstClick;
+
+	void openBorder();
+};
+
+template<typename TOpened>
+void CMinesweeperBoardView::OpenBombs( TOpened opened )
+{
+	for( size_t first = 0; first < planeSize; first += 64 ) {
+		const size_t end = first + 64 < planeSize ? first + 64 : planeSize;
+		uint64_t mask = 0;
+		size_t index = first;
+		for( ; index + 8 <= end; index += 8 ) {
+			uint64_t bombWord;
+			uint64_t openedWord;
+			memcpy( &bombWord, isBomb + index, sizeof( bombWord ) );
+			memcpy( &openedWord, isOpened + index, sizeof( openedWord ) );
+			const uint64_t closedBombs = bombWord & ~openedWord;
+			if( closedBombs != 0 ) {
+				openedWord |= closedBombs;
+				memcpy( isOpened + index, &openedWord, sizeof( openedWord ) );
+				mask |= uint64_t( PackByteBits( closedBombs ) ) << ( index - first );
+			}
+		}
+		for( ; index < end; index++ ) {
+			if( ( isBomb[index] & ~isOpened[index] ) != 0 ) {
+				isOpened[index] = 1;
+				mask |= uint64_t( 1 ) << ( index - first );
+			}
+		}
+		if( mask != 0 ) {
+			opened( first / 64, mask );
+		}
+	}
+}
+
+inline size_t CMinesweeperBoardView::PlaneSize( size_t rows, size_t columns )
+{
+	return ( rows + 2 ) * ( columns + 2 );
+}
+
+inline TMinesweeperCellLabel CMinesweeperBoardView::Label( size_t index ) const
+{
+	return static_cast<TMinesweeperCellLabel>( labels[index] );
+}
+
+inline void CMinesweeperBoardView::SetNumberOfNeighborBombs( size_t index, size_t count )
+{
+	numberOfNeighborBombs[index] = static_cast<uint8_t>( count );
+}
+
+inline void CMinesweeperBoardView::SetLabel( size_t index, TMinesweeperCellLabel label )
+{
+	const int change = ( label == MCL_Bomb ? 1 : 0 ) - ( Label( index ) == MCL_Bomb ? 1 : 0 );
+	labels[index] = static_cast<uint8_t>( label );
+	if( change != 0 ) {
+		for( size_t i = 0; i < NumberOfNeighbors; i++ ) {
+			uint8_t& count = numberOfNeighborLabeledBombs[index + neighborOffsets[i]];
+			count = static_cast<uint8_t>( count + change );
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Flat board storage which owns its planes
+// the planes may be shared copy on write by several boards, so a board
+// which shares its planes copies them by Unshare before it is modified,
+// the bomb planes and the move planes are shared apart, so a move which
+// plants no bombs copies only the move planes by UnshareMovePlanes
+class CMinesweeperBoard : public CMinesweeperBoardView {
+public:
+	CMinesweeperBoard() {}
+	CMinesweeperBoard( const CMinesweeperBoard& ) = delete;
+	CMinesweeperBoard& operator=( const CMinesweeperBoard& ) = delete;
+
+	// the board is able to keep any dimensions
+	static bool Fits( size_t /* rows */, size_t /* columns */ ) { return true; }
+	// resizes the board and clears all planes
+	// (allocates only if the board grows or its planes are shared)
+	void Reset( size_t rows, size_t columns );
+
+	// takes the play state of the other board and shares its planes
+	void Share( const CMinesweeperBoard& other );
+	// copies the planes if they are shared, so the board may be modified
+	void Unshare();
+	// copies the move planes if they are shared, the bomb planes stay shared,
+	// so the board may be played but its bombs may not be planted
+	void UnshareMovePlanes();
+	// drops the planes, the board is empty until it is reset or shares planes
+	void Release();
+	// whether the boards have the same planes, so their cells are the same
+	bool SharesPlanes( const CMinesweeperBoard& other ) const;
+
+private:
+	shared_ptr<vector<uint8_t>> bombPlanes;
+	shared_ptr<vector<uint8_t>> movePlanes;
+
+	// points the view to the owned planes, the play state is kept
+	void attach();
+};
+
+inline bool CMinesweeperBoard::SharesPlanes( const CMinesweeperBoard& other ) const
+{
+	return bombPlanes == other.bombPlanes && movePlanes == other.movePlanes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
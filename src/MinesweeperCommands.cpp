@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <unordered_map>
+#include <MinesweeperCommands.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// a batch being processed by the workers
+struct CBatch {
+	vector<CMinesweeperCommand> Commands;
+	// ranges of the commands of the games in the sorted commands
+	vector<size_t> GameBegins;
+	vector<CMinesweeperGameDelta> Deltas;
+	atomic<size_t> NumberOfUnfinishedTasks;
+	// the first failure of the tasks
+	mutex ErrorLock;
+	exception_ptr Error;
+	promise<vector<CMinesweeperGameDelta>> Promise;
+};
+
+// a few tasks per worker balance the games without much queue overhead
+const size_t TasksPerThread = 4;
+
+} // end of anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperCommandProcessor::CMinesweeperCommandProcessor(
+		CMinesweeperGameRegistry& _registry, size_t numberOfThreads ) :
+	registry( _registry ),
+	stopping( false )
+{
+	if( numberOfThreads == 0 ) {
+		numberOfThreads = max<size_t>( thread::hardware_concurrency(), 1 );
+	}
+	workers.reserve( numberOfThreads );
+	for( size_t i = 0; i < numberOfThreads; i++ ) {
+		workers.emplace_back( &CMinesweeperCommandProcessor::work, this );
+	}
+}
+
+// the queued batches are finished before the workers stop
+CMinesweeperCommandProcessor::~CMinesweeperCommandProcessor()
+{
+	{
+		lock_guard<mutex> guard( lock );
+		stopping = true;
+	}
+	hasTasks.notify_all();
+	for( auto i = workers.begin(); i != workers.end(); ++i ) {
+		i->join();
+	}
+}
+
+future<vector<CMinesweeperGameDelta>> CMinesweeperCommandProcessor::Submit(
+	vector<CMinesweeperCommand> commands )
+{
+	const shared_ptr<CBatch> batch = make_shared<CBatch>();
+	future<vector<CMinesweeperGameDelta>> result = batch->Promise.get_future();
+
+	// groups the commands by game, keeps the order of the first commands
+	// of the games and the order of commands of every game
+	vector<pair<size_t, size_t>> order; // ( first command of the game, command )
+	order.reserve( commands.size() );
+	{
+		unordered_map<TMinesweeperGameId, size_t> firstCommands;
+		for( size_t i = 0; i < commands.size(); i++ ) {
+			auto first = firstCommands.emplace( commands[i].Game, i ).first;
+			order.push_back( make_pair( first->second, i ) );
+		}
+	}
+	sort( order.begin(), order.end() );
+
+	batch->Commands.reserve( commands.size() );
+	for( size_t i = 0; i < order.size(); i++ ) {
+		if( i == 0 || order[i].first != order[i - 1].first ) {
+			batch->GameBegins.push_back( i );
+		}
+		batch->Commands.push_back( commands[order[i].second] );
+	}
+	const size_t numberOfGames = batch->GameBegins.size();
+	batch->GameBegins.push_back( commands.size() );
+	batch->Deltas.resize( numberOfGames );
+
+	if( numberOfGames == 0 ) {
+		batch->Promise.set_value( vector<CMinesweeperGameDelta>() );
+		return result;
+	}
+
+	const size_t numberOfTasks = min( numberOfGames, workers.size() * TasksPerThread );
+	batch->NumberOfUnfinishedTasks = numberOfTasks;
+	for( size_t task = 0; task < numberOfTasks; task++ ) {
+		const size_t firstGame = numberOfGames * task / numberOfTasks;
+		const size_t lastGame = numberOfGames * ( task + 1 ) / numberOfTasks;
+		push( [this, batch, firstGame, lastGame]() {
+			try {
+				const CMinesweeperCommand* const commands = batch->Commands.data();
+				for( size_t game = firstGame; game < lastGame; game++ ) {
+					apply( commands + batch->GameBegins[game],
+						commands + batch->GameBegins[game + 1], batch->Deltas[game] );
+				}
+			} catch( ... ) {
+				lock_guard<mutex> guard( batch->ErrorLock );
+				if( !batch->Error ) {
+					batch->Error = current_exception();
+				}
+			}
+			if( batch->NumberOfUnfinishedTasks.fetch_sub( 1 ) == 1 ) {
+				if( batch->Error ) {
+					batch->Promise.set_exception( batch->Error );
+				} else {
+					batch->Promise.set_value( move( batch->Deltas ) );
+				}
+			}
+		} );
+	}
+	return result;
+}
+
+void CMinesweeperCommandProcessor::Process( vector<CMinesweeperCommand> commands,
+	vector<CMinesweeperGameDelta>& deltas )
+{
+	deltas = Submit( move( commands ) ).get();
+}
+
+void CMinesweeperCommandProcessor::work()
+{
+	for( ;; ) {
+		function<void()> task;
+		{
+			unique_lock<mutex> guard( lock );
+			hasTasks.wait( guard, [this]() { return stopping || !tasks.empty(); } );
+			if( tasks.empty() ) {
+				return;
+			}
+			task = move( tasks.front() );
+			tasks.pop_front();
+		}
+		task();
+	}
+}
+
+void CMinesweeperCommandProcessor::push( function<void()> task )
+{
+	{
+		lock_guard<mutex> guard( lock );
+		tasks.push_back( move( task ) );
+	}
+	hasTasks.notify_one();
+}
+
+// a rejected command does not stop the next commands of the game
+void CMinesweeperCommandProcessor::apply( const CMinesweeperCommand* begin,
+	const CMinesweeperCommand* end, CMinesweeperGameDelta& delta )
+{
+	delta.Game = begin->Game;
+	delta.State = MGS_Failure;
+	delta.Applied = 0;
+	delta.Rejected = 0;
+	delta.Found = registry.Write( delta.Game, [begin, end, &delta]( IMinesweeperGame& game ) {
+		for( const CMinesweeperCommand* command = begin; command != end; ++command ) {
+			try {
+				IMinesweeperCell* const cell = game.Cell( command->Row, command->Column );
+				if( command->Action == MA_Open ) {
+					cell->Open();
+				} else {
+					cell->SetLabel( command->Label );
+				}
+				delta.Applied++;
+			} catch( exception& ) {
+				delta.Rejected++;
+			}
+		}
+		game.ModifiedCells( delta.ModifiedCells );
+		delta.State = game.GameState();
+	} );
+	if( !delta.Found ) {
+		delta.Rejected = static_cast<size_t>( end - begin );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
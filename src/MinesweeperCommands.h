@@ -0,0 +1,89 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <Minesweeper.h>
+#include <MinesweeperRegistry.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+enum TMinesweeperAction {
+	MA_Open,
+	MA_SetLabel
+};
+
+// A command of a client for a game of a registry
+struct CMinesweeperCommand {
+	TMinesweeperGameId Game;
+	size_t Row;
+	size_t Column;
+	TMinesweeperAction Action;
+	// the new label for MA_SetLabel
+	TMinesweeperCellLabel Label;
+};
+
+// The result of all commands of a batch for one game
+struct CMinesweeperGameDelta {
+	TMinesweeperGameId Game;
+	// state of the game after the commands
+	TMinesweeperGameState State;
+	// number of applied and rejected commands (rejected commands
+	// are bad cells, opens of finished games and so on)
+	size_t Applied;
+	size_t Rejected;
+	// false if there is no such game in the registry
+	bool Found;
+	// all cells modified by the commands in row major order
+	vector<pair<size_t, size_t>> ModifiedCells;
+};
+
+// Batched command processing on a worker pool
+// the commands of a batch are grouped by game, the commands of a game
+// are applied in their batch order by one worker being the writer
+// of the game, so every game costs one registry lookup, one lock and
+// one poll of modified cells per batch instead of per command
+// note: commands of a game from different batches which are processed
+// at the same time may be applied in any order
+class CMinesweeperCommandProcessor {
+public:
+	// zero number of threads means the number of hardware threads
+	explicit CMinesweeperCommandProcessor( CMinesweeperGameRegistry& registry,
+		size_t numberOfThreads = 0 );
+	~CMinesweeperCommandProcessor();
+	CMinesweeperCommandProcessor( const CMinesweeperCommandProcessor& ) = delete;
+	CMinesweeperCommandProcessor& operator=( const CMinesweeperCommandProcessor& ) = delete;
+
+	// queues the batch, the deltas are ordered by the first command of the game
+	future<vector<CMinesweeperGameDelta>> Submit( vector<CMinesweeperCommand> batch );
+	// the same, waits for the deltas
+	void Process( vector<CMinesweeperCommand> batch, vector<CMinesweeperGameDelta>& deltas );
+
+	size_t NumberOfThreads() const { return workers.size(); }
+
+private:
+	CMinesweeperGameRegistry& registry;
+	mutex lock;
+	condition_variable hasTasks;
+	deque<function<void()>> tasks;
+	bool stopping;
+	vector<thread> workers;
+
+	void work();
+	void push( function<void()> task );
+	void apply( const CMinesweeperCommand* begin, const CMinesweeperCommand* end,
+		CMinesweeperGameDelta& delta );
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
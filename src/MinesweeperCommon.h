@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <stdexcept>
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define internal_check( condition ) \
+	do { \
+		if( !( condition ) ) { \
+			throw logic_error( "internal program error at " \
+				+ to_string( __LINE__ ) + " line in file " + __FILE__ ); \
+		} \
+	} while( false )
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace Minesweeper {
+
+// whether the pointer is the only owner of its object, so the object may be
+// modified in place (copy on write storage shared by games), the fence orders
+// the modification after the reads of the owners released on other threads
+template<typename T>
+inline bool IsExclusivelyOwned( const std::shared_ptr<T>& pointer )
+{
+	if( pointer.use_count() != 1 ) {
+		return false;
+	}
+	std::atomic_thread_fence( std::memory_order_acquire );
+	return true;
+}
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,99 @@
+#include <MinesweeperDirtyCells.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperDirtyCells::CMinesweeperDirtyCells() :
+	columns( 0 ),
+	stride( 2 )
+{
+}
+
+void CMinesweeperDirtyCells::Reset( const CMinesweeperBoardView& board )
+{
+	columns = board.Columns();
+	stride = board.Stride();
+	const size_t numberOfWords = ( board.PlaneSize() + 63 ) / 64;
+	bits.assign( numberOfWords, 0 );
+	summary.assign( ( numberOfWords + 63 ) / 64, 0 );
+}
+
+void CMinesweeperDirtyCells::Clear()
+{
+	for( size_t s = 0; s < summary.size(); s++ ) {
+		uint64_t summaryWord = summary[s];
+		summary[s] = 0;
+		while( summaryWord != 0 ) {
+			bits[s * 64 + CountTrailingZeros( summaryWord )] = 0;
+			summaryWord &= summaryWord - 1;
+		}
+	}
+}
+
+size_t CMinesweeperDirtyCells::Count() const
+{
+	size_t count = 0;
+	for( size_t s = 0; s < summary.size(); s++ ) {
+		uint64_t summaryWord = summary[s];
+		while( summaryWord != 0 ) {
+			count += PopulationCount( bits[s * 64 + CountTrailingZeros( summaryWord )] );
+			summaryWord &= summaryWord - 1;
+		}
+	}
+	return count;
+}
+
+void CMinesweeperDirtyCells::Take( vector<pair<size_t, size_t>>& cells )
+{
+	cells.clear();
+	Take( [&cells]( size_t row, size_t column ) {
+		cells.push_back( make_pair( row, column ) );
+	} );
+}
+
+void CMinesweeperDirtyCells::TakeSpans( vector<CMinesweeperCellSpan>& spans )
+{
+	spans.clear();
+	size_t row = 0;
+	size_t rowStart = stride + 1;
+	for( size_t s = 0; s < summary.size(); s++ ) {
+		uint64_t summaryWord = summary[s];
+		summary[s] = 0;
+		while( summaryWord != 0 ) {
+			const size_t w = s * 64 + CountTrailingZeros( summaryWord );
+			summaryWord &= summaryWord - 1;
+			uint64_t word = bits[w];
+			bits[w] = 0;
+			// every run of set bits is a span, the border cells are never
+			// marked, so a run never crosses rows
+			while( word != 0 ) {
+				const unsigned start = CountTrailingZeros( word );
+				const uint64_t rest = ~( word >> start );
+				const unsigned length = ( rest == 0 ) ? 64 - start : CountTrailingZeros( rest );
+				word = ( start + length == 64 ) ? 0
+					: word & ~( ( ( uint64_t( 1 ) << length ) - 1 ) << start );
+
+				const size_t index = w * 64 + start;
+				advanceRow( index, row, rowStart );
+				const size_t column = index - rowStart;
+				internal_check( column + length <= columns );
+				// a run may continue in the next word
+				if( !spans.empty() && spans.back().Row == row
+					&& spans.back().EndColumn == column )
+				{
+					spans.back().EndColumn += length;
+				} else {
+					const CMinesweeperCellSpan span = { row, column, column + length };
+					spans.push_back( span );
+				}
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
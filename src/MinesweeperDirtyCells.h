@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <Minesweeper.h>
+#include <MinesweeperBits.h>
+#include <MinesweeperBoard.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Bitmap of modified cells of a board
+// one bit per cell index of the board planes, and one summary bit per
+// word of the bitmap, so marking is two stores without branches and
+// taking the cells costs O( dirty words ) plus one summary bit per 64 words,
+// the cells are taken in row major order, the rows are tracked while
+// scanning, so no division is needed to convert an index to a position
+class CMinesweeperDirtyCells {
+public:
+	CMinesweeperDirtyCells();
+	CMinesweeperDirtyCells( const CMinesweeperDirtyCells& ) = delete;
+	CMinesweeperDirtyCells& operator=( const CMinesweeperDirtyCells& ) = delete;
+
+	// prepares the bitmap for the board and clears it
+	// (allocates only if the board grows)
+	void Reset( const CMinesweeperBoardView& board );
+	// marks the cell with board index
+	void Mark( size_t index );
+	// marks the cells with board indices ( 64 * word + i ) for the bits i of the mask
+	void MarkMask( size_t word, uint64_t mask );
+	void Clear();
+	// number of marked cells
+	size_t Count() const;
+
+	// calls function( row, column ) for every marked cell and clears the bitmap
+	template<typename TFunction>
+	void Take( TFunction function );
+	// fills the buffer by the marked cells and clears the bitmap
+	void Take( vector<pair<size_t, size_t>>& cells );
+	// fills the buffer by the runs of marked cells and clears the bitmap
+	void TakeSpans( vector<CMinesweeperCellSpan>& spans );
+
+private:
+	size_t columns;
+	size_t stride;
+	vector<uint64_t> bits;
+	vector<uint64_t> summary;
+
+	// finds the row of the index, rows are passed in increasing order
+	void advanceRow( size_t index, size_t& row, size_t& rowStart ) const;
+};
+
+inline void CMinesweeperDirtyCells::Mark( size_t index )
+{
+	const size_t word = index / 64;
+	bits[word] |= uint64_t( 1 ) << ( index % 64 );
+	summary[word / 64] |= uint64_t( 1 ) << ( word % 64 );
+}
+
+inline void CMinesweeperDirtyCells::MarkMask( size_t word, uint64_t mask )
+{
+	bits[word] |= mask;
+	summary[word / 64] |= uint64_t( mask != 0 ? 1 : 0 ) << ( word % 64 );
+}
+
+inline void CMinesweeperDirtyCells::advanceRow( size_t index, size_t& row,
+	size_t& rowStart ) const
+{
+	while( index >= rowStart + stride ) {
+		rowStart += stride;
+		row++;
+	}
+}
+
+template<typename TFunction>
+void CMinesweeperDirtyCells::Take( TFunction function )
+{
+	// the first cell of the row is next after its border cell
+	size_t row = 0;
+	size_t rowStart = stride + 1;
+	for( size_t s = 0; s < summary.size(); s++ ) {
+		uint64_t summaryWord = summary[s];
+		summary[s] = 0;
+		while( summaryWord != 0 ) {
+			const size_t w = s * 64 + CountTrailingZeros( summaryWord );
+			summaryWord &= summaryWord - 1;
+			uint64_t word = bits[w];
+			bits[w] = 0;
+			while( word != 0 ) {
+				const size_t index = w * 64 + CountTrailingZeros( word );
+				word &= word - 1;
+				advanceRow( index, row, rowStart );
+				function( row, index - rowStart );
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
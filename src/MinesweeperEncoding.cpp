@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <limits>
+#include <MinesweeperCommon.h>
+#include <MinesweeperEncoding.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t EncodedBoardSize( TMinesweeperBoardEncoding encoding, size_t rows, size_t columns )
+{
+	if( columns != 0 && rows > numeric_limits<size_t>::max() / columns ) {
+		return numeric_limits<size_t>::max();
+	}
+	const size_t numberOfCells = rows * columns;
+	switch( encoding ) {
+		case MBE_Codes:
+			return numberOfCells;
+		case MBE_Nibbles:
+			return numberOfCells / 2 + numberOfCells % 2;
+		case MBE_OneHot:
+			return numberOfCells <= numeric_limits<size_t>::max() / MCC_NumberOfCodes
+				? numberOfCells * MCC_NumberOfCodes : numeric_limits<size_t>::max();
+	}
+	return numeric_limits<size_t>::max();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperBoardEncoder::CMinesweeperBoardEncoder( TMinesweeperBoardEncoding _encoding,
+	void* _buffer, size_t _numberOfCells ) :
+	encoding( _encoding ),
+	buffer( static_cast<uint8_t*>( _buffer ) ),
+	numberOfCells( _numberOfCells )
+{
+	internal_check( encoding == MBE_Codes || encoding == MBE_Nibbles
+		|| encoding == MBE_OneHot );
+}
+
+void CMinesweeperBoardEncoder::Fill( int8_t code )
+{
+	switch( encoding ) {
+		case MBE_Codes:
+			fill( buffer, buffer + numberOfCells, static_cast<uint8_t>( code ) );
+			break;
+		case MBE_Nibbles:
+			fill( buffer, buffer + numberOfCells / 2,
+				static_cast<uint8_t>( ( code & 0x0F ) * 0x11 ) );
+			if( numberOfCells % 2 != 0 ) {
+				buffer[numberOfCells / 2] = static_cast<uint8_t>( code & 0x0F );
+			}
+			break;
+		case MBE_OneHot:
+			fill( buffer, buffer + MCC_NumberOfCodes * numberOfCells, 0 );
+			fill( buffer + plane( code ) * numberOfCells,
+				buffer + ( plane( code ) + 1 ) * numberOfCells, 1 );
+			break;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <Minesweeper.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// returns the code of the visible cell (TMinesweeperCellCode)
+inline int8_t CellCode( bool isOpened, bool isBomb, size_t numberOfNeighborBombs,
+	TMinesweeperCellLabel label )
+{
+	if( isOpened ) {
+		return static_cast<int8_t>( isBomb ? size_t( MCC_Bomb ) : numberOfNeighborBombs );
+	}
+	switch( label ) {
+		case MCL_Bomb:
+			return MCC_LabeledBomb;
+		case MCL_Question:
+			return MCC_LabeledQuestion;
+		default:
+			return MCC_Closed;
+	}
+}
+
+// Writer of the cells of an encoded board (TMinesweeperBoardEncoding)
+class CMinesweeperBoardEncoder {
+public:
+	// the buffer must have EncodedBoardSize( encoding, rows, columns ) bytes
+	CMinesweeperBoardEncoder( TMinesweeperBoardEncoding encoding, void* buffer,
+		size_t numberOfCells );
+
+	// writes the code of every cell
+	void Fill( int8_t code );
+	// writes the code of the cell i = ( row * columns + column )
+	void Set( size_t cell, int8_t code );
+
+private:
+	const TMinesweeperBoardEncoding encoding;
+	uint8_t* const buffer;
+	const size_t numberOfCells;
+
+	static size_t plane( int8_t code );
+};
+
+inline void CMinesweeperBoardEncoder::Set( size_t cell, int8_t code )
+{
+	switch( encoding ) {
+		case MBE_Codes:
+			buffer[cell] = static_cast<uint8_t>( code );
+			break;
+		case MBE_Nibbles:
+		{
+			const unsigned shift = static_cast<unsigned>( cell % 2 ) * 4;
+			uint8_t& byte = buffer[cell / 2];
+			byte = static_cast<uint8_t>( ( byte & ~( 0x0F << shift ) )
+				| ( ( code & 0x0F ) << shift ) );
+			break;
+		}
+		case MBE_OneHot:
+			for( size_t p = 0; p < MCC_NumberOfCodes; p++ ) {
+				buffer[p * numberOfCells + cell] = 0;
+			}
+			buffer[plane( code ) * numberOfCells + cell] = 1;
+			break;
+	}
+}
+
+inline size_t CMinesweeperBoardEncoder::plane( int8_t code )
+{
+	return code >= 0 ? static_cast<size_t>( code ) : MCC_NumberOfCodes - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,176 @@
+#include <MinesweeperEngine.h>
+#include <MinesweeperRandom.h>
+#include <MinesweeperBits.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CMinesweeperEngine::Reset( const CMinesweeperBoardView& board )
+{
+	floodFill.Reset( board );
+}
+
+void CMinesweeperEngine::Start( CMinesweeperBoardView& board, size_t bombs,
+	uint64_t seed )
+{
+	internal_check( bombs <= board.Size() );
+	start( board, bombs, seed );
+	plantBombs( board, nullptr, 0 );
+}
+
+void CMinesweeperEngine::Start( CMinesweeperBoardView& board, size_t bombs,
+	uint64_t seed, TMinesweeperFirstClick firstClick )
+{
+	internal_check( bombs <= board.Size() );
+	start( board, bombs, seed );
+	if( firstClick == MFC_Any ) {
+		plantBombs( board, nullptr, 0 );
+	} else {
+		board.SetPendingFirstClick( firstClick );
+	}
+}
+
+void CMinesweeperEngine::Start( CMinesweeperBoardView& board, const uint64_t* bombMask,
+	uint64_t seed )
+{
+	const size_t size = board.Size();
+	size_t bombs = 0;
+	for( size_t i = 0; i < ( size + 63 ) / 64; i++ ) {
+		bombs += PopulationCount( bombMask[i] );
+	}
+	internal_check( size % 64 == 0 || ( bombMask[size / 64] >> ( size % 64 ) ) == 0 );
+
+	start( board, bombs, seed );
+	bitboard.Reset( board.Rows(), board.Columns() );
+	size_t row = 0;
+	size_t column = 0;
+	for( size_t i = 0; i < size; i++ ) {
+		if( ( ( bombMask[i / 64] >> ( i % 64 ) ) & 1 ) != 0 ) {
+			board.SetIsBomb( board.Index( row, column ) );
+			bitboard.SetBomb( row, column );
+		}
+		if( ++column == board.Columns() ) {
+			column = 0;
+			row++;
+		}
+	}
+	storeNumberOfNeighborBombs( board );
+}
+
+// the free cells ( row * columns + column ) are in ascending order
+void CMinesweeperEngine::plantBombs( CMinesweeperBoardView& board,
+	const size_t* freeCells, size_t numberOfFreeCells )
+{
+	counters.Add( MC_PlantBombs, 1 );
+	CMinesweeperCounterTimer timer( counters, MC_PlantBombsNanoseconds );
+
+	const size_t columns = board.Columns();
+	bitboard.Reset( board.Rows(), columns );
+	SampleBombs( board.Size(), board.Bombs(), board.Seed(), freeCells, numberOfFreeCells,
+		[&board, columns]( size_t cell ) {
+			return board.IsBomb( board.Index( cell / columns, cell % columns ) );
+		},
+		[this, &board, columns]( size_t cell ) {
+			const size_t row = cell / columns;
+			const size_t column = cell % columns;
+			board.SetIsBomb( board.Index( row, column ) );
+			bitboard.SetBomb( row, column );
+		} );
+
+	board.SetPendingFirstClick( MFC_Any );
+	storeNumberOfNeighborBombs( board );
+}
+
+void CMinesweeperEngine::plantBombsAround( CMinesweeperBoardView& board, size_t index )
+{
+	size_t freeCells[MaxFirstClickFreeCells];
+	const size_t numberOfFreeCells = FirstClickFreeCells( board.Rows(), board.Columns(),
+		board.Bombs(), board.PendingFirstClick(), board.Row( index ), board.Column( index ),
+		freeCells );
+	plantBombs( board, freeCells, numberOfFreeCells );
+}
+
+// the neighbors are kept free only if there are enough other cells
+size_t CMinesweeperEngine::FirstClickFreeCells( size_t rows, size_t columns, size_t bombs,
+	TMinesweeperFirstClick firstClick, size_t row, size_t column, size_t* freeCells )
+{
+	size_t numberOfFreeCells = 0;
+	if( firstClick == MFC_Any ) {
+		return numberOfFreeCells;
+	}
+
+	if( firstClick == MFC_Opening ) {
+		for( size_t r = row > 0 ? row - 1 : 0; r <= row + 1 && r < rows; r++ ) {
+			for( size_t c = column > 0 ? column - 1 : 0; c <= column + 1 && c < columns; c++ ) {
+				freeCells[numberOfFreeCells++] = r * columns + c;
+			}
+		}
+	}
+	if( bombs + numberOfFreeCells > rows * columns ) {
+		numberOfFreeCells = 0;
+	}
+	if( numberOfFreeCells == 0 && bombs < rows * columns ) {
+		freeCells[numberOfFreeCells++] = row * columns + column;
+	}
+	return numberOfFreeCells;
+}
+
+void CMinesweeperEngine::MoveBomb( CMinesweeperBoardView& board, size_t from, size_t to )
+{
+	internal_check( board.IsBomb( from ) && !board.IsBomb( to ) );
+	board.ClearIsBomb( from );
+	board.SetIsBomb( to );
+
+	// the border cells have no numbers
+	const ptrdiff_t* const offsets = board.NeighborOffsets();
+	for( size_t i = 0; i < CMinesweeperBoardView::NumberOfNeighbors; i++ ) {
+		const size_t fromNeighbor = from + offsets[i];
+		if( board.Row( fromNeighbor ) < board.Rows()
+			&& board.Column( fromNeighbor ) < board.Columns() )
+		{
+			board.SetNumberOfNeighborBombs( fromNeighbor,
+				board.NumberOfNeighborBombs( fromNeighbor ) - 1 );
+		}
+		const size_t toNeighbor = to + offsets[i];
+		if( board.Row( toNeighbor ) < board.Rows()
+			&& board.Column( toNeighbor ) < board.Columns() )
+		{
+			board.SetNumberOfNeighborBombs( toNeighbor,
+				board.NumberOfNeighborBombs( toNeighbor ) + 1 );
+		}
+	}
+}
+
+void CMinesweeperEngine::start( CMinesweeperBoardView& board, size_t bombs,
+	uint64_t seed )
+{
+	board.Clear();
+	board.SetState( MGS_Active );
+	board.SetBombs( bombs );
+	board.SetSeed( seed );
+	board.SetNumberOfOpenedCells( 0 );
+	board.SetPendingFirstClick( MFC_Any );
+}
+
+void CMinesweeperEngine::storeNumberOfNeighborBombs( CMinesweeperBoardView& board )
+{
+	// all numbers of neighbor bombs are calculated at once
+	bitboard.CalculateNumberOfNeighborBombs();
+	bitboard.StoreNumberOfNeighborBombs( board );
+}
+
+void CMinesweeperEngine::checkSuccess( CMinesweeperBoardView& board )
+{
+	const size_t numberOfSafeCells = board.Size() - board.Bombs();
+	internal_check( board.NumberOfOpenedCells() <= numberOfSafeCells );
+	if( board.NumberOfOpenedCells() == numberOfSafeCells ) {
+		board.SetState( MGS_Success );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <MinesweeperBoard.h>
+#include <MinesweeperBitboard.h>
+#include <MinesweeperFloodFill.h>
+#include <MinesweeperRandom.h>
+#include <MinesweeperStatistics.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Observer which ignores modified cells
+struct CMinesweeperNullObserver {
+	void OnModified( size_t /* index */ ) {}
+	void OnModifiedMask( size_t /* word */, uint64_t /* mask */ ) {}
+	void OnCascadeBegin( size_t /* index */ ) {}
+	void OnCascadeEnd( size_t /* index */ ) {}
+};
+
+// The game rules over a board view
+// the engine keeps only the scratch buffers (bitboard and flood fill),
+// so one engine can play any number of boards of the same size one by one,
+// modified cells are reported to the observer by their board index,
+// OnModified( index ), or by whole words of 64 indices, OnModifiedMask( word,
+// mask ) for the indices ( 64 * word + i ) of the bits i of the mask,
+// the cells opened by a flood fill from a cell are reported between
+// OnCascadeBegin( index ) and OnCascadeEnd( index ) of the cell,
+// the rules are templates over the board type, so boards with compile time
+// geometry (MinesweeperFixedBoard.h) get constant strides and offsets
+class CMinesweeperEngine {
+public:
+	CMinesweeperEngine() {}
+	CMinesweeperEngine( const CMinesweeperEngine& ) = delete;
+	CMinesweeperEngine& operator=( const CMinesweeperEngine& ) = delete;
+
+	// prepares the buffers for boards of the size (allocates only if boards grow)
+	void Reset( const CMinesweeperBoardView& board );
+	// clears the board and plants the bombs from the seed
+	void Start( CMinesweeperBoardView& board, size_t bombs, uint64_t seed );
+	// the same, but unless MFC_Any the bombs are planted by the first open
+	// around the opened cell, so the start only clears the board
+	void Start( CMinesweeperBoardView& board, size_t bombs, uint64_t seed,
+		TMinesweeperFirstClick firstClick );
+	// clears the board and plants the bombs of the mask, a bit per cell
+	// i = ( row * columns + column ), the seed is only kept by the board
+	void Start( CMinesweeperBoardView& board, const uint64_t* bombMask, uint64_t seed );
+
+	// opens the cell like IMinesweeperCell::Open
+	template<typename TBoard, typename TObserver>
+	void Open( TBoard& board, size_t index, TObserver& observer );
+	// sets the label of the closed cell like IMinesweeperCell::SetLabel
+	template<typename TBoard, typename TObserver>
+	void SetLabel( TBoard& board, size_t index,
+		TMinesweeperCellLabel newLabel, TObserver& observer );
+	// closes all cells of the board, the bombs are kept
+	template<typename TBoard, typename TObserver>
+	void Restart( TBoard& board, TObserver& observer );
+
+	// the number kept by the board, labeled neighbors are closed while the board
+	// is active, since opens skip labeled cells
+	template<typename TBoard>
+	static size_t NumberOfNeighborCellsLabeledAsBombs( const TBoard& board, size_t index );
+	// whether opening the opened cell opens its neighbors: the numbers of its
+	// neighbor bombs and of its neighbors labeled as bombs match
+	// and some neighbor is closed and not labeled
+	template<typename TBoard>
+	static bool IsChordable( const TBoard& board, size_t index );
+	// moves the bomb to the cell without bomb, the numbers of neighbor bombs
+	// are updated, so the planted board is changed without planting again
+	static void MoveBomb( CMinesweeperBoardView& board, size_t from, size_t to );
+
+	// the planting of bombs for any bomb storage, the cells are numbered
+	// ( row * columns + column ), the same parameters give the same bombs
+	static const size_t MaxFirstClickFreeCells = 1 + CMinesweeperBoardView::NumberOfNeighbors;
+	// writes the cells kept free of bombs by the first click at the cell,
+	// in ascending order, returns their number (zero for MFC_Any)
+	static size_t FirstClickFreeCells( size_t rows, size_t columns, size_t bombs,
+		TMinesweeperFirstClick firstClick, size_t row, size_t column, size_t* freeCells );
+	// samples the bombs out of the cells which are not free,
+	// isBomb( cell ) returns whether the cell is already chosen,
+	// setBomb( cell ) is called once for every bomb
+	template<typename TIsBomb, typename TSetBomb>
+	static void SampleBombs( size_t size, size_t bombs, uint64_t seed,
+		const size_t* freeCells, size_t numberOfFreeCells, TIsBomb isBomb, TSetBomb setBomb );
+
+	// statistics of the boards played by the engine
+	CMinesweeperCounters& Counters() { return counters; }
+	const CMinesweeperCounters& Counters() const { return counters; }
+
+private:
+	CMinesweeperBitboard bitboard;
+	CMinesweeperFloodFill floodFill;
+	CMinesweeperCounters counters;
+
+	void start( CMinesweeperBoardView& board, size_t bombs, uint64_t seed );
+	void plantBombs( CMinesweeperBoardView& board, const size_t* freeCells,
+		size_t numberOfFreeCells );
+	void plantBombsAround( CMinesweeperBoardView& board, size_t index );
+	void storeNumberOfNeighborBombs( CMinesweeperBoardView& board );
+	template<typename TBoard, typename TObserver>
+	bool open( TBoard& board, size_t index, TObserver& observer );
+	template<typename TBoard, typename TObserver>
+	void openBombs( TBoard& board, TObserver& observer );
+	template<typename TBoard, typename TObserver>
+	void openNeighbors( TBoard& board, size_t index, TObserver& observer );
+	static void checkSuccess( CMinesweeperBoardView& board );
+};
+
+// OnOpen
+// I. The cell is not opened:
+//    1. The cell is bomb:
+//       Boom!
+//    2. The cell has N > 0 bombs in its neighbors:
+//       Just open the cell!
+//    3. The cell has no bombs in its neighbors:
+//       Open the cell and its neighbors (recursively)
+// II. The cell is already opened:
+//     2. Number of labeled neighbor bombs equal to number of neighbor bombs:
+//        Open neighbors
+
+template<typename TBoard, typename TObserver>
+void CMinesweeperEngine::Open( TBoard& board, size_t index, TObserver& observer )
+{
+	internal_check( board.State() == MGS_Active );
+	counters.Add( MC_Opens, 1 );
+	// opens of labeled cells do nothing, so they keep the first click pending
+	if( !board.IsOpened( index ) && board.Label( index ) != MCL_None ) {
+		return;
+	}
+	if( board.PendingFirstClick() != MFC_Any ) {
+		plantBombsAround( board, index );
+	}
+
+	if( board.IsOpened( index ) ) {
+		if( board.NumberOfNeighborBombs( index )
+			== NumberOfNeighborCellsLabeledAsBombs( board, index ) )
+		{
+			openNeighbors( board, index, observer );
+		}
+	} else if( open( board, index, observer ) ) {
+		if( board.NumberOfNeighborBombs( index ) == 0 ) {
+			openNeighbors( board, index, observer );
+		}
+	}
+
+	if( board.State() == MGS_Active ) {
+		checkSuccess( board );
+	}
+}
+
+template<typename TBoard, typename TObserver>
+void CMinesweeperEngine::SetLabel( TBoard& board, size_t index,
+	TMinesweeperCellLabel newLabel, TObserver& observer )
+{
+	internal_check( !board.IsOpened( index ) );
+	if( board.Label( index ) != newLabel ) {
+		internal_check( board.State() == MGS_Active );
+		// the numbers of neighbor labeled bombs are updated by a scan
+		if( ( board.Label( index ) == MCL_Bomb ) != ( newLabel == MCL_Bomb ) ) {
+			counters.Add( MC_NeighborScans, 1 );
+		}
+		board.SetLabel( index, newLabel );
+		observer.OnModified( index );
+	}
+}
+
+template<typename TBoard, typename TObserver>
+void CMinesweeperEngine::Restart( TBoard& board, TObserver& observer )
+{
+	// only opened or labeled cells are changed by the restart
+	const uint8_t* const isOpened = board.OpenedPlane();
+	const uint8_t* const labels = board.LabelPlane();
+	for( size_t row = 0; row < board.Rows(); row++ ) {
+		const size_t first = board.Index( row, 0 );
+		for( size_t index = first; index < first + board.Columns(); index++ ) {
+			if( ( isOpened[index] | labels[index] ) != 0 ) {
+				observer.OnModified( index );
+			}
+		}
+	}
+	board.Close();
+	board.SetState( MGS_Active );
+	board.SetNumberOfOpenedCells( 0 );
+}
+
+template<typename TBoard>
+size_t CMinesweeperEngine::NumberOfNeighborCellsLabeledAsBombs( const TBoard& board,
+	size_t index )
+{
+	return board.NumberOfNeighborLabeledBombs( index );
+}
+
+template<typename TBoard>
+bool CMinesweeperEngine::IsChordable( const TBoard& board, size_t index )
+{
+	if( !board.IsOpened( index ) || board.IsBomb( index )
+		|| board.NumberOfNeighborBombs( index ) != board.NumberOfNeighborLabeledBombs( index ) )
+	{
+		return false;
+	}
+	const ptrdiff_t* const offsets = board.NeighborOffsets();
+	for( size_t i = 0; i < CMinesweeperBoardView::NumberOfNeighbors; i++ ) {
+		const size_t neighbor = index + offsets[i];
+		if( !board.IsOpened( neighbor ) && board.Label( neighbor ) == MCL_None ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// the sample i is mapped to the cell i plus the number of the free cells up to that cell
+template<typename TIsBomb, typename TSetBomb>
+void CMinesweeperEngine::SampleBombs( size_t size, size_t bombs, uint64_t seed,
+	const size_t* freeCells, size_t numberOfFreeCells, TIsBomb isBomb, TSetBomb setBomb )
+{
+	internal_check( bombs + numberOfFreeCells <= size );
+	const auto cellOf = [freeCells, numberOfFreeCells]( size_t sample ) {
+		for( size_t i = 0; i < numberOfFreeCells && sample >= freeCells[i]; i++ ) {
+			sample++;
+		}
+		return sample;
+	};
+	CMinesweeperRandom random( seed );
+	SampleCells( random, size - numberOfFreeCells, bombs,
+		[&isBomb, &cellOf]( size_t sample ) { return isBomb( cellOf( sample ) ); },
+		[&setBomb, &cellOf]( size_t sample ) { setBomb( cellOf( sample ) ); } );
+}
+
+template<typename TBoard, typename TObserver>
+bool CMinesweeperEngine::open( TBoard& board, size_t index, TObserver& observer )
+{
+	if( !board.IsOpened( index ) && board.Label( index ) == MCL_None ) {
+		board.SetIsOpened( index );
+		observer.OnModified( index );
+
+		if( board.IsBomb( index ) ) {
+			openBombs( board, observer );
+			return false;
+		}
+
+		board.SetNumberOfOpenedCells( board.NumberOfOpenedCells() + 1 );
+	}
+	return true;
+}
+
+// the bombs are opened by words of the planes, so the failure costs
+// a pass over the planes and a report per 64 cells whatever the number of bombs
+template<typename TBoard, typename TObserver>
+void CMinesweeperEngine::openBombs( TBoard& board, TObserver& observer )
+{
+	board.OpenBombs( [&observer]( size_t word, uint64_t mask ) {
+		observer.OnModifiedMask( word, mask );
+	} );
+	board.SetState( MGS_Failure );
+}
+
+template<typename TBoard, typename TObserver>
+void CMinesweeperEngine::openNeighbors( TBoard& board, size_t index, TObserver& observer )
+{
+	const bool safe = floodFill.Fill( board, index );
+	counters.Add( MC_FloodFills, 1 );
+	counters.Add( MC_FloodFillIterations, floodFill.NumberOfVisited() );
+	counters.Add( MC_NeighborScans, floodFill.NumberOfScanned() );
+	counters.Add( MC_CascadeCells, floodFill.NumberOfOpened() );
+	counters.Max( MC_MaxCascadeCells, floodFill.NumberOfOpened() );
+
+	const size_t* const opened = floodFill.Opened();
+	observer.OnCascadeBegin( index );
+	for( size_t i = 0; i < floodFill.NumberOfOpened(); i++ ) {
+		observer.OnModified( opened[i] );
+	}
+	observer.OnCascadeEnd( index );
+
+	const size_t numberOfSafeOpened = floodFill.NumberOfOpened() - ( safe ? 0 : 1 );
+	board.SetNumberOfOpenedCells( board.NumberOfOpenedCells() + numberOfSafeOpened );
+	if( !safe ) {
+		openBombs( board, observer );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <limits>
+#include <MinesweeperEnvironment.h>
+#include <MinesweeperRandom.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperEnvironment::CMinesweeperEnvironment() :
+	rows( 0 ),
+	columns( 0 ),
+	bombs( 0 ),
+	numberOfLanes( 0 ),
+	numberOfGroups( 0 ),
+	seed( 0 ),
+	firstClick( MFC_Any ),
+	planeSize( 0 ),
+	numberOfSafeCells( 0 ),
+	cellIndices( nullptr )
+{
+}
+
+void CMinesweeperEnvironment::Reset( size_t _rows, size_t _columns, size_t _bombs,
+	size_t _numberOfLanes, uint64_t _seed, TMinesweeperFirstClick _firstClick )
+{
+	internal_check( _rows > 0 && _columns > 0 && _numberOfLanes > 0 );
+	internal_check( _rows + 2 <= numeric_limits<uint32_t>::max() / ( _columns + 2 ) );
+	internal_check( _bombs <= _rows * _columns );
+
+	rows = _rows;
+	columns = _columns;
+	bombs = _bombs;
+	numberOfLanes = _numberOfLanes;
+	numberOfGroups = ( numberOfLanes + LanesPerGroup - 1 ) / LanesPerGroup;
+	seed = _seed;
+	firstClick = _firstClick;
+	planeSize = CMinesweeperBoardView::PlaneSize( rows, columns );
+	numberOfSafeCells = rows * columns - bombs;
+
+	internal_check( numberOfGroups <= numeric_limits<size_t>::max()
+		/ P_NumberOfPlanes / planeSize );
+	planes.assign( numberOfGroups * P_NumberOfPlanes * planeSize, 0 );
+
+	geometry = CMinesweeperBoardGeometry::Get( rows, columns );
+	cellIndices = geometry->CellIndices();
+	const size_t stride = geometry->Stride();
+	// the border cells are opened in all lanes
+	for( size_t group = 0; group < numberOfGroups; group++ ) {
+		uint64_t* const opened = plane( group, P_Opened );
+		fill( opened, opened + stride, ~uint64_t( 0 ) );
+		fill( opened + planeSize - stride, opened + planeSize, ~uint64_t( 0 ) );
+		for( size_t index = stride; index < planeSize - stride; index += stride ) {
+			opened[index] = ~uint64_t( 0 );
+			opened[index + stride - 1] = ~uint64_t( 0 );
+		}
+	}
+
+	size_t bits = 1;
+	while( bits < 64 && ( ( rows * columns ) >> bits ) != 0 ) {
+		bits++;
+	}
+	openedCounters.assign( bits, 0 );
+
+	states.assign( numberOfLanes, MGS_Active );
+	pendingFirstClicks.assign( numberOfLanes, 0 );
+	numberOfOpenedCells.assign( numberOfLanes, 0 );
+	episodes.assign( numberOfLanes, 0 );
+	for( size_t lane = 0; lane < numberOfLanes; lane++ ) {
+		startLane( lane );
+	}
+	if( firstClick == MFC_Any ) {
+		for( size_t group = 0; group < numberOfGroups; group++ ) {
+			countNeighbors( group, ~uint64_t( 0 ) );
+		}
+	}
+}
+
+void CMinesweeperEnvironment::ResetDone()
+{
+	for( size_t group = 0; group < numberOfGroups; group++ ) {
+		const size_t firstLane = group * LanesPerGroup;
+		uint64_t lanes = 0;
+		for( size_t l = 0; l < LanesPerGroup && firstLane + l < numberOfLanes; l++ ) {
+			if( states[firstLane + l] != MGS_Active ) {
+				lanes |= uint64_t( 1 ) << l;
+			}
+		}
+		if( lanes == 0 ) {
+			continue;
+		}
+
+		clearLanes( group, lanes );
+		for( uint64_t bits = lanes; bits != 0; bits &= bits - 1 ) {
+			const size_t lane = firstLane + CountTrailingZeros( bits );
+			episodes[lane]++;
+			startLane( lane );
+		}
+		if( firstClick == MFC_Any ) {
+			countNeighbors( group, lanes );
+		}
+	}
+}
+
+void CMinesweeperEnvironment::Step( const uint32_t* actions, float* rewards,
+	uint8_t* done )
+{
+	for( size_t group = 0; group < numberOfGroups; group++ ) {
+		const size_t first = group * LanesPerGroup;
+		step( group, actions + first, rewards + first, done + first );
+	}
+}
+
+// the words of a cell are loaded once for all lanes of the group
+void CMinesweeperEnvironment::Observe( int8_t* observations ) const
+{
+	const size_t size = ObservationSize();
+	for( size_t group = 0; group < numberOfGroups; group++ ) {
+		const size_t firstLane = group * LanesPerGroup;
+		const size_t numberOfGroupLanes = numberOfLanes - firstLane < LanesPerGroup
+			? numberOfLanes - firstLane : LanesPerGroup;
+		const uint64_t* const bomb = plane( group, P_Bomb );
+		const uint64_t* const opened = plane( group, P_Opened );
+		const uint64_t* const count0 = plane( group, P_Count0 );
+		const uint64_t* const count1 = plane( group, P_Count1 );
+		const uint64_t* const count2 = plane( group, P_Count2 );
+		const uint64_t* const count3 = plane( group, P_Count3 );
+
+		int8_t* const groupObservations = observations + firstLane * size;
+		for( size_t cell = 0; cell < size; cell++ ) {
+			const size_t index = cellIndices[cell];
+			const uint64_t isOpened = opened[index];
+			const uint64_t isBomb = bomb[index];
+			const uint64_t digit0 = count0[index];
+			const uint64_t digit1 = count1[index];
+			const uint64_t digit2 = count2[index];
+			const uint64_t digit3 = count3[index];
+			int8_t* observation = groupObservations + cell;
+			for( size_t l = 0; l < numberOfGroupLanes; l++, observation += size ) {
+				int8_t code = MCC_Closed;
+				if( ( ( isOpened >> l ) & 1 ) != 0 ) {
+					if( ( ( isBomb >> l ) & 1 ) != 0 ) {
+						code = MCC_Bomb;
+					} else {
+						code = static_cast<int8_t>( ( ( digit0 >> l ) & 1 )
+							| ( ( ( digit1 >> l ) & 1 ) << 1 )
+							| ( ( ( digit2 >> l ) & 1 ) << 2 )
+							| ( ( ( digit3 >> l ) & 1 ) << 3 ) );
+					}
+				}
+				*observation = code;
+			}
+		}
+	}
+}
+
+uint64_t CMinesweeperEnvironment::laneSeed( size_t lane ) const
+{
+	return seed ^ MixSeed( episodes[lane] * numberOfLanes + lane );
+}
+
+// the lane must be cleared, the bombs are planted unless the first click
+// is pending, the numbers of neighbor bombs are left to countNeighbors
+void CMinesweeperEnvironment::startLane( size_t lane )
+{
+	states[lane] = MGS_Active;
+	numberOfOpenedCells[lane] = 0;
+	pendingFirstClicks[lane] = firstClick != MFC_Any ? 1 : 0;
+	if( firstClick == MFC_Any ) {
+		plantLane( lane, 0 );
+	}
+}
+
+// the bombs are sampled straight into the bits of the lane like the engine
+// plants them, so the lane gets the board of the game of the same seed
+void CMinesweeperEnvironment::plantLane( size_t lane, uint32_t firstAction )
+{
+	size_t freeCells[CMinesweeperEngine::MaxFirstClickFreeCells];
+	const size_t numberOfFreeCells = CMinesweeperEngine::FirstClickFreeCells(
+		rows, columns, bombs, firstClick, firstAction / columns, firstAction % columns,
+		freeCells );
+	pendingFirstClicks[lane] = 0;
+
+	const uint64_t bit = uint64_t( 1 ) << ( lane % LanesPerGroup );
+	uint64_t* const bomb = plane( lane / LanesPerGroup, P_Bomb );
+	const uint32_t* const indices = cellIndices;
+	CMinesweeperEngine::SampleBombs( rows * columns, bombs, laneSeed( lane ),
+		freeCells, numberOfFreeCells,
+		[bomb, bit, indices]( size_t cell ) { return ( bomb[indices[cell]] & bit ) != 0; },
+		[bomb, bit, indices]( size_t cell ) { bomb[indices[cell]] |= bit; } );
+}
+
+// clears all cells of the lanes of the group except the border
+void CMinesweeperEnvironment::clearLanes( size_t group, uint64_t lanes )
+{
+	const size_t stride = columns + 2;
+	for( size_t kind = 0; kind < P_NumberOfPlanes; kind++ ) {
+		uint64_t* const words = plane( group, static_cast<TPlane>( kind ) );
+		for( size_t row = 0; row < rows; row++ ) {
+			const size_t first = ( row + 1 ) * stride + 1;
+			for( size_t index = first; index < first + columns; index++ ) {
+				words[index] &= ~lanes;
+			}
+		}
+	}
+}
+
+// calculates the numbers of neighbor bombs of the lanes of the group
+// by bit-sliced adders over the bomb words like the bitboard does,
+// so all lanes planted at once are counted in one pass: the number of
+// the cell is the 2-bit sum of the column on its left, the 2-bit sum of
+// the cells above and below it and the 2-bit sum of the column on its right
+void CMinesweeperEnvironment::countNeighbors( size_t group, uint64_t lanes )
+{
+	const size_t stride = columns + 2;
+	const uint64_t* const bomb = plane( group, P_Bomb );
+	uint64_t* const zero = plane( group, P_Zero );
+	uint64_t* const count0 = plane( group, P_Count0 );
+	uint64_t* const count1 = plane( group, P_Count1 );
+	uint64_t* const count2 = plane( group, P_Count2 );
+	uint64_t* const count3 = plane( group, P_Count3 );
+
+	for( size_t row = 0; row < rows; row++ ) {
+		const size_t first = ( row + 1 ) * stride + 1;
+		// sums of the columns, the border column has no bombs
+		uint64_t left0 = 0;
+		uint64_t left1 = 0;
+		uint64_t up = bomb[first - stride];
+		uint64_t middle = bomb[first];
+		uint64_t down = bomb[first + stride];
+		for( size_t index = first; index < first + columns; index++ ) {
+			const uint64_t nextUp = bomb[index + 1 - stride];
+			const uint64_t nextMiddle = bomb[index + 1];
+			const uint64_t nextDown = bomb[index + 1 + stride];
+			const uint64_t right0 = nextUp ^ nextMiddle ^ nextDown;
+			const uint64_t right1 = ( nextUp & nextMiddle ) | ( nextDown & ( nextUp ^ nextMiddle ) );
+
+			// left + right
+			const uint64_t sides0 = left0 ^ right0;
+			const uint64_t carry0 = left0 & right0;
+			const uint64_t sides1 = left1 ^ right1 ^ carry0;
+			const uint64_t sides2 = ( left1 & right1 ) | ( carry0 & ( left1 ^ right1 ) );
+			// + up + down
+			const uint64_t center0 = up ^ down;
+			const uint64_t center1 = up & down;
+			const uint64_t digit0 = sides0 ^ center0;
+			const uint64_t carry1 = sides0 & center0;
+			const uint64_t digit1 = sides1 ^ center1 ^ carry1;
+			const uint64_t carry2 = ( sides1 & center1 ) | ( carry1 & ( sides1 ^ center1 ) );
+			const uint64_t digit2 = sides2 ^ carry2;
+			const uint64_t digit3 = sides2 & carry2;
+
+			const uint64_t hasNeighborBombs = digit0 | digit1 | digit2 | digit3;
+			zero[index] = ( zero[index] & ~lanes ) | ( ~hasNeighborBombs & ~middle & lanes );
+			count0[index] = ( count0[index] & ~lanes ) | ( digit0 & lanes );
+			count1[index] = ( count1[index] & ~lanes ) | ( digit1 & lanes );
+			count2[index] = ( count2[index] & ~lanes ) | ( digit2 & lanes );
+			count3[index] = ( count3[index] & ~lanes ) | ( digit3 & lanes );
+
+			left0 = up ^ middle ^ down;
+			left1 = ( up & middle ) | ( down & ( up ^ middle ) );
+			up = nextUp;
+			middle = nextMiddle;
+			down = nextDown;
+		}
+	}
+}
+
+void CMinesweeperEnvironment::step( size_t group, const uint32_t* actions,
+	float* rewards, uint8_t* done )
+{
+	const size_t firstLane = group * LanesPerGroup;
+	const size_t numberOfGroupLanes = numberOfLanes - firstLane < LanesPerGroup
+		? numberOfLanes - firstLane : LanesPerGroup;
+	uint64_t* const bomb = plane( group, P_Bomb );
+	uint64_t* const opened = plane( group, P_Opened );
+	const uint64_t* const zero = plane( group, P_Zero );
+
+	// the lanes of the pending first clicks are planted around the actions
+	uint64_t planted = 0;
+	for( size_t l = 0; l < numberOfGroupLanes; l++ ) {
+		const size_t lane = firstLane + l;
+		if( states[lane] != MGS_Active ) {
+			continue;
+		}
+		internal_check( actions[l] < rows * columns );
+		if( pendingFirstClicks[lane] != 0 ) {
+			plantLane( lane, actions[l] );
+			planted |= uint64_t( 1 ) << l;
+		}
+	}
+	if( planted != 0 ) {
+		countNeighbors( group, planted );
+	}
+
+	// the opens of the actions, one cell per lane
+	uint32_t numberOfOpenedBefore[LanesPerGroup];
+	uint64_t active = 0;
+	uint64_t cascading = 0;
+	uint64_t lost = 0;
+	for( size_t l = 0; l < numberOfGroupLanes; l++ ) {
+		const size_t lane = firstLane + l;
+		numberOfOpenedBefore[l] = numberOfOpenedCells[lane];
+		if( states[lane] != MGS_Active ) {
+			continue;
+		}
+		const uint64_t bit = uint64_t( 1 ) << l;
+		active |= bit;
+
+		const size_t index = cellIndices[actions[l]];
+		if( ( opened[index] & bit ) != 0 ) {
+			continue;
+		}
+		opened[index] |= bit;
+		if( ( bomb[index] & bit ) != 0 ) {
+			lost |= bit;
+		} else {
+			numberOfOpenedCells[lane]++;
+			cascading |= zero[index] & bit;
+		}
+	}
+
+	if( cascading != 0 ) {
+		fill( openedCounters.begin(), openedCounters.end(), 0 );
+		cascade( group, cascading );
+		for( size_t l = 0; l < numberOfGroupLanes; l++ ) {
+			if( ( ( cascading >> l ) & 1 ) != 0 ) {
+				uint32_t count = 0;
+				for( size_t digit = 0; digit < openedCounters.size(); digit++ ) {
+					count |= static_cast<uint32_t>( ( openedCounters[digit] >> l ) & 1 ) << digit;
+				}
+				numberOfOpenedCells[firstLane + l] += count;
+			}
+		}
+	}
+
+	// all bombs of the lost lanes are opened at once
+	if( lost != 0 ) {
+		for( size_t index = 0; index < planeSize; index++ ) {
+			opened[index] |= bomb[index] & lost;
+		}
+	}
+
+	for( size_t l = 0; l < numberOfGroupLanes; l++ ) {
+		const size_t lane = firstLane + l;
+		rewards[l] = 0;
+		if( ( ( active >> l ) & 1 ) == 0 ) {
+			done[l] = 1;
+			continue;
+		}
+		if( ( ( lost >> l ) & 1 ) != 0 ) {
+			states[lane] = MGS_Failure;
+			rewards[l] = -1;
+		} else {
+			const uint32_t numberOfOpened = numberOfOpenedCells[lane] - numberOfOpenedBefore[l];
+			if( numberOfOpened > 0 ) {
+				rewards[l] = static_cast<float>( numberOfOpened )
+					/ static_cast<float>( numberOfSafeCells );
+			}
+			if( numberOfOpenedCells[lane] == numberOfSafeCells ) {
+				states[lane] = MGS_Success;
+			}
+		}
+		done[l] = states[lane] != MGS_Active ? 1 : 0;
+	}
+}
+
+// the opened cells of the lanes are closed under the cascade before the step,
+// so the dilation only grows the cascades of the step, the sweeps update
+// the cells in place row by row forward and backward, so a sweep carries
+// the cascade along the whole board and few sweeps are needed,
+// a cell is opened if any cell of its 3x3 block is opened without
+// neighbor bombs, the blocks are unions of the columns of three cells
+void CMinesweeperEnvironment::cascade( size_t group, uint64_t lanes )
+{
+	const size_t stride = columns + 2;
+	uint64_t* const opened = plane( group, P_Opened );
+	const uint64_t* const zero = plane( group, P_Zero );
+	const auto column = [opened, zero, stride]( size_t index ) {
+		return ( opened[index - stride] & zero[index - stride] )
+			| ( opened[index] & zero[index] )
+			| ( opened[index + stride] & zero[index + stride] );
+	};
+	// sweeps the row from the cell in the direction, the border columns
+	// have no cells without neighbor bombs
+	const auto sweep = [this, opened, zero, lanes, &column]( size_t index, ptrdiff_t direction ) {
+		uint64_t changed = 0;
+		uint64_t previous = 0;
+		uint64_t current = column( index );
+		for( size_t i = 0; i < columns; i++ ) {
+			const uint64_t next = column( index + direction );
+			const uint64_t added = ( previous | current | next ) & lanes & ~opened[index];
+			if( added != 0 ) {
+				opened[index] |= added;
+				current |= added & zero[index];
+				changed |= added;
+				countOpened( added );
+			}
+			previous = current;
+			current = next;
+			index += direction;
+		}
+		return changed;
+	};
+
+	for( ;; ) {
+		uint64_t changed = 0;
+		for( size_t row = 0; row < rows; row++ ) {
+			changed |= sweep( ( row + 1 ) * stride + 1, 1 );
+		}
+		if( changed == 0 ) {
+			break;
+		}
+		changed = 0;
+		for( size_t row = rows; row > 0; row-- ) {
+			changed |= sweep( row * stride + columns, -1 );
+		}
+		if( changed == 0 ) {
+			break;
+		}
+	}
+}
+
+// adds the bits of the word to the bit-sliced counters of the lanes
+void CMinesweeperEnvironment::countOpened( uint64_t opened )
+{
+	for( size_t digit = 0; digit < openedCounters.size() && opened != 0; digit++ ) {
+		const uint64_t carry = openedCounters[digit] & opened;
+		openedCounters[digit] ^= opened;
+		opened = carry;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <Minesweeper.h>
+#include <MinesweeperBoard.h>
+#include <MinesweeperEngine.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Batched environment which plays many boards of the same configuration
+// in lockstep, one open per board per step
+// the boards are lanes of groups of 64 lanes, every plane of a group keeps
+// one 64-bit word per cell with the bit l for the lane l of the group
+// (lane interleaved layout over the padded flat board indices,
+// MinesweeperBoard.h), so the opens of all lanes of a group are played
+// by word operations: the cascades are an iterated dilation of the opened
+// cells without neighbor bombs masked by the cascading lanes and the
+// bombs of the lost lanes are opened by one pass over the planes,
+// the bombs are sampled like the engine plants them, the numbers of neighbor
+// bombs of all lanes planted at once are counted by bit-sliced adders,
+// the episode e of the lane l is planted from the seed
+// ( seed ^ MixSeed( e * NumberOfLanes() + l ) ), so the lanes get the boards
+// of the games of the same seeds and first clicks
+// note: the environment is single threaded, different environments
+// can be stepped by different threads
+class CMinesweeperEnvironment {
+public:
+	static const size_t LanesPerGroup = 64;
+
+	CMinesweeperEnvironment();
+	CMinesweeperEnvironment( const CMinesweeperEnvironment& ) = delete;
+	CMinesweeperEnvironment& operator=( const CMinesweeperEnvironment& ) = delete;
+
+	// starts the first episodes of all lanes (throw an exception if failed)
+	// (allocates only if the environment grows)
+	void Reset( size_t rows, size_t columns, size_t bombs, size_t numberOfLanes,
+		uint64_t seed, TMinesweeperFirstClick firstClick = MFC_Opening );
+	// starts the next episodes of the lanes which are done
+	void ResetDone();
+
+	size_t Rows() const { return rows; }
+	size_t Columns() const { return columns; }
+	size_t Bombs() const { return bombs; }
+	size_t NumberOfLanes() const { return numberOfLanes; }
+	// number of values of the observation of a lane
+	size_t ObservationSize() const { return rows * columns; }
+
+	TMinesweeperGameState State( size_t lane ) const;
+	size_t NumberOfOpenedCells( size_t lane ) const;
+	uint64_t Seed( size_t lane ) const;
+
+	// opens the cell actions[l] = ( row * columns + column ) in every lane l,
+	// rewards[l] is the part of the safe cells of the board opened by
+	// the step (so a won episode is rewarded 1 in total) or -1 for
+	// a lost episode, done[l] is 1 once the episode is won or lost,
+	// the lanes which are done are kept as they are with zero rewards,
+	// opens of opened cells change nothing (the environment has no labels)
+	// (throw an exception if an action is out of the board)
+	void Step( const uint32_t* actions, float* rewards, uint8_t* done );
+
+	// writes the observations of all lanes one after another,
+	// observations[l * ObservationSize() + row * columns + column]
+	// is the code of the cell of the lane l (TMinesweeperCellCode, never labeled)
+	void Observe( int8_t* observations ) const;
+
+private:
+	enum TPlane {
+		P_Bomb,
+		P_Opened,
+		// safe cells without neighbor bombs
+		P_Zero,
+		// binary digits of the numbers of neighbor bombs
+		P_Count0,
+		P_Count1,
+		P_Count2,
+		P_Count3,
+		P_NumberOfPlanes
+	};
+
+	size_t rows;
+	size_t columns;
+	size_t bombs;
+	size_t numberOfLanes;
+	size_t numberOfGroups;
+	uint64_t seed;
+	TMinesweeperFirstClick firstClick;
+	size_t planeSize;
+	size_t numberOfSafeCells;
+	vector<uint64_t> planes;
+	// the layout of the planes shared with the boards of the shape
+	shared_ptr<const CMinesweeperBoardGeometry> geometry;
+	// plane indices of the cells ( row * columns + column )
+	const uint32_t* cellIndices;
+	// per lane state of the episodes
+	vector<uint8_t> states;
+	vector<uint8_t> pendingFirstClicks;
+	vector<uint32_t> numberOfOpenedCells;
+	vector<uint64_t> episodes;
+	// bit-sliced per lane counters of the cells opened by a step
+	vector<uint64_t> openedCounters;
+
+	uint64_t* plane( size_t group, TPlane kind );
+	const uint64_t* plane( size_t group, TPlane kind ) const;
+	uint64_t laneSeed( size_t lane ) const;
+	void startLane( size_t lane );
+	void plantLane( size_t lane, uint32_t firstAction );
+	void clearLanes( size_t group, uint64_t lanes );
+	void countNeighbors( size_t group, uint64_t lanes );
+	void step( size_t group, const uint32_t* actions, float* rewards, uint8_t* done );
+	void cascade( size_t group, uint64_t lanes );
+	void countOpened( uint64_t opened );
+};
+
+inline TMinesweeperGameState CMinesweeperEnvironment::State( size_t lane ) const
+{
+	internal_check( lane < numberOfLanes );
+	return static_cast<TMinesweeperGameState>( states[lane] );
+}
+
+inline size_t CMinesweeperEnvironment::NumberOfOpenedCells( size_t lane ) const
+{
+	internal_check( lane < numberOfLanes );
+	return numberOfOpenedCells[lane];
+}
+
+inline uint64_t CMinesweeperEnvironment::Seed( size_t lane ) const
+{
+	internal_check( lane < numberOfLanes );
+	return laneSeed( lane );
+}
+
+inline uint64_t* CMinesweeperEnvironment::plane( size_t group, TPlane kind )
+{
+	return planes.data() + ( group * P_NumberOfPlanes + kind ) * planeSize;
+}
+
+inline const uint64_t* CMinesweeperEnvironment::plane( size_t group, TPlane kind ) const
+{
+	return planes.data() + ( group * P_NumberOfPlanes + kind ) * planeSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,47 @@
+#include <MinesweeperEvents.h>
+#include <MinesweeperCommon.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperEventRing::CMinesweeperEventRing() :
+	sink( nullptr ),
+	mask( 0 ),
+	head( 0 ),
+	tail( 0 )
+{
+}
+
+void CMinesweeperEventRing::Reset( IMinesweeperEventSink* newSink, size_t capacity )
+{
+	internal_check( newSink == nullptr || capacity > 0 );
+	size_t size = 1;
+	while( size < capacity ) {
+		size <<= 1;
+	}
+	sink = newSink;
+	if( sink != nullptr ) {
+		events.resize( size );
+		mask = size - 1;
+	}
+	head = 0;
+	tail = 0;
+}
+
+void CMinesweeperEventRing::Flush()
+{
+	while( tail != head ) {
+		const size_t first = static_cast<size_t>( tail ) & mask;
+		const size_t pending = Size();
+		const size_t run = pending < events.size() - first ? pending : events.size() - first;
+		tail += run;
+		sink->OnEvents( events.data() + first, run );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
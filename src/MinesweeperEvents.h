@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <Minesweeper.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The kind of a game event
+enum TMinesweeperEventType {
+	// a new game of Row rows and Column columns, all cells are closed,
+	// the game is active (a restored game reports its cells and its state next)
+	MET_NewGame,
+	// the game is restarted, all cells are closed, the game is active
+	MET_Restart,
+	// the cell is opened, Code is its number of neighbor bombs or MCC_Bomb
+	MET_Opened,
+	// the label of the closed cell is changed, Code is MCC_LabeledBomb,
+	// MCC_LabeledQuestion or MCC_Closed for no label
+	MET_Labeled,
+	// the state of the game is changed, Code is the new TMinesweeperGameState
+	MET_StateChanged,
+	// the cells opened by the cascade from the cell are reported between
+	// the begin and the end of the cascade, the bombs opened by the failure
+	// of a cascade may be reported after its end
+	MET_CascadeBegin,
+	MET_CascadeEnd,
+	// the last move is undone, the cells changed back are reported next,
+	// the closed cells by MET_Labeled, and the state if it is changed back
+	MET_Undo
+};
+
+struct CMinesweeperEvent {
+	uint8_t Type; // TMinesweeperEventType
+	int8_t Code; // TMinesweeperCellCode or TMinesweeperGameState
+	size_t Row;
+	size_t Column;
+};
+
+// Receiver of the events of a game
+class IMinesweeperEventSink {
+public:
+	// destructor
+	virtual ~IMinesweeperEventSink() {}
+
+	// receives the next batch of events in order, the events are valid
+	// only during the call, the game must not be changed by the sink
+	// note: a full ring is flushed in the middle of a move, so the sink
+	// must not throw
+	virtual void OnEvents( const CMinesweeperEvent* events, size_t numberOfEvents ) = 0;
+};
+
+// Fixed capacity ring of the events of a game
+// the game pushes the events of a move and flushes them to the sink
+// once the move is done, a full ring is flushed by the push, so a move
+// of any size is delivered without allocations in batches of at most
+// the capacity, the events of a flush are passed as at most two runs
+// of the ring (the second one when the events wrap around)
+class CMinesweeperEventRing {
+public:
+	CMinesweeperEventRing();
+	CMinesweeperEventRing( const CMinesweeperEventRing& ) = delete;
+	CMinesweeperEventRing& operator=( const CMinesweeperEventRing& ) = delete;
+
+	// sets the sink and the capacity rounded up to a power of two,
+	// the pending events are dropped, nullptr stops the events
+	// (allocates only if the ring grows)
+	void Reset( IMinesweeperEventSink* sink, size_t capacity );
+
+	bool IsEnabled() const { return sink != nullptr; }
+	size_t Capacity() const { return events.size(); }
+	// number of events not flushed yet
+	size_t Size() const { return static_cast<size_t>( head - tail ); }
+
+	// the pushes are ignored without a sink
+	void Push( TMinesweeperEventType type, int8_t code, size_t row, size_t column );
+	// passes the pending events to the sink
+	void Flush();
+
+private:
+	IMinesweeperEventSink* sink;
+	vector<CMinesweeperEvent> events;
+	size_t mask;
+	// positions of the next pushed event and of the first pending one
+	uint64_t head;
+	uint64_t tail;
+};
+
+inline void CMinesweeperEventRing::Push( TMinesweeperEventType type, int8_t code,
+	size_t row, size_t column )
+{
+	if( sink == nullptr ) {
+		return;
+	}
+	if( Size() == events.size() ) {
+		Flush();
+	}
+	CMinesweeperEvent& event = events[static_cast<size_t>( head ) & mask];
+	event.Type = static_cast<uint8_t>( type );
+	event.Code = code;
+	event.Row = row;
+	event.Column = column;
+	head++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
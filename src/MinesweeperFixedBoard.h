@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <MinesweeperBoard.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Flat board of compile time dimensions
+// the planes live in the board itself, the geometry methods of the view
+// are hidden by constant ones, so the engine templates instantiated for
+// the board get constant strides and neighbor offsets and their neighbor
+// loops can be fully unrolled
+template<size_t BoardRows, size_t BoardColumns>
+class CMinesweeperFixedBoard : public CMinesweeperBoardView {
+public:
+	static const size_t FixedStride = BoardColumns + 2;
+	static const size_t FixedPlaneSize = ( BoardRows + 2 ) * FixedStride;
+
+	CMinesweeperFixedBoard();
+	CMinesweeperFixedBoard( const CMinesweeperFixedBoard& ) = delete;
+	CMinesweeperFixedBoard& operator=( const CMinesweeperFixedBoard& ) = delete;
+
+	// the board is able to keep only its own dimensions
+	static bool Fits( size_t rows, size_t columns );
+	// clears all planes (throw an exception if the dimensions do not fit)
+	void Reset( size_t rows, size_t columns );
+
+	// takes the play state and copies the planes of the other board,
+	// the planes live in the board, so they are never shared
+	void Share( const CMinesweeperFixedBoard& other );
+	void Unshare() {}
+	void UnshareMovePlanes() {}
+	void Release() {}
+	bool SharesPlanes( const CMinesweeperFixedBoard& ) const { return false; }
+
+	static size_t Rows() { return BoardRows; }
+	static size_t Columns() { return BoardColumns; }
+	static size_t Size() { return BoardRows * BoardColumns; }
+	static size_t Stride() { return FixedStride; }
+	static size_t PlaneSize() { return FixedPlaneSize; }
+
+	static size_t Index( size_t row, size_t column ) { return ( row + 1 ) * FixedStride + column + 1; }
+	static size_t Row( size_t index ) { return index / FixedStride - 1; }
+	static size_t Column( size_t index ) { return index % FixedStride - 1; }
+	static const ptrdiff_t* NeighborOffsets() { return neighborOffsets; }
+
+private:
+	static const ptrdiff_t neighborOffsets[NumberOfNeighbors];
+	array<uint8_t, NumberOfPlanes * FixedPlaneSize> planes;
+};
+
+template<size_t BoardRows, size_t BoardColumns>
+const ptrdiff_t CMinesweeperFixedBoard<BoardRows, BoardColumns>::neighborOffsets[NumberOfNeighbors] = {
+	-static_cast<ptrdiff_t>( FixedStride ) - 1,
+	-static_cast<ptrdiff_t>( FixedStride ),
+	-static_cast<ptrdiff_t>( FixedStride ) + 1,
+	-1, 1,
+	static_cast<ptrdiff_t>( FixedStride ) - 1,
+	static_cast<ptrdiff_t>( FixedStride ),
+	static_cast<ptrdiff_t>( FixedStride ) + 1
+};
+
+template<size_t BoardRows, size_t BoardColumns>
+CMinesweeperFixedBoard<BoardRows, BoardColumns>::CMinesweeperFixedBoard()
+{
+	Attach( planes.data(), BoardRows, BoardColumns );
+	Clear();
+}
+
+template<size_t BoardRows, size_t BoardColumns>
+inline bool CMinesweeperFixedBoard<BoardRows, BoardColumns>::Fits( size_t rows,
+	size_t columns )
+{
+	return rows == BoardRows && columns == BoardColumns;
+}
+
+template<size_t BoardRows, size_t BoardColumns>
+void CMinesweeperFixedBoard<BoardRows, BoardColumns>::Reset( size_t rows, size_t columns )
+{
+	internal_check( Fits( rows, columns ) );
+	Clear();
+}
+
+template<size_t BoardRows, size_t BoardColumns>
+void CMinesweeperFixedBoard<BoardRows, BoardColumns>::Share( const CMinesweeperFixedBoard& other )
+{
+	CMinesweeperBoardView::operator=( other );
+	planes = other.planes;
+	Attach( planes.data(), BoardRows, BoardColumns );
+}
+
+// the standard difficulties
+typedef CMinesweeperFixedBoard<9, 9> CMinesweeperBeginnerBoard;
+typedef CMinesweeperFixedBoard<16, 16> CMinesweeperIntermediateBoard;
+typedef CMinesweeperFixedBoard<16, 30> CMinesweeperExpertBoard;
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
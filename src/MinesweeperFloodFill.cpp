@@ -0,0 +1,37 @@
+#include <MinesweeperFloodFill.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperFloodFill::CMinesweeperFloodFill() :
+	numberOfQueued( 0 ),
+	numberOfOpened( 0 ),
+	numberOfScanned( 0 )
+{
+}
+
+void CMinesweeperFloodFill::Reset( const CMinesweeperBoardView& board )
+{
+	// every cell is queued at most once
+	if( queue.size() < board.PlaneSize() ) {
+		queue.resize( board.PlaneSize() );
+		opened.resize( board.PlaneSize() );
+	}
+	visited.assign( ( board.PlaneSize() + 63 ) / 64, 0 );
+	numberOfQueued = 0;
+	numberOfOpened = 0;
+}
+
+void CMinesweeperFloodFill::clearVisited()
+{
+	for( size_t i = 0; i < numberOfQueued; i++ ) {
+		visited[queue[i] / 64] = 0;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
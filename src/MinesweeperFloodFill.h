@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <MinesweeperCommon.h>
+#include <MinesweeperBoard.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Allocation free flood fill over the board
+// the queue and the visited bitset are sized to the board once
+// and are reused by every fill, the sentinel border of the board
+// stops the fill without edge checks
+class CMinesweeperFloodFill {
+public:
+	CMinesweeperFloodFill();
+	CMinesweeperFloodFill( const CMinesweeperFloodFill& ) = delete;
+	CMinesweeperFloodFill& operator=( const CMinesweeperFloodFill& ) = delete;
+
+	// prepares the buffers for the board (allocates only if the board grows),
+	// also done by the first fill of a board which does not fit the buffers
+	void Reset( const CMinesweeperBoardView& board );
+
+	// opens closed not labeled neighbors of the cell and recursively
+	// neighbors of each reached cell without neighbor bombs
+	// stops right after a bomb is opened and returns false in that case
+	template<typename TBoard>
+	bool Fill( TBoard& board, size_t index );
+
+	// cells opened by the last fill in the order of opening
+	// (the last one is the bomb if the fill failed)
+	const size_t* Opened() const { return opened.data(); }
+	size_t NumberOfOpened() const { return numberOfOpened; }
+	// cells queued by the last fill, their neighbors are scanned unless
+	// the fill stops at a bomb first
+	size_t NumberOfVisited() const { return numberOfQueued; }
+	// cells which neighbors were scanned by the last fill
+	// (the scan of the last one is cut short if the fill failed)
+	size_t NumberOfScanned() const { return numberOfScanned; }
+
+private:
+	vector<size_t> queue;
+	vector<size_t> opened;
+	vector<uint64_t> visited;
+	size_t numberOfQueued;
+	size_t numberOfOpened;
+	size_t numberOfScanned;
+
+	bool isVisited( size_t index ) const;
+	void visit( size_t index );
+	void clearVisited();
+};
+
+template<typename TBoard>
+bool CMinesweeperFloodFill::Fill( TBoard& board, size_t index )
+{
+	internal_check( index < board.PlaneSize() );
+	// the buffers which are not prepared for the board are prepared
+	// by the first fill, so a forked game needs no reset of its engine
+	if( queue.size() < board.PlaneSize() || visited.size() < ( board.PlaneSize() + 63 ) / 64 ) {
+		Reset( board );
+	}
+
+	const ptrdiff_t* const offsets = board.NeighborOffsets();
+	numberOfQueued = 0;
+	numberOfOpened = 0;
+	visit( index );
+
+	bool safe = true;
+	for( numberOfScanned = 0; numberOfScanned < numberOfQueued && safe; numberOfScanned++ ) {
+		const size_t current = queue[numberOfScanned];
+		for( size_t i = 0; i < CMinesweeperBoardView::NumberOfNeighbors; i++ ) {
+			const size_t neighbor = current + offsets[i];
+			if( board.IsOpened( neighbor ) || isVisited( neighbor ) ) {
+				continue;
+			}
+			if( board.Label( neighbor ) == MCL_None ) {
+				board.SetIsOpened( neighbor );
+				opened[numberOfOpened++] = neighbor;
+				if( board.IsBomb( neighbor ) ) {
+					safe = false;
+					break;
+				}
+			}
+			// labeled cells are not opened but are passed through as before
+			if( board.NumberOfNeighborBombs( neighbor ) == 0 ) {
+				visit( neighbor );
+			}
+		}
+	}
+
+	clearVisited();
+	return safe;
+}
+
+inline bool CMinesweeperFloodFill::isVisited( size_t index ) const
+{
+	return ( visited[index / 64] & ( uint64_t( 1 ) << ( index % 64 ) ) ) != 0;
+}
+
+inline void CMinesweeperFloodFill::visit( size_t index )
+{
+	visited[index / 64] |= uint64_t( 1 ) << ( index % 64 );
+	queue[numberOfQueued++] = index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
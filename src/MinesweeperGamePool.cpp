@@ -0,0 +1,241 @@
+#include <MinesweeperGamePool.h>
+#include <MinesweeperCommon.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// the free lists never grow while a game or a block is returned,
+// their capacity is reserved when the games are created,
+// the control blocks are all of the same type, so of the same size
+struct CMinesweeperGamePool::CState {
+	const CMinesweeperSizePolicy Policy;
+	mutable mutex Lock;
+	size_t NumberOfGames;
+	// free flat and tiled games
+	vector<shared_ptr<IMinesweeperGame>> FreeGames[2];
+	size_t BlockSize;
+	vector<void*> FreeBlocks;
+
+	explicit CState( const CMinesweeperSizePolicy& policy );
+	~CState();
+
+	void* Allocate( size_t size );
+	void Deallocate( void* block, size_t size );
+};
+
+CMinesweeperGamePool::CState::CState( const CMinesweeperSizePolicy& policy ) :
+	Policy( policy ),
+	NumberOfGames( 0 ),
+	BlockSize( 0 )
+{
+}
+
+CMinesweeperGamePool::CState::~CState()
+{
+	for( auto i = FreeBlocks.cbegin(); i != FreeBlocks.cend(); ++i ) {
+		::operator delete( *i );
+	}
+}
+
+void* CMinesweeperGamePool::CState::Allocate( size_t size )
+{
+	{
+		lock_guard<mutex> lock( Lock );
+		if( BlockSize == 0 ) {
+			BlockSize = size;
+		}
+		if( size == BlockSize && !FreeBlocks.empty() ) {
+			void* const block = FreeBlocks.back();
+			FreeBlocks.pop_back();
+			return block;
+		}
+	}
+	return ::operator new( size );
+}
+
+void CMinesweeperGamePool::CState::Deallocate( void* block, size_t size )
+{
+	{
+		lock_guard<mutex> lock( Lock );
+		if( size == BlockSize && FreeBlocks.size() < FreeBlocks.capacity() ) {
+			FreeBlocks.push_back( block );
+			return;
+		}
+	}
+	::operator delete( block );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Allocator of the control blocks of the handed out games
+// it shares the state, since the control block is deallocated after
+// its deleter has dropped the state
+template<typename T>
+class CMinesweeperGamePool::CAllocator {
+public:
+	typedef T value_type;
+	template<typename U>
+	struct rebind {
+		typedef CAllocator<U> other;
+	};
+
+	explicit CAllocator( const shared_ptr<CState>& _state ) : state( _state ) {}
+	template<typename U>
+	CAllocator( const CAllocator<U>& other ) : state( other.state ) {}
+
+	T* allocate( size_t n ) { return static_cast<T*>( state->Allocate( n * sizeof( T ) ) ); }
+	void deallocate( T* block, size_t n ) { state->Deallocate( block, n * sizeof( T ) ); }
+
+	template<typename U>
+	bool operator==( const CAllocator<U>& other ) const { return state == other.state; }
+	template<typename U>
+	bool operator!=( const CAllocator<U>& other ) const { return state != other.state; }
+
+private:
+	template<typename U>
+	friend class CAllocator;
+
+	shared_ptr<CState> state;
+};
+
+// Deleter of the handed out games, it keeps the owning reference of the game
+// of the pool, the game is returned to the pool instead of the deletion
+class CMinesweeperGamePool::CRecycler {
+public:
+	CRecycler( const shared_ptr<CState>& _state, const shared_ptr<IMinesweeperGame>& _game,
+			bool _isTiled ) :
+		state( _state ),
+		game( _game ),
+		isTiled( _isTiled )
+	{
+	}
+
+	// the copy of the reference is dropped with the deleter
+	void operator()( IMinesweeperGame* ) const
+	{
+		lock_guard<mutex> lock( state->Lock );
+		state->FreeGames[isTiled ? 1 : 0].push_back( game );
+	}
+
+private:
+	shared_ptr<CState> state;
+	shared_ptr<IMinesweeperGame> game;
+	bool isTiled;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperGamePool::CMinesweeperGamePool( const CMinesweeperSizePolicy& policy ) :
+	state( make_shared<CState>( policy ) )
+{
+}
+
+const CMinesweeperSizePolicy& CMinesweeperGamePool::Policy() const
+{
+	return state->Policy;
+}
+
+size_t CMinesweeperGamePool::NumberOfGames() const
+{
+	lock_guard<mutex> lock( state->Lock );
+	return state->NumberOfGames;
+}
+
+size_t CMinesweeperGamePool::NumberOfFreeGames() const
+{
+	lock_guard<mutex> lock( state->Lock );
+	return state->FreeGames[0].size() + state->FreeGames[1].size();
+}
+
+void CMinesweeperGamePool::Reserve( size_t numberOfGames, size_t rows, size_t columns,
+	size_t bombs )
+{
+	vector<shared_ptr<IMinesweeperGame>> games;
+	while( NumberOfFreeGames() + games.size() < numberOfGames ) {
+		games.push_back( acquire( rows, columns, bombs, false, 0 ) );
+	}
+	// the handed out games return to the pool with their control blocks
+}
+
+shared_ptr<IMinesweeperGame> CMinesweeperGamePool::Acquire( size_t rows, size_t columns,
+	size_t bombs )
+{
+	return acquire( rows, columns, bombs, false, 0 );
+}
+
+shared_ptr<IMinesweeperGame> CMinesweeperGamePool::Acquire( size_t rows, size_t columns,
+	size_t bombs, uint64_t seed )
+{
+	return acquire( rows, columns, bombs, true, seed );
+}
+
+// the flat games start a game of any size allowed by the policy up to
+// MaxFlatCells, so any free game of the kind fits
+shared_ptr<IMinesweeperGame> CMinesweeperGamePool::acquire( size_t rows, size_t columns,
+	size_t bombs, bool hasSeed, uint64_t seed )
+{
+	internal_check( state->Policy.Allows( rows, columns, bombs ) );
+	const bool isTiled = rows * columns > state->Policy.MaxFlatCells;
+
+	shared_ptr<IMinesweeperGame> game;
+	{
+		lock_guard<mutex> lock( state->Lock );
+		vector<shared_ptr<IMinesweeperGame>>& freeGames = state->FreeGames[isTiled ? 1 : 0];
+		if( !freeGames.empty() ) {
+			game = move( freeGames.back() );
+			freeGames.pop_back();
+		}
+	}
+
+	if( !game ) {
+		game = CreateGame( rows, columns, bombs, state->Policy );
+		if( hasSeed ) {
+			game->NewGame( rows, columns, bombs, seed );
+		}
+		lock_guard<mutex> lock( state->Lock );
+		state->NumberOfGames++;
+		state->FreeGames[0].reserve( state->NumberOfGames );
+		state->FreeGames[1].reserve( state->NumberOfGames );
+		state->FreeBlocks.reserve( state->NumberOfGames );
+	} else {
+		try {
+			if( !isTiled ) {
+				game->SetFirstClick( MFC_Opening );
+			}
+			game->ResetStatistics();
+			// the sink of the previous user is not owned by the game,
+			// so it may be destroyed already
+			game->SetEventSink( nullptr, 0 );
+			// the undo states of the previous user would keep its boards
+			game->SetUndoDepth( 0 );
+			if( hasSeed ) {
+				game->NewGame( rows, columns, bombs, seed );
+			} else {
+				game->NewGame( rows, columns, bombs );
+			}
+		} catch( ... ) {
+			lock_guard<mutex> lock( state->Lock );
+			state->FreeGames[isTiled ? 1 : 0].push_back( game );
+			throw;
+		}
+	}
+
+	IMinesweeperGame* const pointer = game.get();
+	return shared_ptr<IMinesweeperGame>( pointer, CRecycler( state, move( game ), isTiled ),
+		CAllocator<IMinesweeperGame>( state ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+shared_ptr<IMinesweeperGame> CreateGame( size_t rows, size_t columns, size_t bombs,
+	CMinesweeperGamePool& pool )
+{
+	return pool.Acquire( rows, columns, bombs );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <Minesweeper.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Pool of recycled games
+// the games handed out by the pool are shared pointers, the game returns
+// to the pool once the last reference is dropped and the next Acquire
+// starts a new game on it, so a game of the same size reuses its board
+// storage and its cell proxies, the control blocks of the handed out
+// pointers are recycled by the pool as well, so once the pool is warm
+// (see Reserve) acquiring and releasing a game allocates nothing,
+// the pool may be used by many threads, its lock is held only to take
+// or return a game or a control block, the games are released when
+// the pool and all handed out games are gone
+class CMinesweeperGamePool {
+public:
+	// the games accept the parameters allowed by the policy, boards bigger than
+	// MaxFlatCells of the policy are tiled and are kept apart from flat ones
+	explicit CMinesweeperGamePool( const CMinesweeperSizePolicy& policy = ClassicSizePolicy() );
+	CMinesweeperGamePool( const CMinesweeperGamePool& ) = delete;
+	CMinesweeperGamePool& operator=( const CMinesweeperGamePool& ) = delete;
+
+	const CMinesweeperSizePolicy& Policy() const;
+	// number of games created by the pool and of games in the pool
+	size_t NumberOfGames() const;
+	size_t NumberOfFreeGames() const;
+
+	// creates games of the size, so the pool has at least the number of free games
+	// (throw an exception if failed)
+	void Reserve( size_t numberOfGames, size_t rows, size_t columns, size_t bombs );
+
+	// takes a game from the pool (or creates one if the pool is empty)
+	// and starts a new game on it, the first click, the event sink, the undo
+	// depth and the statistics of the game are reset, so it looks like
+	// created by CreateGame
+	// (throw an exception if failed)
+	shared_ptr<IMinesweeperGame> Acquire( size_t rows, size_t columns, size_t bombs );
+	shared_ptr<IMinesweeperGame> Acquire( size_t rows, size_t columns, size_t bombs,
+		uint64_t seed );
+
+private:
+	struct CState;
+	template<typename T>
+	class CAllocator;
+	class CRecycler;
+
+	shared_ptr<CState> state;
+
+	shared_ptr<IMinesweeperGame> acquire( size_t rows, size_t columns, size_t bombs,
+		bool hasSeed, uint64_t seed );
+};
+
+// creates the game by the pool like CreateGame (throw an exception if failed)
+shared_ptr<IMinesweeperGame> CreateGame( size_t rows, size_t columns, size_t bombs,
+	CMinesweeperGamePool& pool );
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
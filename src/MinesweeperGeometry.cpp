@@ -0,0 +1,69 @@
+#include <map>
+#include <mutex>
+#include <limits>
+#include <algorithm>
+#include <MinesweeperGeometry.h>
+#include <MinesweeperCommon.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperBoardGeometry::CMinesweeperBoardGeometry( size_t _rows, size_t _columns ) :
+	rows( _rows ),
+	columns( _columns ),
+	stride( _columns + 2 ),
+	planeSize( ( _rows + 2 ) * ( _columns + 2 ) )
+{
+	const ptrdiff_t offset = static_cast<ptrdiff_t>( stride );
+	const ptrdiff_t offsets[NumberOfNeighbors] = {
+		-offset - 1, -offset, -offset + 1,
+		-1, 1,
+		offset - 1, offset, offset + 1
+	};
+	copy( offsets, offsets + NumberOfNeighbors, neighborOffsets );
+
+	indexRows.resize( planeSize );
+	for( size_t row = 0; row < rows + 2; row++ ) {
+		fill( indexRows.begin() + row * stride, indexRows.begin() + ( row + 1 ) * stride,
+			static_cast<uint32_t>( row ) );
+	}
+	cellIndices.resize( rows * columns );
+	for( size_t row = 0; row < rows; row++ ) {
+		for( size_t column = 0; column < columns; column++ ) {
+			cellIndices[row * columns + column] = static_cast<uint32_t>( Index( row, column ) );
+		}
+	}
+}
+
+// the cache keeps weak references, so the geometries of the shapes
+// no longer played are released, their entries are dropped by next lookups
+shared_ptr<const CMinesweeperBoardGeometry> CMinesweeperBoardGeometry::Get( size_t rows,
+	size_t columns )
+{
+	internal_check( rows < numeric_limits<uint32_t>::max() - 2
+		&& columns < numeric_limits<uint32_t>::max() - 2 );
+	internal_check( ( rows + 2 ) <= numeric_limits<uint32_t>::max() / ( columns + 2 ) );
+
+	typedef map<pair<size_t, size_t>, weak_ptr<const CMinesweeperBoardGeometry>> TCache;
+	static mutex lock;
+	static TCache cache;
+
+	lock_guard<mutex> guard( lock );
+	const pair<size_t, size_t> shape( rows, columns );
+	shared_ptr<const CMinesweeperBoardGeometry> geometry = cache[shape].lock();
+	if( !geometry ) {
+		for( TCache::iterator i = cache.begin(); i != cache.end(); ) {
+			i = i->second.expired() && i->first != shape ? cache.erase( i ) : next( i );
+		}
+		geometry.reset( new CMinesweeperBoardGeometry( rows, columns ) );
+		cache[shape] = geometry;
+	}
+	return geometry;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
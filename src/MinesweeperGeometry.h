@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <Minesweeper.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Immutable geometry of the flat boards of a shape
+// the layout of the padded planes (MinesweeperBoard.h): the stride,
+// the neighbor offsets, the row of every plane index and the plane
+// index of every cell ( row * columns + column ), so converting positions
+// needs no division, the geometries are cached process wide by their shape
+// and shared by all boards of the shape, a geometry lives while it is used
+class CMinesweeperBoardGeometry {
+public:
+	static const size_t NumberOfNeighbors = 8;
+
+	// returns the geometry of the shape (throw an exception if the planes
+	// of the shape do not fit 32-bit indices)
+	static shared_ptr<const CMinesweeperBoardGeometry> Get( size_t rows, size_t columns );
+
+	CMinesweeperBoardGeometry( const CMinesweeperBoardGeometry& ) = delete;
+	CMinesweeperBoardGeometry& operator=( const CMinesweeperBoardGeometry& ) = delete;
+
+	size_t Rows() const { return rows; }
+	size_t Columns() const { return columns; }
+	size_t Stride() const { return stride; }
+	size_t PlaneSize() const { return planeSize; }
+	const ptrdiff_t* NeighborOffsets() const { return neighborOffsets; }
+
+	size_t Index( size_t row, size_t column ) const { return ( row + 1 ) * stride + column + 1; }
+	// the rows of the border cells are -1 and Rows(), their columns are -1 and Columns()
+	size_t Row( size_t index ) const;
+	size_t Column( size_t index ) const;
+	// plane indices of the cells ( row * columns + column )
+	const uint32_t* CellIndices() const { return cellIndices.data(); }
+
+private:
+	const size_t rows;
+	const size_t columns;
+	const size_t stride;
+	const size_t planeSize;
+	ptrdiff_t neighborOffsets[NumberOfNeighbors];
+	// row + 1 of every plane index
+	vector<uint32_t> indexRows;
+	vector<uint32_t> cellIndices;
+
+	CMinesweeperBoardGeometry( size_t rows, size_t columns );
+};
+
+inline size_t CMinesweeperBoardGeometry::Row( size_t index ) const
+{
+	return static_cast<size_t>( indexRows[index] ) - 1;
+}
+
+inline size_t CMinesweeperBoardGeometry::Column( size_t index ) const
+{
+	return index - static_cast<size_t>( indexRows[index] ) * stride - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <exception>
+#include <Minesweeper.h>
+#include <MinesweeperSolver.h>
+#include <MinesweeperProbability.h>
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace Minesweeper;
+
+void Draw( const IMinesweeperGame* game )
+{
+	for( size_t i = 0; i < game->Rows(); i++ ) {
+		for( size_t j = 0; j < game->Columns(); j++ ) {
+			const IMinesweeperCell* cell = game->Cell( i, j );
+			if( cell->IsOpened() ) {
+				if( cell->IsBomb() ) {
+					cout << "*";
+				} else {
+					size_t bombs = cell->NumberOfNeighborBombs();
+					if( bombs == 0 ) {
+						cout << "O";
+					} else {
+						cout << bombs;
+					}
+				}
+			} else {
+				cout << "-";
+			}
+		}
+		cout << endl;
+	}
+	cout << endl;
+}
+
+int main( int argc, const char* argv[] )
+{
+	try {
+		shared_ptr<IMinesweeperGame> game = CreateGame();
+		Draw( game.get() );
+
+		// the solver opens all deduced safe cells, when it is stuck
+		// the cell with the lowest bomb probability is opened
+		CMinesweeperSolver solver;
+		CMinesweeperProbability probability;
+		solver.Reset( *game );
+		while( game->GameState() == MGS_Active ) {
+			if( solver.Play( *game ) > 0 ) {
+				Draw( game.get() );
+				continue;
+			}
+			size_t row;
+			size_t column;
+			probability.Calculate( solver );
+			if( !probability.SafestCell( row, column ) ) {
+				break;
+			}
+			game->Cell( row, column )->Open();
+			Draw( game.get() );
+		}
+	} catch( exception& e ) {
+		cerr << e.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include <limits>
+#include <MinesweeperMoveLog.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperMoveLog::CMinesweeperMoveLog() :
+	rows( 0 ),
+	columns( 0 ),
+	bombs( 0 ),
+	seed( 0 ),
+	firstClick( MFC_Any ),
+	replayable( false ),
+	numberOfMoves( 0 )
+{
+}
+
+void CMinesweeperMoveLog::Reset( size_t _rows, size_t _columns, size_t _bombs,
+	uint64_t _seed, TMinesweeperFirstClick _firstClick )
+{
+	rows = _rows;
+	columns = _columns;
+	bombs = _bombs;
+	seed = _seed;
+	firstClick = _firstClick;
+	replayable = true;
+	numberOfMoves = 0;
+	data.clear();
+}
+
+void CMinesweeperMoveLog::ResetNotReplayable( size_t _rows, size_t _columns,
+	size_t _bombs, uint64_t _seed )
+{
+	Reset( _rows, _columns, _bombs, _seed, MFC_Any );
+	replayable = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CMinesweeperReplay::Replay( const CMinesweeperMoveLog& log )
+{
+	Replay( log, numeric_limits<size_t>::max() );
+}
+
+void CMinesweeperReplay::Replay( const CMinesweeperMoveLog& log, size_t numberOfMoves )
+{
+	internal_check( log.IsReplayable() );
+	if( board.Rows() != log.Rows() || board.Columns() != log.Columns() ) {
+		board.Reset( log.Rows(), log.Columns() );
+		engine.Reset( board );
+	}
+	engine.Start( board, log.Bombs(), log.Seed(), log.FirstClick() );
+
+	const size_t columns = log.Columns();
+	CMinesweeperNullObserver observer;
+	CMinesweeperMove move;
+	size_t offset = 0;
+	for( size_t i = 0; i < numberOfMoves && log.Next( offset, move ); i++ ) {
+		internal_check( move.Cell < board.Size() );
+		const size_t index = board.Index( move.Cell / columns, move.Cell % columns );
+		switch( move.Type ) {
+			case MMT_Open:
+			case MMT_Chord:
+				engine.Open( board, index, observer );
+				break;
+			case MMT_LabelNone:
+			case MMT_LabelBomb:
+			case MMT_LabelQuestion:
+				engine.SetLabel( board, index,
+					static_cast<TMinesweeperCellLabel>( move.Type - MMT_LabelNone ), observer );
+				break;
+			case MMT_Restart:
+				engine.Restart( board, observer );
+				break;
+			default:
+				internal_check( false );
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
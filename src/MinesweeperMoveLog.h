@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <Minesweeper.h>
+#include <MinesweeperCommon.h>
+#include <MinesweeperBoard.h>
+#include <MinesweeperEngine.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The kind of a recorded move
+enum TMinesweeperMoveType {
+	MMT_Open, // open of a closed cell
+	MMT_Chord, // open of an opened cell (opens its neighbors)
+	MMT_LabelNone,
+	MMT_LabelBomb,
+	MMT_LabelQuestion,
+	MMT_Restart,
+	MMT_NumberOfMoveTypes
+};
+
+struct CMinesweeperMove {
+	TMinesweeperMoveType Type;
+	// the cell ( row * columns + column )
+	size_t Cell;
+};
+
+// Append only log of the moves of a game
+// every move is a single varint ( cell * 8 + type ), so most moves of
+// classic boards take two bytes, the log starts with the parameters,
+// the seed and the first open protection of the game, which is enough
+// for deterministic replay
+class CMinesweeperMoveLog {
+public:
+	static const size_t TypeBits = 3;
+
+	CMinesweeperMoveLog();
+
+	// starts a new log of the game (allocates only if the log grows)
+	void Reset( size_t rows, size_t columns, size_t bombs, uint64_t seed,
+		TMinesweeperFirstClick firstClick );
+	// the game was restored from a snapshot, so its moves can not be replayed
+	void ResetNotReplayable( size_t rows, size_t columns, size_t bombs, uint64_t seed );
+	void Append( TMinesweeperMoveType type, size_t cell );
+	// drops the moves after the first numberOfMoves, the size is the Size()
+	// of the log after those moves (the undo of moves)
+	void Truncate( size_t size, size_t numberOfMoves );
+
+	size_t Rows() const { return rows; }
+	size_t Columns() const { return columns; }
+	size_t Bombs() const { return bombs; }
+	uint64_t Seed() const { return seed; }
+	TMinesweeperFirstClick FirstClick() const { return firstClick; }
+	bool IsReplayable() const { return replayable; }
+	size_t NumberOfMoves() const { return numberOfMoves; }
+
+	// the encoded moves
+	const uint8_t* Data() const { return data.data(); }
+	size_t Size() const { return data.size(); }
+
+	// decodes the move at the offset and moves the offset to the next one,
+	// returns false at the end of the log
+	bool Next( size_t& offset, CMinesweeperMove& move ) const;
+
+private:
+	size_t rows;
+	size_t columns;
+	size_t bombs;
+	uint64_t seed;
+	TMinesweeperFirstClick firstClick;
+	bool replayable;
+	size_t numberOfMoves;
+	vector<uint8_t> data;
+};
+
+inline void CMinesweeperMoveLog::Append( TMinesweeperMoveType type, size_t cell )
+{
+	uint64_t value = ( uint64_t( cell ) << TypeBits ) | uint64_t( type );
+	while( value >= 0x80 ) {
+		data.push_back( static_cast<uint8_t>( value | 0x80 ) );
+		value >>= 7;
+	}
+	data.push_back( static_cast<uint8_t>( value ) );
+	numberOfMoves++;
+}
+
+inline void CMinesweeperMoveLog::Truncate( size_t size, size_t _numberOfMoves )
+{
+	internal_check( size <= data.size() && _numberOfMoves <= numberOfMoves );
+	data.resize( size );
+	numberOfMoves = _numberOfMoves;
+}
+
+inline bool CMinesweeperMoveLog::Next( size_t& offset, CMinesweeperMove& move ) const
+{
+	if( offset >= data.size() ) {
+		return false;
+	}
+	uint64_t value = 0;
+	unsigned shift = 0;
+	uint8_t byte;
+	do {
+		internal_check( offset < data.size() && shift < 64 );
+		byte = data[offset++];
+		value |= uint64_t( byte & 0x7F ) << shift;
+		shift += 7;
+	} while( ( byte & 0x80 ) != 0 );
+
+	const uint64_t type = value & ( ( uint64_t( 1 ) << TypeBits ) - 1 );
+	internal_check( type < MMT_NumberOfMoveTypes );
+	move.Type = static_cast<TMinesweeperMoveType>( type );
+	move.Cell = static_cast<size_t>( value >> TypeBits );
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Fast replay of move logs
+// the moves are applied directly by the engine to its own board without
+// cell proxies and without reporting of modified cells
+class CMinesweeperReplay {
+public:
+	CMinesweeperReplay() {}
+	CMinesweeperReplay( const CMinesweeperReplay& ) = delete;
+	CMinesweeperReplay& operator=( const CMinesweeperReplay& ) = delete;
+
+	// replays the whole log (throw an exception if failed)
+	void Replay( const CMinesweeperMoveLog& log );
+	// replays the first moves of the log
+	void Replay( const CMinesweeperMoveLog& log, size_t numberOfMoves );
+
+	// the board after the replay
+	const CMinesweeperBoardView& Board() const { return board; }
+	TMinesweeperGameState GameState() const { return board.State(); }
+
+private:
+	CMinesweeperBoard board;
+	CMinesweeperEngine engine;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,395 @@
+#include <algorithm>
+#include <exception>
+#include <MinesweeperNoGuess.h>
+#include <MinesweeperSnapshot.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperNoGuessGenerator::CMinesweeperNoGuessGenerator() :
+	seed( 0 ),
+	firstCell( 0 ),
+	numberOfPlantings( 0 ),
+	numberOfRepairs( 0 )
+{
+}
+
+bool CMinesweeperNoGuessGenerator::Generate( size_t rows, size_t columns, size_t bombs,
+	size_t firstRow, size_t firstColumn, uint64_t _seed, const atomic<bool>& cancel )
+{
+	internal_check( firstRow < rows && firstColumn < columns );
+	internal_check( bombs < rows * columns );
+
+	board.Reset( rows, columns );
+	engine.Reset( board );
+	seed = _seed;
+	random.Seed( MixSeed( seed ) );
+	firstCell = board.Index( firstRow, firstColumn );
+	numberOfPlantings = 0;
+	numberOfRepairs = 0;
+
+	CMinesweeperNullObserver observer;
+	for( uint64_t plantingSeed = seed; ; plantingSeed = MixSeed( plantingSeed ) ) {
+		engine.Start( board, bombs, plantingSeed, MFC_Opening );
+		numberOfPlantings++;
+		for( size_t repairs = 0; ; repairs++ ) {
+			if( cancel.load( memory_order_relaxed ) ) {
+				return false;
+			}
+			const bool solved = play();
+			engine.Restart( board, observer );
+			if( solved ) {
+				return true;
+			}
+			if( repairs == MaxRepairs || !repair() ) {
+				break;
+			}
+			numberOfRepairs++;
+		}
+	}
+}
+
+void CMinesweeperNoGuessGenerator::Serialize( vector<uint8_t>& buffer ) const
+{
+	internal_check( board.Rows() <= UINT32_MAX && board.Columns() <= UINT32_MAX );
+	internal_check( board.Bombs() <= UINT32_MAX );
+	CMinesweeperSnapshotHeader header = {};
+	header.Magic = CMinesweeperSnapshotHeader::SnapshotMagic;
+	header.Version = CMinesweeperSnapshotHeader::CurrentVersion;
+	header.HeaderSize = sizeof( CMinesweeperSnapshotHeader );
+	header.Rows = static_cast<uint32_t>( board.Rows() );
+	header.Columns = static_cast<uint32_t>( board.Columns() );
+	header.Bombs = static_cast<uint32_t>( board.Bombs() );
+	header.State = static_cast<uint8_t>( MGS_Active );
+	header.PendingFirstClick = static_cast<uint8_t>( MFC_Any );
+	header.Seed = seed;
+
+	WriteSnapshot( header,
+		[this]( size_t row, size_t column ) { return board.IsBomb( board.Index( row, column ) ); },
+		[]( size_t, size_t ) { return false; },
+		[]( size_t, size_t ) { return MCL_None; },
+		buffer );
+}
+
+void CMinesweeperNoGuessGenerator::CSolverObserver::OnModifiedMask( size_t word,
+	uint64_t mask )
+{
+	for( ; mask != 0; mask &= mask - 1 ) {
+		OnModified( word * 64 + CountTrailingZeros( mask ) );
+	}
+}
+
+// opens the first click and then the deduced safe cells,
+// returns true if all safe cells are opened
+bool CMinesweeperNoGuessGenerator::play()
+{
+	CSolverObserver observer = { solver, board };
+	solver.Reset( board );
+	engine.Open( board, firstCell, observer );
+	while( board.State() == MGS_Active ) {
+		solver.Solve();
+		size_t row;
+		size_t column;
+		if( !solver.NextSafeCell( row, column ) ) {
+			return false;
+		}
+		engine.Open( board, board.Index( row, column ), observer );
+	}
+	internal_check( board.State() == MGS_Success );
+	return true;
+}
+
+// moves a bomb of the stuck region to an unknown cell out of the region,
+// or to another cell of the region if there are no such cells,
+// the cells known by the solver and so the first click area are kept
+bool CMinesweeperNoGuessGenerator::repair()
+{
+	stuckCells.clear();
+	otherCells.clear();
+	const ptrdiff_t* const offsets = solver.NeighborOffsets();
+	for( size_t row = 0; row < board.Rows(); row++ ) {
+		for( size_t column = 0; column < board.Columns(); column++ ) {
+			const size_t index = solver.Index( row, column );
+			if( solver.Knowledge( index ) != MSC_Unknown ) {
+				continue;
+			}
+			bool isStuck = false;
+			for( size_t i = 0; i < CMinesweeperSolver::NumberOfNeighbors; i++ ) {
+				const TMinesweeperSolverCell neighbor = solver.Knowledge( index + offsets[i] );
+				if( neighbor == MSC_Opened || neighbor == MSC_Mine ) {
+					isStuck = true;
+					break;
+				}
+			}
+			( isStuck ? stuckCells : otherCells ).push_back( board.Index( row, column ) );
+		}
+	}
+
+	const size_t from = chooseCell( stuckCells, true );
+	size_t to = chooseCell( otherCells, false );
+	if( to == NotFound ) {
+		to = chooseCell( stuckCells, false );
+	}
+	if( from == NotFound || to == NotFound ) {
+		return false;
+	}
+	CMinesweeperEngine::MoveBomb( board, from, to );
+	return true;
+}
+
+// returns a random cell which is bomb or not
+size_t CMinesweeperNoGuessGenerator::chooseCell( const vector<size_t>& cells, bool isBomb )
+{
+	size_t numberOfCells = 0;
+	for( auto i = cells.cbegin(); i != cells.cend(); ++i ) {
+		if( board.IsBomb( *i ) == isBomb ) {
+			numberOfCells++;
+		}
+	}
+	if( numberOfCells == 0 ) {
+		return NotFound;
+	}
+
+	size_t chosen = static_cast<size_t>( random.Next( numberOfCells ) );
+	for( auto i = cells.cbegin(); i != cells.cend(); ++i ) {
+		if( board.IsBomb( *i ) == isBomb && chosen-- == 0 ) {
+			return *i;
+		}
+	}
+	return NotFound;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GenerateNoGuessBoards( size_t rows, size_t columns, size_t bombs,
+	size_t firstRow, size_t firstColumn, size_t numberOfBoards, uint64_t seed,
+	vector<CMinesweeperNoGuessBoard>& boards, size_t numberOfThreads )
+{
+	boards.clear();
+	if( numberOfThreads == 0 ) {
+		numberOfThreads = max<size_t>( thread::hardware_concurrency(), 1 );
+	}
+	numberOfThreads = max<size_t>( min( numberOfThreads, numberOfBoards ), 1 );
+
+	mutex lock;
+	atomic<bool> enough( numberOfBoards == 0 );
+	atomic<uint64_t> nextBoard( 0 );
+	vector<exception_ptr> errors( numberOfThreads );
+	const auto generate = [&]( size_t worker ) {
+		try {
+			CMinesweeperNoGuessGenerator generator;
+			while( !enough.load( memory_order_relaxed ) ) {
+				const uint64_t boardSeed = seed ^ MixSeed( nextBoard.fetch_add( 1 ) );
+				if( !generator.Generate( rows, columns, bombs,
+					firstRow, firstColumn, boardSeed, enough ) )
+				{
+					break;
+				}
+
+				CMinesweeperNoGuessBoard board = { firstRow, firstColumn, vector<uint8_t>() };
+				generator.Serialize( board.Snapshot );
+				lock_guard<mutex> guard( lock );
+				if( boards.size() < numberOfBoards ) {
+					boards.push_back( move( board ) );
+				}
+				if( boards.size() == numberOfBoards ) {
+					enough = true;
+				}
+			}
+		} catch( ... ) {
+			errors[worker] = current_exception();
+			enough = true;
+		}
+	};
+
+	vector<thread> workers;
+	workers.reserve( numberOfThreads - 1 );
+	for( size_t i = 1; i < numberOfThreads; i++ ) {
+		workers.emplace_back( generate, i );
+	}
+	// the calling thread is one of the generators
+	generate( 0 );
+	for( size_t i = 0; i < workers.size(); i++ ) {
+		workers[i].join();
+	}
+	for( size_t i = 0; i < errors.size(); i++ ) {
+		if( errors[i] ) {
+			rethrow_exception( errors[i] );
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperNoGuessPool::CMinesweeperNoGuessPool( size_t _capacity,
+		size_t numberOfThreads ) :
+	capacity( _capacity ),
+	seed( GenerateSeed() ),
+	numberOfBoards( 0 ),
+	stopping( false )
+{
+	if( numberOfThreads == 0 ) {
+		numberOfThreads = max<size_t>( thread::hardware_concurrency(), 1 );
+	}
+	workers.reserve( numberOfThreads );
+	for( size_t i = 0; i < numberOfThreads; i++ ) {
+		workers.emplace_back( &CMinesweeperNoGuessPool::work, this );
+	}
+}
+
+CMinesweeperNoGuessPool::~CMinesweeperNoGuessPool()
+{
+	{
+		lock_guard<mutex> guard( lock );
+		stopping = true;
+	}
+	needsBoards.notify_all();
+	for( auto i = workers.begin(); i != workers.end(); ++i ) {
+		i->join();
+	}
+}
+
+void CMinesweeperNoGuessPool::Add( size_t rows, size_t columns, size_t bombs )
+{
+	internal_check( rows > 0 && columns > 0 && bombs < rows * columns );
+	{
+		lock_guard<mutex> guard( lock );
+		if( find( rows, columns, bombs ) != nullptr ) {
+			return;
+		}
+		const CConfiguration configuration = { rows, columns, bombs, 0,
+			deque<CMinesweeperNoGuessBoard>() };
+		configurations.push_back( configuration );
+	}
+	needsBoards.notify_all();
+}
+
+void CMinesweeperNoGuessPool::AddClassic()
+{
+	Add( 9, 9, 10 );
+	Add( 16, 16, 40 );
+	Add( 16, 30, 99 );
+}
+
+void CMinesweeperNoGuessPool::Fill()
+{
+	unique_lock<mutex> guard( lock );
+	hasBoards.wait( guard, [this]() {
+		for( auto i = configurations.cbegin(); i != configurations.cend(); ++i ) {
+			if( i->Boards.size() < capacity ) {
+				return false;
+			}
+		}
+		return true;
+	} );
+}
+
+size_t CMinesweeperNoGuessPool::Size( size_t rows, size_t columns, size_t bombs ) const
+{
+	lock_guard<mutex> guard( lock );
+	const CConfiguration* const configuration = find( rows, columns, bombs );
+	return configuration != nullptr ? configuration->Boards.size() : 0;
+}
+
+bool CMinesweeperNoGuessPool::Take( size_t rows, size_t columns, size_t bombs,
+	CMinesweeperNoGuessBoard& board )
+{
+	{
+		lock_guard<mutex> guard( lock );
+		CConfiguration* const configuration =
+			const_cast<CConfiguration*>( find( rows, columns, bombs ) );
+		if( configuration == nullptr || configuration->Boards.empty() ) {
+			return false;
+		}
+		board = move( configuration->Boards.front() );
+		configuration->Boards.pop_front();
+	}
+	needsBoards.notify_one();
+	return true;
+}
+
+bool CMinesweeperNoGuessPool::NewGame( IMinesweeperGame& game,
+	size_t rows, size_t columns, size_t bombs, size_t& firstRow, size_t& firstColumn )
+{
+	CMinesweeperNoGuessBoard board;
+	if( !Take( rows, columns, bombs, board ) ) {
+		return false;
+	}
+	game.Deserialize( board.Snapshot.data(), board.Snapshot.size() );
+	firstRow = board.FirstRow;
+	firstColumn = board.FirstColumn;
+	return true;
+}
+
+void CMinesweeperNoGuessPool::work()
+{
+	CMinesweeperNoGuessGenerator generator;
+	for( ;; ) {
+		CConfiguration* configuration;
+		uint64_t boardSeed;
+		{
+			unique_lock<mutex> guard( lock );
+			needsBoards.wait( guard, [this]() { return stopping || neediest() != nullptr; } );
+			if( stopping ) {
+				return;
+			}
+			configuration = neediest();
+			configuration->NumberOfGenerating++;
+			boardSeed = seed ^ MixSeed( numberOfBoards++ );
+		}
+
+		// the configurations are checked by Add, so nothing throws
+		const size_t firstCell = static_cast<size_t>(
+			MixSeed( boardSeed ) % ( configuration->Rows * configuration->Columns ) );
+		CMinesweeperNoGuessBoard board = { firstCell / configuration->Columns,
+			firstCell % configuration->Columns, vector<uint8_t>() };
+		const bool generated = generator.Generate( configuration->Rows,
+			configuration->Columns, configuration->Bombs,
+			board.FirstRow, board.FirstColumn, boardSeed, stopping );
+		if( generated ) {
+			generator.Serialize( board.Snapshot );
+		}
+
+		{
+			lock_guard<mutex> guard( lock );
+			configuration->NumberOfGenerating--;
+			if( generated ) {
+				configuration->Boards.push_back( move( board ) );
+			}
+		}
+		hasBoards.notify_all();
+	}
+}
+
+// the configuration with the least boards which is not full
+CMinesweeperNoGuessPool::CConfiguration* CMinesweeperNoGuessPool::neediest()
+{
+	CConfiguration* result = nullptr;
+	size_t least = capacity;
+	for( auto i = configurations.begin(); i != configurations.end(); ++i ) {
+		const size_t size = i->Boards.size() + i->NumberOfGenerating;
+		if( size < least ) {
+			least = size;
+			result = &*i;
+		}
+	}
+	return result;
+}
+
+const CMinesweeperNoGuessPool::CConfiguration* CMinesweeperNoGuessPool::find(
+	size_t rows, size_t columns, size_t bombs ) const
+{
+	for( auto i = configurations.cbegin(); i != configurations.cend(); ++i ) {
+		if( i->Rows == rows && i->Columns == columns && i->Bombs == bombs ) {
+			return &*i;
+		}
+	}
+	return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <Minesweeper.h>
+#include <MinesweeperBoard.h>
+#include <MinesweeperEngine.h>
+#include <MinesweeperRandom.h>
+#include <MinesweeperSolver.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A board which is solvable without guessing from its first click
+struct CMinesweeperNoGuessBoard {
+	size_t FirstRow;
+	size_t FirstColumn;
+	// snapshot of the closed board (MinesweeperSnapshot.h)
+	vector<uint8_t> Snapshot;
+};
+
+// Generator of boards solvable without guessing
+// the bombs are planted around the first click like MFC_Opening and
+// the solver plays the board from the first click, when the solver is stuck
+// a bomb of the stuck region (unknown cells next to the known cells) is moved
+// to an unknown cell away from it and the board is played again, so the
+// board is repaired in place, only if the repairs do not help the bombs
+// are planted again from the next seed
+// note: the solver knows only local rules (MinesweeperSolver.h),
+// so the boards never need the total number of bombs to be solved
+class CMinesweeperNoGuessGenerator {
+public:
+	// repairs of the board before the bombs are planted again
+	static const size_t MaxRepairs = 256;
+
+	CMinesweeperNoGuessGenerator();
+	CMinesweeperNoGuessGenerator( const CMinesweeperNoGuessGenerator& ) = delete;
+	CMinesweeperNoGuessGenerator& operator=( const CMinesweeperNoGuessGenerator& ) = delete;
+
+	// generates the board solvable from the first click, the same parameters
+	// and seed give the same board (throw an exception if failed)
+	// returns false if cancelled, the flag is checked before every play
+	// note: boards with too many bombs may take very long
+	bool Generate( size_t rows, size_t columns, size_t bombs,
+		size_t firstRow, size_t firstColumn, uint64_t seed,
+		const atomic<bool>& cancel );
+
+	// the generated board, all its cells are closed
+	const CMinesweeperBoardView& Board() const { return board; }
+	// number of plantings and of repairs made by the last generation
+	size_t NumberOfPlantings() const { return numberOfPlantings; }
+	size_t NumberOfRepairs() const { return numberOfRepairs; }
+	// the seed passed to the last generation
+	uint64_t Seed() const { return seed; }
+	// appends the snapshot of the generated board to the buffer,
+	// the seed of the snapshot is the seed of Generate, the repaired bombs
+	// are reproduced only by Generate with the same parameters
+	void Serialize( vector<uint8_t>& buffer ) const;
+
+private:
+	static const size_t NotFound = static_cast<size_t>( -1 );
+
+	// passes the cells opened by the engine to the solver
+	struct CSolverObserver {
+		CMinesweeperSolver& Solver;
+		const CMinesweeperBoardView& Board;
+
+		void OnModified( size_t index ) { Solver.Update( Board, index ); }
+		void OnModifiedMask( size_t word, uint64_t mask );
+		void OnCascadeBegin( size_t /* index */ ) {}
+		void OnCascadeEnd( size_t /* index */ ) {}
+	};
+
+	CMinesweeperBoard board;
+	CMinesweeperEngine engine;
+	CMinesweeperSolver solver;
+	CMinesweeperRandom random;
+	uint64_t seed;
+	size_t firstCell;
+	size_t numberOfPlantings;
+	size_t numberOfRepairs;
+	// buffers of repair
+	vector<size_t> stuckCells;
+	vector<size_t> otherCells;
+
+	bool play();
+	bool repair();
+	size_t chooseCell( const vector<size_t>& cells, bool isBomb );
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// generates the number of boards solvable without guessing in parallel,
+// the board i is generated from the seed ( seed ^ MixSeed( i ) )
+// and all threads stop as soon as enough boards are found,
+// so the boards are generated in the order they are found
+// zero number of threads means the number of hardware threads
+// (throw an exception if failed)
+void GenerateNoGuessBoards( size_t rows, size_t columns, size_t bombs,
+	size_t firstRow, size_t firstColumn, size_t numberOfBoards, uint64_t seed,
+	vector<CMinesweeperNoGuessBoard>& boards, size_t numberOfThreads = 0 );
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Pool of ready boards solvable without guessing
+// background threads keep up to capacity boards of every added
+// configuration, so a new game only restores a ready snapshot,
+// the first click of every board is chosen randomly from its seed
+class CMinesweeperNoGuessPool {
+public:
+	// zero number of threads means the number of hardware threads
+	explicit CMinesweeperNoGuessPool( size_t capacity, size_t numberOfThreads = 0 );
+	// cancels the generations which are running
+	~CMinesweeperNoGuessPool();
+	CMinesweeperNoGuessPool( const CMinesweeperNoGuessPool& ) = delete;
+	CMinesweeperNoGuessPool& operator=( const CMinesweeperNoGuessPool& ) = delete;
+
+	// adds the configuration, its boards are generated in background
+	// (throw an exception if the configuration cannot be generated)
+	void Add( size_t rows, size_t columns, size_t bombs );
+	// adds beginner 9x9/10, intermediate 16x16/40 and expert 16x30/99
+	void AddClassic();
+	// waits until all configurations have capacity boards
+	void Fill();
+
+	// number of ready boards of the configuration
+	size_t Size( size_t rows, size_t columns, size_t bombs ) const;
+	// takes a ready board, returns false if there is no ready board
+	// (unknown configurations never have ready boards)
+	bool Take( size_t rows, size_t columns, size_t bombs, CMinesweeperNoGuessBoard& board );
+	// starts a new game on a ready board, returns false if there is none,
+	// the game must be opened first at ( firstRow, firstColumn ),
+	// Seed() of the game is the seed of the generation, so NewGame
+	// of the seed does not give the same board
+	// (throw an exception if the game cannot play the board)
+	bool NewGame( IMinesweeperGame& game, size_t rows, size_t columns, size_t bombs,
+		size_t& firstRow, size_t& firstColumn );
+
+private:
+	struct CConfiguration {
+		size_t Rows;
+		size_t Columns;
+		size_t Bombs;
+		// boards which are being generated
+		size_t NumberOfGenerating;
+		deque<CMinesweeperNoGuessBoard> Boards;
+	};
+
+	const size_t capacity;
+	const uint64_t seed;
+	mutable mutex lock;
+	condition_variable needsBoards;
+	condition_variable hasBoards;
+	deque<CConfiguration> configurations;
+	uint64_t numberOfBoards;
+	atomic<bool> stopping;
+	vector<thread> workers;
+
+	void work();
+	CConfiguration* neediest();
+	const CConfiguration* find( size_t rows, size_t columns, size_t bombs ) const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
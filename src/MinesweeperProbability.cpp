@@ -0,0 +1,378 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <MinesweeperProbability.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const uint8_t ConstraintFlag = 1;
+const uint8_t VariableFlag = 2;
+const uint8_t UnknownFlag = 4;
+
+void appendNumber( string& signature, size_t number )
+{
+	for( size_t i = 0; i < sizeof( uint32_t ); i++ ) {
+		signature.push_back( static_cast<char>( ( number >> ( 8 * i ) ) & 0xFF ) );
+	}
+}
+
+// result[i + j] = sum of first[i] * second[j]
+vector<double> convolve( const vector<double>& first, const vector<double>& second )
+{
+	vector<double> result( first.size() + second.size() - 1, 0 );
+	for( size_t i = 0; i < first.size(); i++ ) {
+		for( size_t j = 0; j < second.size(); j++ ) {
+			result[i + j] += first[i] * second[j];
+		}
+	}
+	return result;
+}
+
+// log C( n, k ) for k in [first, last], where first <= last <= n
+// note: lgamma is not used, it is not thread safe (it sets signgam)
+vector<double> logBinomials( size_t n, size_t first, size_t last )
+{
+	vector<double> result( last - first + 1, 0 );
+	const size_t terms = min( first, n - first );
+	double logBinomial = 0;
+	for( size_t i = 1; i <= terms; i++ ) {
+		logBinomial += log( static_cast<double>( n - terms + i ) / i );
+	}
+	result[0] = logBinomial;
+	for( size_t k = first + 1; k <= last; k++ ) {
+		logBinomial += log( static_cast<double>( n - k + 1 ) / k );
+		result[k - first] = logBinomial;
+	}
+	return result;
+}
+
+} // end of anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperProbability::CMinesweeperProbability() :
+	rows( 0 ),
+	columns( 0 ),
+	stride( 0 ),
+	numberOfComponents( 0 ),
+	cacheHits( 0 ),
+	cacheMisses( 0 ),
+	interiorProbability( 0 )
+{
+}
+
+void CMinesweeperProbability::Calculate( const CMinesweeperSolver& solver )
+{
+	rows = solver.Rows();
+	columns = solver.Columns();
+	stride = solver.Stride();
+	const size_t planeSize = ( rows + 4 ) * stride;
+	probabilities.assign( planeSize, 0 );
+	inComponent.assign( planeSize, 0 );
+
+	buildComponents( solver );
+	for( size_t i = 0; i < numberOfComponents; i++ ) {
+		components[i].Solution = solve( solver, components[i] );
+	}
+	combine( solver );
+}
+
+double CMinesweeperProbability::Probability( size_t row, size_t column ) const
+{
+	internal_check( row < rows && column < columns );
+	return probabilities[( row + 2 ) * stride + column + 2];
+}
+
+bool CMinesweeperProbability::SafestCell( size_t& row, size_t& column ) const
+{
+	double minProbability = numeric_limits<double>::infinity();
+	for( size_t r = 0; r < rows; r++ ) {
+		for( size_t c = 0; c < columns; c++ ) {
+			const size_t index = ( r + 2 ) * stride + c + 2;
+			if( ( inComponent[index] & UnknownFlag ) != 0
+				&& probabilities[index] < minProbability )
+			{
+				minProbability = probabilities[index];
+				row = r;
+				column = c;
+			}
+		}
+	}
+	return minProbability <= 1;
+}
+
+void CMinesweeperProbability::buildComponents( const CMinesweeperSolver& solver )
+{
+	numberOfComponents = 0;
+	const vector<size_t>& frontier = solver.Frontier();
+	for( auto i = frontier.cbegin(); i != frontier.cend(); ++i ) {
+		if( ( inComponent[*i] & ConstraintFlag ) == 0 ) {
+			if( components.size() <= numberOfComponents ) {
+				components.emplace_back();
+			}
+			buildComponent( solver, *i, components[numberOfComponents] );
+			numberOfComponents++;
+		}
+	}
+}
+
+void CMinesweeperProbability::buildComponent( const CMinesweeperSolver& solver,
+	size_t start, CComponent& component )
+{
+	const ptrdiff_t* const offsets = solver.NeighborOffsets();
+	component.Constraints.clear();
+	component.Variables.clear();
+	component.Solution.reset();
+
+	inComponent[start] |= ConstraintFlag;
+	component.Constraints.push_back( start );
+	for( size_t head = 0; head < component.Constraints.size(); head++ ) {
+		const size_t constraint = component.Constraints[head];
+		for( size_t i = 0; i < CMinesweeperSolver::NumberOfNeighbors; i++ ) {
+			const size_t variable = constraint + offsets[i];
+			if( solver.Knowledge( variable ) != MSC_Unknown
+				|| ( inComponent[variable] & VariableFlag ) != 0 )
+			{
+				continue;
+			}
+			inComponent[variable] |= VariableFlag;
+			component.Variables.push_back( variable );
+			for( size_t j = 0; j < CMinesweeperSolver::NumberOfNeighbors; j++ ) {
+				const size_t next = variable + offsets[j];
+				if( solver.Knowledge( next ) == MSC_Opened
+					&& solver.NumberOfUnknownNeighbors( next ) > 0
+					&& ( inComponent[next] & ConstraintFlag ) == 0 )
+				{
+					inComponent[next] |= ConstraintFlag;
+					component.Constraints.push_back( next );
+				}
+			}
+		}
+	}
+
+	// the raster order makes the signature independent of the position
+	sort( component.Constraints.begin(), component.Constraints.end() );
+	sort( component.Variables.begin(), component.Variables.end() );
+}
+
+shared_ptr<const CMinesweeperProbability::CSolution> CMinesweeperProbability::solve(
+	const CMinesweeperSolver& solver, const CComponent& component )
+{
+	const ptrdiff_t* const offsets = solver.NeighborOffsets();
+	const vector<size_t>& variables = component.Variables;
+	const size_t numberOfVariables = variables.size();
+	const size_t numberOfConstraints = component.Constraints.size();
+
+	constraintsOfVariables.resize( numberOfVariables * CMinesweeperSolver::NumberOfNeighbors );
+	numberOfConstraintsOfVariables.assign( numberOfVariables, 0 );
+	remainingMines.resize( numberOfConstraints );
+	unassigned.resize( numberOfConstraints );
+
+	string signature;
+	appendNumber( signature, numberOfVariables );
+	for( size_t q = 0; q < numberOfConstraints; q++ ) {
+		const size_t constraint = component.Constraints[q];
+		remainingMines[q] = static_cast<ptrdiff_t>( solver.RemainingMines( constraint ) );
+		unassigned[q] = static_cast<ptrdiff_t>( solver.NumberOfUnknownNeighbors( constraint ) );
+		signature.push_back( static_cast<char>( remainingMines[q] ) );
+		signature.push_back( static_cast<char>( unassigned[q] ) );
+		for( size_t i = 0; i < CMinesweeperSolver::NumberOfNeighbors; i++ ) {
+			const size_t cell = constraint + offsets[i];
+			if( solver.Knowledge( cell ) != MSC_Unknown ) {
+				continue;
+			}
+			const size_t variable = lower_bound( variables.begin(), variables.end(), cell )
+				- variables.begin();
+			appendNumber( signature, variable );
+			constraintsOfVariables[variable * CMinesweeperSolver::NumberOfNeighbors
+				+ numberOfConstraintsOfVariables[variable]++] = q;
+		}
+	}
+
+	auto cached = cache.find( signature );
+	if( cached != cache.end() ) {
+		cacheHits++;
+		return cached->second;
+	}
+	cacheMisses++;
+
+	shared_ptr<CSolution> solution( new CSolution );
+	solution->Weights.assign( numberOfVariables + 1, 0 );
+	solution->MineWeights.assign( numberOfVariables * ( numberOfVariables + 1 ), 0 );
+	assignment.assign( numberOfVariables, 0 );
+	enumerate( 0, 0, *solution );
+
+	double total = 0;
+	for( auto i = solution->Weights.cbegin(); i != solution->Weights.cend(); ++i ) {
+		total += *i;
+	}
+	internal_check( total > 0 );
+	for( auto i = solution->Weights.begin(); i != solution->Weights.end(); ++i ) {
+		*i /= total;
+	}
+	for( auto i = solution->MineWeights.begin(); i != solution->MineWeights.end(); ++i ) {
+		*i /= total;
+	}
+
+	if( cache.size() >= MaxCacheSize ) {
+		cache.clear();
+	}
+	cache.insert( make_pair( move( signature ), solution ) );
+	return solution;
+}
+
+void CMinesweeperProbability::enumerate( size_t variable, size_t mines,
+	CSolution& solution )
+{
+	const size_t numberOfVariables = assignment.size();
+	if( variable == numberOfVariables ) {
+		solution.Weights[mines] += 1;
+		for( size_t v = 0; v < numberOfVariables; v++ ) {
+			if( assignment[v] != 0 ) {
+				solution.MineWeights[v * ( numberOfVariables + 1 ) + mines] += 1;
+			}
+		}
+		return;
+	}
+
+	for( int mine = 0; mine < 2; mine++ ) {
+		if( assign( variable, mine != 0 ) ) {
+			enumerate( variable + 1, mines + mine, solution );
+		}
+		unassign( variable, mine != 0 );
+	}
+}
+
+bool CMinesweeperProbability::assign( size_t variable, bool mine )
+{
+	assignment[variable] = mine ? 1 : 0;
+	const size_t* const constraints = constraintsOfVariables.data()
+		+ variable * CMinesweeperSolver::NumberOfNeighbors;
+	bool consistent = true;
+	for( size_t i = 0; i < numberOfConstraintsOfVariables[variable]; i++ ) {
+		const size_t q = constraints[i];
+		unassigned[q]--;
+		if( mine ) {
+			remainingMines[q]--;
+		}
+		consistent = consistent && remainingMines[q] >= 0
+			&& remainingMines[q] <= unassigned[q];
+	}
+	return consistent;
+}
+
+void CMinesweeperProbability::unassign( size_t variable, bool mine )
+{
+	assignment[variable] = 0;
+	const size_t* const constraints = constraintsOfVariables.data()
+		+ variable * CMinesweeperSolver::NumberOfNeighbors;
+	for( size_t i = 0; i < numberOfConstraintsOfVariables[variable]; i++ ) {
+		const size_t q = constraints[i];
+		unassigned[q]++;
+		if( mine ) {
+			remainingMines[q]++;
+		}
+	}
+}
+
+// Combination of the components
+// T[k] is the weight of frontier solutions with k mines (convolution of
+// the components), B[k] = C( interior, remaining - k ) is the number of
+// placements of the other mines in the interior, so
+// P( variable of the component c ) = sum over k of
+//     MineWeights[k] * sum over j of Others_c[j] * B[k + j] / sum of T[k] * B[k]
+// where Others_c is the convolution of all components except c
+
+void CMinesweeperProbability::combine( const CMinesweeperSolver& solver )
+{
+	// prefix and suffix convolutions of the components
+	vector<vector<double>> prefix( numberOfComponents + 1, vector<double>( 1, 1.0 ) );
+	vector<vector<double>> suffix( numberOfComponents + 1, vector<double>( 1, 1.0 ) );
+	size_t numberOfVariables = 0;
+	for( size_t c = 0; c < numberOfComponents; c++ ) {
+		prefix[c + 1] = convolve( prefix[c], components[c].Solution->Weights );
+		numberOfVariables += components[c].Variables.size();
+	}
+	for( size_t c = numberOfComponents; c > 0; c-- ) {
+		suffix[c - 1] = convolve( suffix[c], components[c - 1].Solution->Weights );
+	}
+	const vector<double>& total = prefix[numberOfComponents];
+
+	internal_check( solver.NumberOfMines() <= solver.Bombs() );
+	const size_t mines = solver.Bombs() - solver.NumberOfMines();
+	internal_check( numberOfVariables <= solver.NumberOfUnknownCells() );
+	const size_t interior = solver.NumberOfUnknownCells() - numberOfVariables;
+
+	// binomial weights relative to the maximum one,
+	// the interior has ( mines - k ) mines for k in [minK, maxK]
+	vector<double> binomials( total.size(), 0 );
+	const size_t minK = mines > interior ? mines - interior : 0;
+	const size_t maxK = min( mines, total.size() - 1 );
+	if( minK <= maxK ) {
+		const vector<double> logs = logBinomials( interior, mines - maxK, mines - minK );
+		const double maxLogBinomial = *max_element( logs.begin(), logs.end() );
+		for( size_t k = minK; k <= maxK; k++ ) {
+			binomials[k] = exp( logs[maxK - k] - maxLogBinomial );
+		}
+	}
+
+	double normalization = 0;
+	double interiorMines = 0;
+	for( size_t k = 0; k < total.size(); k++ ) {
+		const double weight = total[k] * binomials[k];
+		normalization += weight;
+		if( binomials[k] > 0 ) {
+			interiorMines += weight * ( mines - k );
+		}
+	}
+	internal_check( normalization > 0 );
+	interiorProbability = ( interior > 0 ) ? interiorMines / normalization / interior : 0;
+
+	for( size_t c = 0; c < numberOfComponents; c++ ) {
+		const CComponent& component = components[c];
+		const vector<double> others = convolve( prefix[c], suffix[c + 1] );
+		const size_t size = component.Variables.size();
+
+		vector<double> weights( size + 1, 0 );
+		for( size_t k = 0; k <= size; k++ ) {
+			for( size_t j = 0; j < others.size(); j++ ) {
+				weights[k] += others[j] * binomials[k + j];
+			}
+		}
+
+		for( size_t v = 0; v < size; v++ ) {
+			const double* const mineWeights = component.Solution->MineWeights.data()
+				+ v * ( size + 1 );
+			double probability = 0;
+			for( size_t k = 0; k <= size; k++ ) {
+				probability += mineWeights[k] * weights[k];
+			}
+			probabilities[component.Variables[v]] = probability / normalization;
+		}
+	}
+
+	for( size_t row = 0; row < rows; row++ ) {
+		for( size_t column = 0; column < columns; column++ ) {
+			const size_t index = solver.Index( row, column );
+			const TMinesweeperSolverCell knowledge = solver.Knowledge( index );
+			if( knowledge == MSC_Mine ) {
+				probabilities[index] = 1;
+			} else if( knowledge == MSC_Unknown ) {
+				inComponent[index] |= UnknownFlag;
+				if( ( inComponent[index] & VariableFlag ) == 0 ) {
+					probabilities[index] = interiorProbability;
+				}
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <MinesweeperSolver.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Exact bomb probabilities of closed cells
+// the unknown cells next to the frontier are split into independent
+// components (connected through common opened cells), every component
+// is enumerated by backtracking into the numbers of solutions for each
+// number of its mines, the components are combined with the interior
+// cells by the binomial weights of the remaining bombs,
+// the solutions are cached by the component signature (the shape of
+// its constraints and their remaining mines), so after a small change
+// of the board only the changed components are enumerated again
+class CMinesweeperProbability {
+public:
+	// the cache is cleared when it grows bigger
+	static const size_t MaxCacheSize = 1 << 16;
+
+	CMinesweeperProbability();
+	CMinesweeperProbability( const CMinesweeperProbability& ) = delete;
+	CMinesweeperProbability& operator=( const CMinesweeperProbability& ) = delete;
+
+	// calculates the probabilities for the current knowledge of the solver
+	// (call CMinesweeperSolver::Solve before for the best results)
+	void Calculate( const CMinesweeperSolver& solver );
+
+	// probability that the cell is a bomb (0 for opened and deduced safe cells)
+	double Probability( size_t row, size_t column ) const;
+	// probability of each cell which is not next to the frontier
+	double InteriorProbability() const { return interiorProbability; }
+	// the unknown cell with the minimum probability, false if there is none
+	bool SafestCell( size_t& row, size_t& column ) const;
+
+	size_t NumberOfComponents() const { return numberOfComponents; }
+	size_t CacheHits() const { return cacheHits; }
+	size_t CacheMisses() const { return cacheMisses; }
+	void ClearCache() { cache.clear(); }
+
+private:
+	// all solutions of a component (normalized to the total number of solutions)
+	struct CSolution {
+		// by number of mines in the component
+		vector<double> Weights;
+		// by variable and number of mines ( variable * ( variables + 1 ) + mines )
+		vector<double> MineWeights;
+	};
+
+	// a component being built and enumerated
+	struct CComponent {
+		vector<size_t> Constraints;
+		vector<size_t> Variables;
+		shared_ptr<const CSolution> Solution;
+	};
+
+	size_t rows;
+	size_t columns;
+	size_t stride;
+	size_t numberOfComponents;
+	size_t cacheHits;
+	size_t cacheMisses;
+	double interiorProbability;
+	vector<double> probabilities;
+	vector<uint8_t> inComponent;
+	vector<CComponent> components;
+	unordered_map<string, shared_ptr<const CSolution>> cache;
+	// enumeration state
+	vector<size_t> constraintsOfVariables; // NumberOfNeighbors per variable
+	vector<uint8_t> numberOfConstraintsOfVariables;
+	vector<ptrdiff_t> remainingMines;
+	vector<ptrdiff_t> unassigned;
+	vector<uint8_t> assignment;
+
+	void buildComponents( const CMinesweeperSolver& solver );
+	void buildComponent( const CMinesweeperSolver& solver, size_t start,
+		CComponent& component );
+	shared_ptr<const CSolution> solve( const CMinesweeperSolver& solver,
+		const CComponent& component );
+	void enumerate( size_t variable, size_t mines, CSolution& solution );
+	bool assign( size_t variable, bool mine );
+	void unassign( size_t variable, bool mine );
+	void combine( const CMinesweeperSolver& solver );
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
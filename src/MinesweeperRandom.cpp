@@ -0,0 +1,61 @@
+#include <atomic>
+#include <random>
+#include <MinesweeperRandom.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CMinesweeperRandom::Seed( uint64_t seed )
+{
+	// the state must not be all zeros, SplitMix64 outputs never are
+	for( size_t i = 0; i < 4; i++ ) {
+		seed += 0x9E3779B97F4A7C15ULL;
+		state[i] = MixSeed( seed );
+	}
+}
+
+// Lemire's multiply and shift for 32-bit bounds,
+// rejection of the incomplete last range otherwise
+uint64_t CMinesweeperRandom::Next( uint64_t bound )
+{
+	if( bound <= 0xFFFFFFFFULL ) {
+		const uint64_t threshold = ( 0x100000000ULL - bound ) % bound;
+		for( ;; ) {
+			const uint64_t product = ( ( *this )() >> 32 ) * bound;
+			if( ( product & 0xFFFFFFFFULL ) >= threshold ) {
+				return product >> 32;
+			}
+		}
+	}
+
+	const uint64_t limit = max() - max() % bound;
+	for( ;; ) {
+		const uint64_t value = ( *this )();
+		if( value < limit ) {
+			return value % bound;
+		}
+	}
+}
+
+uint64_t MixSeed( uint64_t seed )
+{
+	seed = ( seed ^ ( seed >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+	seed = ( seed ^ ( seed >> 27 ) ) * 0x94D049BB133111EBULL;
+	return seed ^ ( seed >> 31 );
+}
+
+uint64_t GenerateSeed()
+{
+	static atomic<uint64_t> counter( [] {
+		random_device randomDevice;
+		return ( static_cast<uint64_t>( randomDevice() ) << 32 ) ^ randomDevice();
+	}() );
+	return MixSeed( counter.fetch_add( 0x9E3779B97F4A7C15ULL, memory_order_relaxed ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
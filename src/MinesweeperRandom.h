@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <Minesweeper.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Fast seedable pseudo random generator (xoshiro256**)
+// meets the UniformRandomBitGenerator requirements so it can be plugged
+// into standard distributions as well as into SampleCells
+class CMinesweeperRandom {
+public:
+	typedef uint64_t result_type;
+
+	explicit CMinesweeperRandom( uint64_t seed = 0 ) { Seed( seed ); }
+
+	// reinitializes the generator, the same seed gives the same sequence
+	void Seed( uint64_t seed );
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return ~result_type( 0 ); }
+	result_type operator()();
+
+	// returns a uniformly distributed number in [0, bound)
+	uint64_t Next( uint64_t bound );
+
+private:
+	uint64_t state[4];
+};
+
+inline CMinesweeperRandom::result_type CMinesweeperRandom::operator()()
+{
+	const uint64_t result = state[1] * 5;
+	const uint64_t rotated = ( ( result << 7 ) | ( result >> 57 ) ) * 9;
+	const uint64_t shifted = state[1] << 17;
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= shifted;
+	state[3] = ( state[3] << 45 ) | ( state[3] >> 19 );
+	return rotated;
+}
+
+// splits the seed into well mixed values (SplitMix64 step)
+uint64_t MixSeed( uint64_t seed );
+
+// returns a new seed for a game, the std::random_device is
+// read only once per process, next seeds are derived from it
+uint64_t GenerateSeed();
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Chooses numberOfChosen distinct cells out of numberOfCells uniformly
+// in O( numberOfChosen ) random draws without rejection (Floyd's algorithm)
+// isChosen( cell ) must return whether the cell has been already chosen,
+// choose( cell ) is called once for every chosen cell
+template<typename TRandom, typename TIsChosen, typename TChoose>
+void SampleCells( TRandom& random, size_t numberOfCells, size_t numberOfChosen,
+	TIsChosen isChosen, TChoose choose )
+{
+	for( size_t last = numberOfCells - numberOfChosen; last < numberOfCells; last++ ) {
+		const size_t cell = static_cast<size_t>( random.Next( last + 1 ) );
+		choose( isChosen( cell ) ? last : cell );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
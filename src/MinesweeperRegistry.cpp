@@ -0,0 +1,113 @@
+#include <MinesweeperRegistry.h>
+#include <MinesweeperRandom.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t roundUpToPowerOfTwo( size_t number )
+{
+	size_t result = 1;
+	while( result < number ) {
+		result <<= 1;
+	}
+	return result;
+}
+
+CMinesweeperGameRegistry::CMinesweeperGameRegistry( size_t numberOfShards ) :
+	shardMask( roundUpToPowerOfTwo( numberOfShards ) - 1 ),
+	shards( shardMask + 1 ),
+	nextId( 1 )
+{
+}
+
+TMinesweeperGameId CMinesweeperGameRegistry::Create( size_t rows, size_t columns,
+	size_t bombs )
+{
+	return add( pool.Acquire( rows, columns, bombs ) );
+}
+
+TMinesweeperGameId CMinesweeperGameRegistry::Create( size_t rows, size_t columns,
+	size_t bombs, uint64_t seed )
+{
+	return add( pool.Acquire( rows, columns, bombs, seed ) );
+}
+
+bool CMinesweeperGameRegistry::Remove( TMinesweeperGameId id )
+{
+	CShard& idShard = shard( id );
+	lock_guard<mutex> lock( idShard.Lock );
+	return idShard.Sessions.erase( id ) > 0;
+}
+
+size_t CMinesweeperGameRegistry::Size() const
+{
+	size_t size = 0;
+	for( auto i = shards.cbegin(); i != shards.cend(); ++i ) {
+		lock_guard<mutex> lock( i->Lock );
+		size += i->Sessions.size();
+	}
+	return size;
+}
+
+shared_ptr<const CMinesweeperGameSnapshot> CMinesweeperGameRegistry::Snapshot(
+	TMinesweeperGameId id ) const
+{
+	const shared_ptr<CSession> session = find( id );
+	if( !session ) {
+		return shared_ptr<const CMinesweeperGameSnapshot>();
+	}
+	return atomic_load( &session->Published );
+}
+
+TMinesweeperGameId CMinesweeperGameRegistry::add( shared_ptr<IMinesweeperGame> game )
+{
+	const shared_ptr<CSession> session = make_shared<CSession>();
+	session->Game = game;
+	session->Version = 0;
+	session->Publish();
+
+	const TMinesweeperGameId id = nextId.fetch_add( 1, memory_order_relaxed );
+	CShard& idShard = shard( id );
+	lock_guard<mutex> lock( idShard.Lock );
+	idShard.Sessions.emplace( id, session );
+	return id;
+}
+
+shared_ptr<CMinesweeperGameRegistry::CSession> CMinesweeperGameRegistry::find(
+	TMinesweeperGameId id ) const
+{
+	const CShard& idShard = shard( id );
+	lock_guard<mutex> lock( idShard.Lock );
+	auto i = idShard.Sessions.find( id );
+	return i != idShard.Sessions.end() ? i->second : shared_ptr<CSession>();
+}
+
+// consecutive ids go to different shards
+CMinesweeperGameRegistry::CShard& CMinesweeperGameRegistry::shard( TMinesweeperGameId id )
+{
+	return shards[static_cast<size_t>( MixSeed( id ) ) & shardMask];
+}
+
+const CMinesweeperGameRegistry::CShard& CMinesweeperGameRegistry::shard(
+	TMinesweeperGameId id ) const
+{
+	return const_cast<CMinesweeperGameRegistry&>( *this ).shard( id );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CMinesweeperGameRegistry::CSession::Publish()
+{
+	const shared_ptr<CMinesweeperGameSnapshot> snapshot =
+		make_shared<CMinesweeperGameSnapshot>();
+	snapshot->Version = Version++;
+	Game->Serialize( snapshot->Data );
+	atomic_store( &Published, shared_ptr<const CMinesweeperGameSnapshot>( snapshot ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
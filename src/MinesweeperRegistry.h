@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <Minesweeper.h>
+#include <MinesweeperCommon.h>
+#include <MinesweeperGamePool.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef uint64_t TMinesweeperGameId;
+
+// Published state of a game, never changed after its publication
+struct CMinesweeperGameSnapshot {
+	// the number of writes to the game before the snapshot
+	uint64_t Version;
+	// the packed snapshot of the game (MinesweeperSnapshot.h)
+	vector<uint8_t> Data;
+};
+
+// Server side registry of games
+// the games are spread over lock striped shards, a shard lock is held
+// only to find, add or remove a session, so sessions of different games
+// never wait for each other,
+// every game has a single writer at a time, a write publishes a new
+// versioned snapshot of the game, readers load published snapshots
+// and never wait for writers, the games are taken from the pool
+// of the registry and return to it once removed and no longer written
+class CMinesweeperGameRegistry {
+public:
+	static const size_t DefaultNumberOfShards = 256;
+
+	// the number of shards is rounded up to a power of two
+	explicit CMinesweeperGameRegistry( size_t numberOfShards = DefaultNumberOfShards );
+	CMinesweeperGameRegistry( const CMinesweeperGameRegistry& ) = delete;
+	CMinesweeperGameRegistry& operator=( const CMinesweeperGameRegistry& ) = delete;
+
+	// creates a new game (throw an exception if failed)
+	TMinesweeperGameId Create( size_t rows, size_t columns, size_t bombs );
+	TMinesweeperGameId Create( size_t rows, size_t columns, size_t bombs, uint64_t seed );
+	// returns false if there is no such game
+	bool Remove( TMinesweeperGameId id );
+	// number of games in the registry
+	size_t Size() const;
+
+	// calls action( game ) being the only writer of the game,
+	// the modified cells of the game are polled by the action as usual,
+	// then the new state is published, returns false if there is no such game
+	template<typename TAction>
+	bool Write( TMinesweeperGameId id, TAction action );
+
+	// returns the last published snapshot, empty if there is no such game
+	shared_ptr<const CMinesweeperGameSnapshot> Snapshot( TMinesweeperGameId id ) const;
+
+private:
+	struct CSession {
+		mutex Writer;
+		shared_ptr<IMinesweeperGame> Game;
+		uint64_t Version;
+		// accessed only by atomic_load and atomic_store
+		shared_ptr<const CMinesweeperGameSnapshot> Published;
+
+		void Publish();
+	};
+
+	struct CShard {
+		mutable mutex Lock;
+		unordered_map<TMinesweeperGameId, shared_ptr<CSession>> Sessions;
+		// keeps locks of neighbor shards in different cache lines
+		char Padding[64];
+	};
+
+	const size_t shardMask;
+	vector<CShard> shards;
+	atomic<TMinesweeperGameId> nextId;
+	CMinesweeperGamePool pool;
+
+	TMinesweeperGameId add( shared_ptr<IMinesweeperGame> game );
+	shared_ptr<CSession> find( TMinesweeperGameId id ) const;
+	CShard& shard( TMinesweeperGameId id );
+	const CShard& shard( TMinesweeperGameId id ) const;
+};
+
+template<typename TAction>
+bool CMinesweeperGameRegistry::Write( TMinesweeperGameId id, TAction action )
+{
+	const shared_ptr<CSession> session = find( id );
+	if( !session ) {
+		return false;
+	}
+
+	lock_guard<mutex> lock( session->Writer );
+	// the state is published even if the action failed halfway
+	try {
+		action( *session->Game );
+	} catch( ... ) {
+		session->Publish();
+		throw;
+	}
+	session->Publish();
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
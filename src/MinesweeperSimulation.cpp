@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <MinesweeperSimulation.h>
+#include <MinesweeperSolver.h>
+#include <MinesweeperProbability.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperSimulationStatistics::CMinesweeperSimulationStatistics() :
+	Games( 0 ),
+	Wins( 0 ),
+	Losses( 0 ),
+	Clicks( 0 )
+{
+	fill( Cascades, Cascades + NumberOfCascadeBuckets, 0 );
+}
+
+void CMinesweeperSimulationStatistics::Add( const CMinesweeperSimulationStatistics& other )
+{
+	Games += other.Games;
+	Wins += other.Wins;
+	Losses += other.Losses;
+	Clicks += other.Clicks;
+	for( size_t i = 0; i < NumberOfCascadeBuckets; i++ ) {
+		Cascades[i] += other.Cascades[i];
+	}
+}
+
+void CMinesweeperSimulationStatistics::AddClick( size_t numberOfOpenedCells )
+{
+	size_t bucket = 0;
+	while( numberOfOpenedCells > 0 && bucket + 1 < NumberOfCascadeBuckets ) {
+		numberOfOpenedCells >>= 1;
+		bucket++;
+	}
+	Clicks++;
+	Cascades[bucket]++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperPlayer::CMinesweeperPlayer( IMinesweeperGame& _game,
+		CMinesweeperRandom& _random, CMinesweeperSimulationStatistics& _statistics ) :
+	game( _game ),
+	random( _random ),
+	statistics( _statistics )
+{
+}
+
+void CMinesweeperPlayer::Open( size_t row, size_t column )
+{
+	const size_t numberOfOpenedCells = game.NumberOfOpenedCells();
+	game.Cell( row, column )->Open();
+	statistics.AddClick( game.NumberOfOpenedCells() - numberOfOpenedCells );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// the cells are visited in a random order, the opened cells are skipped,
+// so every click opens a random closed cell in O( 1 )
+class CRandomStrategy : public IMinesweeperStrategy {
+public:
+	virtual void Play( CMinesweeperPlayer& player );
+
+private:
+	vector<size_t> cells;
+};
+
+void CRandomStrategy::Play( CMinesweeperPlayer& player )
+{
+	IMinesweeperGame& game = player.Game();
+	const size_t columns = game.Columns();
+	cells.resize( game.Rows() * columns );
+	for( size_t i = 0; i < cells.size(); i++ ) {
+		cells[i] = i;
+	}
+
+	for( size_t i = 0; i < cells.size() && game.GameState() == MGS_Active; i++ ) {
+		swap( cells[i], cells[i + player.Random().Next( cells.size() - i )] );
+		const IMinesweeperCell* const cell = game.Cell( cells[i] / columns, cells[i] % columns );
+		if( !cell->IsOpened() && cell->Label() == MCL_None ) {
+			player.Open( cells[i] / columns, cells[i] % columns );
+		}
+	}
+}
+
+// the same as the player of main()
+class CSolverStrategy : public IMinesweeperStrategy {
+public:
+	virtual void Play( CMinesweeperPlayer& player );
+
+private:
+	CMinesweeperSolver solver;
+	CMinesweeperProbability probability;
+	vector<pair<size_t, size_t>> modifiedCells;
+};
+
+void CSolverStrategy::Play( CMinesweeperPlayer& player )
+{
+	IMinesweeperGame& game = player.Game();
+	game.ModifiedCells( modifiedCells );
+	solver.Reset( game );
+	while( game.GameState() == MGS_Active ) {
+		size_t row;
+		size_t column;
+		solver.Solve();
+		if( !solver.NextSafeCell( row, column ) ) {
+			probability.Calculate( solver );
+			if( !probability.SafestCell( row, column ) ) {
+				break;
+			}
+		}
+		player.Open( row, column );
+		game.ModifiedCells( modifiedCells );
+		solver.Update( game, modifiedCells );
+	}
+}
+
+} // end of anonymous namespace
+
+unique_ptr<IMinesweeperStrategy> CreateRandomStrategy()
+{
+	return unique_ptr<IMinesweeperStrategy>( new CRandomStrategy );
+}
+
+unique_ptr<IMinesweeperStrategy> CreateSolverStrategy()
+{
+	return unique_ptr<IMinesweeperStrategy>( new CSolverStrategy );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperSimulation::CMinesweeperSimulation( size_t _numberOfThreads ) :
+	numberOfThreads( _numberOfThreads > 0 ? _numberOfThreads
+		: max<size_t>( thread::hardware_concurrency(), 1 ) ),
+	numberOfSteals( 0 ),
+	failed( false )
+{
+	workers.reserve( numberOfThreads );
+	for( size_t i = 0; i < numberOfThreads; i++ ) {
+		workers.emplace_back( new CWorker );
+	}
+}
+
+void CMinesweeperSimulation::Run(
+	const vector<CMinesweeperSimulationConfiguration>& configurations,
+	const TMinesweeperStrategyFactory& strategy,
+	vector<CMinesweeperSimulationStatistics>& statistics )
+{
+	// the tasks are dealt to the workers in turn
+	size_t next = 0;
+	for( size_t c = 0; c < configurations.size(); c++ ) {
+		for( size_t first = 0; first < configurations[c].NumberOfGames; first += GamesPerTask ) {
+			const CTask task = { c, first,
+				min( first + GamesPerTask, configurations[c].NumberOfGames ) };
+			workers[next]->Tasks.push_back( task );
+			next = ( next + 1 ) % numberOfThreads;
+		}
+	}
+	for( auto i = workers.begin(); i != workers.end(); ++i ) {
+		( *i )->Statistics.assign( configurations.size(), CMinesweeperSimulationStatistics() );
+		( *i )->NumberOfSteals = 0;
+	}
+	failed = false;
+
+	vector<exception_ptr> errors( numberOfThreads );
+	const auto run = [&]( size_t index ) {
+		try {
+			work( index, configurations, strategy );
+		} catch( ... ) {
+			errors[index] = current_exception();
+			failed = true;
+		}
+	};
+	vector<thread> threads;
+	threads.reserve( numberOfThreads - 1 );
+	for( size_t i = 1; i < numberOfThreads; i++ ) {
+		threads.emplace_back( run, i );
+	}
+	// the calling thread is the first worker
+	run( 0 );
+	for( auto i = threads.begin(); i != threads.end(); ++i ) {
+		i->join();
+	}
+
+	numberOfSteals = 0;
+	statistics.assign( configurations.size(), CMinesweeperSimulationStatistics() );
+	for( auto i = workers.begin(); i != workers.end(); ++i ) {
+		( *i )->Tasks.clear();
+		numberOfSteals += ( *i )->NumberOfSteals;
+		for( size_t c = 0; c < configurations.size(); c++ ) {
+			statistics[c].Add( ( *i )->Statistics[c] );
+		}
+	}
+	for( auto i = errors.cbegin(); i != errors.cend(); ++i ) {
+		if( *i ) {
+			rethrow_exception( *i );
+		}
+	}
+}
+
+// the game is created again only if the configuration needs another kind
+// of game (flat or tiled), otherwise NewGame reuses the game storage
+void CMinesweeperSimulation::work( size_t index,
+	const vector<CMinesweeperSimulationConfiguration>& configurations,
+	const TMinesweeperStrategyFactory& strategy )
+{
+	CWorker& worker = *workers[index];
+	const CMinesweeperSizePolicy policy = UnlimitedSizePolicy();
+	unique_ptr<IMinesweeperStrategy> workerStrategy = strategy();
+	shared_ptr<IMinesweeperGame> game;
+	bool isTiled = false;
+	CMinesweeperRandom random;
+
+	CTask task;
+	while( !failed.load( memory_order_relaxed ) ) {
+		if( !pop( worker, task ) ) {
+			// the victims are tried in turn starting from the next worker
+			bool stolen = false;
+			for( size_t i = 1; i < numberOfThreads && !stolen; i++ ) {
+				stolen = steal( *workers[( index + i ) % numberOfThreads], task );
+			}
+			if( !stolen ) {
+				// no task is added during the run, so all tasks are taken
+				return;
+			}
+			worker.NumberOfSteals++;
+		}
+
+		const CMinesweeperSimulationConfiguration& configuration =
+			configurations[task.Configuration];
+		CMinesweeperSimulationStatistics& statistics = worker.Statistics[task.Configuration];
+		const bool tiled = configuration.Rows * configuration.Columns > policy.MaxFlatCells;
+		if( !game || tiled != isTiled ) {
+			game = CreateGame( configuration.Rows, configuration.Columns,
+				configuration.Bombs, policy );
+			isTiled = tiled;
+		}
+		if( game->FirstClick() != configuration.FirstClick ) {
+			game->SetFirstClick( configuration.FirstClick );
+		}
+
+		CMinesweeperPlayer player( *game, random, statistics );
+		for( size_t i = task.FirstGame; i < task.EndGame; i++ ) {
+			const uint64_t seed = configuration.Seed ^ MixSeed( i );
+			game->NewGame( configuration.Rows, configuration.Columns,
+				configuration.Bombs, seed );
+			random.Seed( MixSeed( seed ) );
+			workerStrategy->Play( player );
+
+			statistics.Games++;
+			if( game->GameState() == MGS_Success ) {
+				statistics.Wins++;
+			} else if( game->GameState() == MGS_Failure ) {
+				statistics.Losses++;
+			}
+		}
+	}
+}
+
+bool CMinesweeperSimulation::pop( CWorker& worker, CTask& task )
+{
+	lock_guard<mutex> guard( worker.Lock );
+	if( worker.Tasks.empty() ) {
+		return false;
+	}
+	task = worker.Tasks.back();
+	worker.Tasks.pop_back();
+	return true;
+}
+
+bool CMinesweeperSimulation::steal( CWorker& victim, CTask& task )
+{
+	lock_guard<mutex> guard( victim.Lock );
+	if( victim.Tasks.empty() ) {
+		return false;
+	}
+	task = victim.Tasks.front();
+	victim.Tasks.pop_front();
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <Minesweeper.h>
+#include <MinesweeperRandom.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Games of a configuration of a simulation
+// the game i is planted from the seed ( Seed ^ MixSeed( i ) )
+struct CMinesweeperSimulationConfiguration {
+	size_t Rows;
+	size_t Columns;
+	size_t Bombs;
+	TMinesweeperFirstClick FirstClick;
+	uint64_t Seed;
+	size_t NumberOfGames;
+};
+
+// Aggregates of the games of a configuration
+struct CMinesweeperSimulationStatistics {
+	// the bucket 0 counts clicks which open no safe cell (losing clicks
+	// among them), the bucket b > 0
+	// counts clicks which open [2^(b-1), 2^b) cells, the last bucket
+	// counts all bigger cascades
+	static const size_t NumberOfCascadeBuckets = 16;
+
+	// the games which are neither won nor lost are given up by the strategy
+	uint64_t Games;
+	uint64_t Wins;
+	uint64_t Losses;
+	// opens made by the strategy (including the opens of neighbors)
+	uint64_t Clicks;
+	uint64_t Cascades[NumberOfCascadeBuckets];
+
+	CMinesweeperSimulationStatistics();
+	void Add( const CMinesweeperSimulationStatistics& other );
+	// records the click which opened the number of cells
+	void AddClick( size_t numberOfOpenedCells );
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The game of a worker as seen by strategies
+// the cells are opened through the player, so the clicks are counted
+class CMinesweeperPlayer {
+public:
+	CMinesweeperPlayer( IMinesweeperGame& game, CMinesweeperRandom& random,
+		CMinesweeperSimulationStatistics& statistics );
+
+	IMinesweeperGame& Game() const { return game; }
+	// the random generator of the game, it is seeded from the game seed
+	CMinesweeperRandom& Random() const { return random; }
+
+	// opens the cell and records the click
+	void Open( size_t row, size_t column );
+
+private:
+	IMinesweeperGame& game;
+	CMinesweeperRandom& random;
+	CMinesweeperSimulationStatistics& statistics;
+};
+
+// Strategy of playing games, every worker has its own strategy instance
+class IMinesweeperStrategy {
+public:
+	// destructor
+	virtual ~IMinesweeperStrategy() {}
+
+	// plays the new game until it ends or the strategy gives up
+	virtual void Play( CMinesweeperPlayer& player ) = 0;
+};
+
+typedef function<unique_ptr<IMinesweeperStrategy>()> TMinesweeperStrategyFactory;
+
+// opens random closed cells which are not labeled
+unique_ptr<IMinesweeperStrategy> CreateRandomStrategy();
+// opens the cells deduced by the solver, at a guess opens the cell with
+// the lowest bomb probability (MinesweeperSolver.h, MinesweeperProbability.h)
+unique_ptr<IMinesweeperStrategy> CreateSolverStrategy();
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Parallel simulation runner over a work stealing pool of workers
+// the games of all configurations are split into tasks of GamesPerTask games,
+// every worker has a deque of tasks, pops its own tasks from the back
+// and steals tasks of others from the front when its deque is empty,
+// every worker keeps one game and one strategy for all its games
+// and its own aggregates, which are merged once all tasks are done,
+// the games are planted and randomized by their seeds only, so the results
+// do not depend on the number of threads or on the order of the tasks
+class CMinesweeperSimulation {
+public:
+	static const size_t GamesPerTask = 64;
+
+	// zero number of threads means the number of hardware threads
+	explicit CMinesweeperSimulation( size_t numberOfThreads = 0 );
+	CMinesweeperSimulation( const CMinesweeperSimulation& ) = delete;
+	CMinesweeperSimulation& operator=( const CMinesweeperSimulation& ) = delete;
+
+	size_t NumberOfThreads() const { return numberOfThreads; }
+	// number of tasks taken from other workers by the last run
+	size_t NumberOfSteals() const { return numberOfSteals; }
+
+	// plays all games of the configurations, the statistics[i] are
+	// the aggregates of the configuration i (throw an exception if failed)
+	void Run( const vector<CMinesweeperSimulationConfiguration>& configurations,
+		const TMinesweeperStrategyFactory& strategy,
+		vector<CMinesweeperSimulationStatistics>& statistics );
+
+private:
+	// games [FirstGame, EndGame) of the configuration
+	struct CTask {
+		size_t Configuration;
+		size_t FirstGame;
+		size_t EndGame;
+	};
+
+	// the workers are allocated one by one and padded,
+	// so the hot fields of workers never share a cache line
+	struct CWorker {
+		mutex Lock;
+		deque<CTask> Tasks;
+		vector<CMinesweeperSimulationStatistics> Statistics;
+		size_t NumberOfSteals;
+		char Padding[64];
+	};
+
+	const size_t numberOfThreads;
+	size_t numberOfSteals;
+	vector<unique_ptr<CWorker>> workers;
+	// set by the first failed worker, so others stop
+	atomic<bool> failed;
+
+	void work( size_t index,
+		const vector<CMinesweeperSimulationConfiguration>& configurations,
+		const TMinesweeperStrategyFactory& strategy );
+	static bool pop( CWorker& worker, CTask& task );
+	static bool steal( CWorker& victim, CTask& task );
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
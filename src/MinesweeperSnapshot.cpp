@@ -0,0 +1,208 @@
+#include <MinesweeperSnapshot.h>
+#include <MinesweeperBits.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t SnapshotSize( size_t rows, size_t columns )
+{
+	const size_t numberOfCells = rows * columns;
+	const size_t maskWords = ( numberOfCells + 63 ) / 64;
+	const size_t labelWords = ( numberOfCells + 31 ) / 32;
+	return sizeof( CMinesweeperSnapshotHeader )
+		+ ( 2 * maskWords + labelWords ) * sizeof( uint64_t );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperSnapshotView::CMinesweeperSnapshotView() :
+	header( nullptr ),
+	bombs( nullptr ),
+	opened( nullptr ),
+	labels( nullptr )
+{
+}
+
+CMinesweeperSnapshotView::CMinesweeperSnapshotView( const void* data, size_t size )
+{
+	// the words are read in place
+	internal_check( data != nullptr );
+	internal_check( reinterpret_cast<uintptr_t>( data ) % sizeof( uint64_t ) == 0 );
+	internal_check( size >= sizeof( CMinesweeperSnapshotHeader ) );
+
+	header = static_cast<const CMinesweeperSnapshotHeader*>( data );
+	internal_check( header->Magic == CMinesweeperSnapshotHeader::SnapshotMagic );
+	internal_check( header->Version == CMinesweeperSnapshotHeader::CurrentVersion );
+	internal_check( header->HeaderSize == sizeof( CMinesweeperSnapshotHeader ) );
+	internal_check( header->State <= MGS_Success );
+	internal_check( header->PendingFirstClick <= MFC_Opening );
+	internal_check( size_t( header->Bombs ) <= size_t( header->Rows ) * header->Columns );
+	internal_check( Size() <= size );
+
+	const size_t numberOfCells = Rows() * Columns();
+	const size_t maskWords = ( numberOfCells + 63 ) / 64;
+	bombs = reinterpret_cast<const uint64_t*>( header + 1 );
+	opened = bombs + maskWords;
+	labels = opened + maskWords;
+
+	// the whole board is checked, so the snapshot can be restored
+	// without failing half way
+	if( numberOfCells % 64 != 0 ) {
+		internal_check( ( bombs[maskWords - 1] >> ( numberOfCells % 64 ) ) == 0 );
+	}
+	size_t numberOfBombs = 0;
+	bool hasOpened = false;
+	for( size_t i = 0; i < maskWords; i++ ) {
+		numberOfBombs += PopulationCount( bombs[i] );
+		hasOpened = hasOpened || opened[i] != 0;
+	}
+	if( PendingFirstClick() == MFC_Any ) {
+		internal_check( numberOfBombs == Bombs() );
+	} else {
+		// nothing is opened before the bombs are planted
+		internal_check( numberOfBombs == 0 && !hasOpened );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperSnapshotFile::CMinesweeperSnapshotFile() :
+	data( nullptr ),
+	size( 0 ),
+	recordSize( 0 )
+#ifdef _WIN32
+	,
+	file( INVALID_HANDLE_VALUE ),
+	mapping( nullptr )
+#endif
+{
+}
+
+CMinesweeperSnapshotFile::~CMinesweeperSnapshotFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+void CMinesweeperSnapshotFile::Open( const string& path )
+{
+	Close();
+	file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+	internal_check( file != INVALID_HANDLE_VALUE );
+
+	LARGE_INTEGER fileSize;
+	if( !GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart == 0 ) {
+		Close();
+		internal_check( false );
+	}
+	size = static_cast<size_t>( fileSize.QuadPart );
+
+	mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if( mapping != nullptr ) {
+		data = static_cast<const uint8_t*>( MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) );
+	}
+	if( data == nullptr ) {
+		Close();
+		internal_check( false );
+	}
+	recordSize = SnapshotAt( 0 ).Size();
+}
+
+void CMinesweeperSnapshotFile::Close()
+{
+	if( data != nullptr ) {
+		UnmapViewOfFile( data );
+	}
+	if( mapping != nullptr ) {
+		CloseHandle( mapping );
+	}
+	if( file != INVALID_HANDLE_VALUE ) {
+		CloseHandle( file );
+	}
+	data = nullptr;
+	size = 0;
+	recordSize = 0;
+	file = INVALID_HANDLE_VALUE;
+	mapping = nullptr;
+}
+
+#else // _WIN32
+
+void CMinesweeperSnapshotFile::Open( const string& path )
+{
+	Close();
+	const int file = open( path.c_str(), O_RDONLY );
+	internal_check( file >= 0 );
+
+	struct stat status;
+	if( fstat( file, &status ) != 0 || status.st_size == 0 ) {
+		close( file );
+		internal_check( false );
+	}
+
+	void* const memory = mmap( nullptr, static_cast<size_t>( status.st_size ),
+		PROT_READ, MAP_SHARED, file, 0 );
+	// the mapping keeps the file
+	close( file );
+	internal_check( memory != MAP_FAILED );
+
+	data = static_cast<const uint8_t*>( memory );
+	size = static_cast<size_t>( status.st_size );
+	recordSize = SnapshotAt( 0 ).Size();
+}
+
+void CMinesweeperSnapshotFile::Close()
+{
+	if( data != nullptr ) {
+		munmap( const_cast<uint8_t*>( data ), size );
+	}
+	data = nullptr;
+	size = 0;
+	recordSize = 0;
+}
+
+#endif // _WIN32
+
+CMinesweeperSnapshotView CMinesweeperSnapshotFile::SnapshotAt( size_t offset ) const
+{
+	internal_check( offset < size );
+	return CMinesweeperSnapshotView( data + offset, size - offset );
+}
+
+size_t CMinesweeperSnapshotFile::NextOffset( size_t offset ) const
+{
+	return offset + SnapshotAt( offset ).Size();
+}
+
+size_t CMinesweeperSnapshotFile::NumberOfSnapshots() const
+{
+	return ( recordSize == 0 ) ? 0 : size / recordSize;
+}
+
+CMinesweeperSnapshotView CMinesweeperSnapshotFile::Snapshot( size_t index ) const
+{
+	internal_check( index < NumberOfSnapshots() );
+	const CMinesweeperSnapshotView snapshot = SnapshotAt( index * recordSize );
+	internal_check( snapshot.Size() == recordSize );
+	return snapshot;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <Minesweeper.h>
+#include <MinesweeperCommon.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Packed binary snapshot of a board (format version 1)
+// the header is followed by three arrays of 64-bit words:
+// - the bomb mask, a bit per cell i = ( row * columns + column ),
+//   the bit ( i % 64 ) of the word ( i / 64 )
+// - the opened mask, the same layout
+// - the labels, 2 bits per cell, the bits ( 2 * ( i % 32 ) ) of the word ( i / 32 )
+// all fields are little endian and every snapshot takes a multiple
+// of 8 bytes, so a file of snapshots can be read in place when mapped
+struct CMinesweeperSnapshotHeader {
+	static const uint32_t SnapshotMagic = 0x4E53534D; // "MSSN"
+	static const uint16_t CurrentVersion = 1;
+
+	uint32_t Magic;
+	uint16_t Version;
+	uint16_t HeaderSize;
+	uint32_t Rows;
+	uint32_t Columns;
+	uint32_t Bombs;
+	uint8_t State; // TMinesweeperGameState
+	// TMinesweeperFirstClick, the bombs are planted by the first open
+	// and the bomb mask is empty unless MFC_Any
+	uint8_t PendingFirstClick;
+	uint8_t Reserved[2];
+	uint64_t Seed;
+};
+
+static_assert( sizeof( CMinesweeperSnapshotHeader ) == 32,
+	"the snapshot header must be packed" );
+
+// size of a snapshot of the board in bytes
+size_t SnapshotSize( size_t rows, size_t columns );
+
+// Read only view of a snapshot in memory (nothing is copied)
+// the cells are accessible regardless of their state, unlike IMinesweeperCell
+class CMinesweeperSnapshotView {
+public:
+	CMinesweeperSnapshotView();
+	// checks the snapshot at data (throw an exception if it is invalid),
+	// the bomb mask has the bombs of the header, nothing is set
+	// in the masks of a pending first click
+	CMinesweeperSnapshotView( const void* data, size_t size );
+
+	// size of the snapshot in bytes
+	size_t Size() const { return SnapshotSize( Rows(), Columns() ); }
+	const CMinesweeperSnapshotHeader& Header() const { return *header; }
+	size_t Rows() const { return header->Rows; }
+	size_t Columns() const { return header->Columns; }
+	size_t Bombs() const { return header->Bombs; }
+	uint64_t Seed() const { return header->Seed; }
+	TMinesweeperGameState GameState() const;
+	TMinesweeperFirstClick PendingFirstClick() const;
+
+	bool IsBomb( size_t row, size_t column ) const;
+	bool IsOpened( size_t row, size_t column ) const;
+	TMinesweeperCellLabel Label( size_t row, size_t column ) const;
+
+	// the masks for engines
+	const uint64_t* BombMask() const { return bombs; }
+	const uint64_t* OpenedMask() const { return opened; }
+	const uint64_t* Labels() const { return labels; }
+
+private:
+	const CMinesweeperSnapshotHeader* header;
+	const uint64_t* bombs;
+	const uint64_t* opened;
+	const uint64_t* labels;
+
+	size_t cell( size_t row, size_t column ) const;
+};
+
+inline TMinesweeperGameState CMinesweeperSnapshotView::GameState() const
+{
+	return static_cast<TMinesweeperGameState>( header->State );
+}
+
+inline TMinesweeperFirstClick CMinesweeperSnapshotView::PendingFirstClick() const
+{
+	return static_cast<TMinesweeperFirstClick>( header->PendingFirstClick );
+}
+
+inline size_t CMinesweeperSnapshotView::cell( size_t row, size_t column ) const
+{
+	internal_check( row < Rows() && column < Columns() );
+	return row * Columns() + column;
+}
+
+inline bool CMinesweeperSnapshotView::IsBomb( size_t row, size_t column ) const
+{
+	const size_t i = cell( row, column );
+	return ( ( bombs[i / 64] >> ( i % 64 ) ) & 1 ) != 0;
+}
+
+inline bool CMinesweeperSnapshotView::IsOpened( size_t row, size_t column ) const
+{
+	const size_t i = cell( row, column );
+	return ( ( opened[i / 64] >> ( i % 64 ) ) & 1 ) != 0;
+}
+
+inline TMinesweeperCellLabel CMinesweeperSnapshotView::Label( size_t row, size_t column ) const
+{
+	const size_t i = cell( row, column );
+	return static_cast<TMinesweeperCellLabel>( ( labels[i / 32] >> ( 2 * ( i % 32 ) ) ) & 3 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Appends the snapshot of the board with the header to the buffer
+// the cells are taken by functions of ( row, column )
+template<typename TIsBomb, typename TIsOpened, typename TLabel>
+void WriteSnapshot( const CMinesweeperSnapshotHeader& header,
+	TIsBomb isBomb, TIsOpened isOpened, TLabel label, vector<uint8_t>& buffer );
+
+// Read only memory mapped file of snapshots written one after another
+class CMinesweeperSnapshotFile {
+public:
+	CMinesweeperSnapshotFile();
+	~CMinesweeperSnapshotFile();
+	CMinesweeperSnapshotFile( const CMinesweeperSnapshotFile& ) = delete;
+	CMinesweeperSnapshotFile& operator=( const CMinesweeperSnapshotFile& ) = delete;
+
+	// maps the whole file (throw an exception if failed)
+	void Open( const string& path );
+	void Close();
+
+	const uint8_t* Data() const { return data; }
+	size_t Size() const { return size; }
+
+	// the snapshot at the offset in the file and the offset of the next one
+	CMinesweeperSnapshotView SnapshotAt( size_t offset ) const;
+	size_t NextOffset( size_t offset ) const;
+	// random access for files of snapshots of the same size
+	// (the size is taken from the first snapshot)
+	size_t NumberOfSnapshots() const;
+	CMinesweeperSnapshotView Snapshot( size_t index ) const;
+
+private:
+	const uint8_t* data;
+	size_t size;
+	size_t recordSize;
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// packs values of all cells into words, bitsPerCell must divide 64
+template<typename TValue>
+void WriteSnapshotWords( uint8_t*& target, size_t rows, size_t columns,
+	unsigned bitsPerCell, TValue value )
+{
+	uint64_t word = 0;
+	unsigned bit = 0;
+	for( size_t row = 0; row < rows; row++ ) {
+		for( size_t column = 0; column < columns; column++ ) {
+			word |= uint64_t( value( row, column ) ) << bit;
+			bit += bitsPerCell;
+			if( bit == 64 ) {
+				memcpy( target, &word, sizeof( word ) );
+				target += sizeof( word );
+				word = 0;
+				bit = 0;
+			}
+		}
+	}
+	if( bit > 0 ) {
+		memcpy( target, &word, sizeof( word ) );
+		target += sizeof( word );
+	}
+}
+
+template<typename TIsBomb, typename TIsOpened, typename TLabel>
+void WriteSnapshot( const CMinesweeperSnapshotHeader& header,
+	TIsBomb isBomb, TIsOpened isOpened, TLabel label, vector<uint8_t>& buffer )
+{
+	const size_t offset = buffer.size();
+	buffer.resize( offset + SnapshotSize( header.Rows, header.Columns ) );
+	uint8_t* target = buffer.data() + offset;
+	memcpy( target, &header, sizeof( header ) );
+	target += sizeof( header );
+
+	// the words are copied one by one, the buffer may be not aligned
+	WriteSnapshotWords( target, header.Rows, header.Columns, 1,
+		[&isBomb]( size_t row, size_t column ) { return isBomb( row, column ) ? 1 : 0; } );
+	WriteSnapshotWords( target, header.Rows, header.Columns, 1,
+		[&isOpened]( size_t row, size_t column ) { return isOpened( row, column ) ? 1 : 0; } );
+	WriteSnapshotWords( target, header.Rows, header.Columns, 2,
+		[&label]( size_t row, size_t column ) { return static_cast<unsigned>( label( row, column ) ) & 3; } );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
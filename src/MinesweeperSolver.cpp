@@ -0,0 +1,400 @@
+#include <algorithm>
+#include <MinesweeperSolver.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperSolver::CMinesweeperSolver() :
+	rows( 0 ),
+	columns( 0 ),
+	bombs( 0 ),
+	seed( 0 ),
+	stride( 0 ),
+	numberOfMines( 0 ),
+	numberOfUnknownCells( 0 ),
+	queueHead( 0 )
+{
+	fill( neighborOffsets, neighborOffsets + NumberOfNeighbors, 0 );
+	fill( partnerOffsets, partnerOffsets + NumberOfPartners, 0 );
+}
+
+void CMinesweeperSolver::Reset( const IMinesweeperGame& game )
+{
+	reset( game.Rows(), game.Columns(), game.Bombs() );
+	seed = game.Seed();
+	for( size_t row = 0; row < rows; row++ ) {
+		for( size_t column = 0; column < columns; column++ ) {
+			update( game, row, column );
+		}
+	}
+}
+
+void CMinesweeperSolver::Update( const IMinesweeperGame& game,
+	const vector<pair<size_t, size_t>>& modifiedCells )
+{
+	if( game.Rows() != rows || game.Columns() != columns
+		|| game.Bombs() != bombs || game.Seed() != seed )
+	{
+		Reset( game );
+		return;
+	}
+
+	for( auto i = modifiedCells.cbegin(); i != modifiedCells.cend(); ++i ) {
+		if( !update( game, i->first, i->second ) ) {
+			// an opened cell is closed again, the game has been restarted
+			Reset( game );
+			return;
+		}
+	}
+}
+
+void CMinesweeperSolver::Reset( const CMinesweeperBoardView& board )
+{
+	reset( board.Rows(), board.Columns(), board.Bombs() );
+	seed = board.Seed();
+	for( size_t row = 0; row < rows; row++ ) {
+		for( size_t column = 0; column < columns; column++ ) {
+			Update( board, board.Index( row, column ) );
+		}
+	}
+}
+
+void CMinesweeperSolver::Update( const CMinesweeperBoardView& board, size_t index )
+{
+	if( !board.IsOpened( index ) ) {
+		return;
+	}
+
+	const size_t solverIndex = Index( board.Row( index ), board.Column( index ) );
+	if( board.IsBomb( index ) ) {
+		mark( solverIndex, MSC_Mine );
+	} else {
+		open( solverIndex, board.NumberOfNeighborBombs( index ) );
+	}
+}
+
+void CMinesweeperSolver::Solve()
+{
+	while( queueHead < queue.size() ) {
+		const size_t index = queue[queueHead++];
+		queued[index] = 0;
+		check( index );
+	}
+	queue.clear();
+	queueHead = 0;
+}
+
+bool CMinesweeperSolver::NextSafeCell( size_t& row, size_t& column )
+{
+	while( !safeCells.empty() ) {
+		const size_t index = safeCells.back();
+		safeCells.pop_back();
+		if( Knowledge( index ) == MSC_Safe ) {
+			row = Row( index );
+			column = Column( index );
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t CMinesweeperSolver::Play( IMinesweeperGame& game )
+{
+	game.ModifiedCells( modifiedCells );
+	Update( game, modifiedCells );
+
+	size_t numberOfOpenedCells = 0;
+	while( game.GameState() == MGS_Active ) {
+		Solve();
+		size_t row;
+		size_t column;
+		if( !NextSafeCell( row, column ) ) {
+			break;
+		}
+
+		IMinesweeperCell* const cell = game.Cell( row, column );
+		if( cell->Label() != MCL_None ) {
+			cell->SetLabel( MCL_None );
+		}
+		cell->Open();
+		numberOfOpenedCells++;
+		game.ModifiedCells( modifiedCells );
+		Update( game, modifiedCells );
+	}
+	return numberOfOpenedCells;
+}
+
+void CMinesweeperSolver::reset( size_t _rows, size_t _columns, size_t _bombs )
+{
+	rows = _rows;
+	columns = _columns;
+	bombs = _bombs;
+	stride = columns + 4;
+	const size_t planeSize = ( rows + 4 ) * stride;
+
+	const ptrdiff_t offset = static_cast<ptrdiff_t>( stride );
+	size_t numberOfNeighbors = 0;
+	size_t numberOfPartners = 0;
+	for( ptrdiff_t dr = -2; dr <= 2; dr++ ) {
+		for( ptrdiff_t dc = -2; dc <= 2; dc++ ) {
+			if( dr == 0 && dc == 0 ) {
+				continue;
+			}
+			partnerOffsets[numberOfPartners++] = dr * offset + dc;
+			if( dr >= -1 && dr <= 1 && dc >= -1 && dc <= 1 ) {
+				neighborOffsets[numberOfNeighbors++] = dr * offset + dc;
+			}
+		}
+	}
+
+	knowledge.assign( planeSize, static_cast<uint8_t>( MSC_Border ) );
+	for( size_t row = 0; row < rows; row++ ) {
+		fill_n( knowledge.begin() + Index( row, 0 ), columns,
+			static_cast<uint8_t>( MSC_Unknown ) );
+	}
+
+	// the counters are kept for the cells of the board and
+	// for the first ring of the border which is touched by updates
+	unknownNeighbors.assign( planeSize, 0 );
+	for( size_t row = 1; row < rows + 3; row++ ) {
+		for( size_t column = 1; column < columns + 3; column++ ) {
+			const size_t index = row * stride + column;
+			for( size_t i = 0; i < NumberOfNeighbors; i++ ) {
+				if( knowledge[index + neighborOffsets[i]] == MSC_Unknown ) {
+					unknownNeighbors[index]++;
+				}
+			}
+		}
+	}
+
+	numbers.assign( planeSize, 0 );
+	mineNeighbors.assign( planeSize, 0 );
+	queued.assign( planeSize, 0 );
+	queue.clear();
+	queueHead = 0;
+	frontier.clear();
+	frontierPositions.assign( planeSize, static_cast<size_t>( NotInFrontier ) );
+	safeCells.clear();
+	numberOfMines = 0;
+	numberOfUnknownCells = rows * columns;
+}
+
+bool CMinesweeperSolver::update( const IMinesweeperGame& game, size_t row, size_t column )
+{
+	const IMinesweeperCell* const cell = game.Cell( row, column );
+	const size_t index = Index( row, column );
+	if( !cell->IsOpened() ) {
+		return ( Knowledge( index ) != MSC_Opened );
+	}
+
+	if( cell->IsBomb() ) {
+		mark( index, MSC_Mine );
+	} else {
+		open( index, cell->NumberOfNeighborBombs() );
+	}
+	return true;
+}
+
+void CMinesweeperSolver::open( size_t index, size_t number )
+{
+	const TMinesweeperSolverCell previous = Knowledge( index );
+	if( previous == MSC_Opened ) {
+		return;
+	}
+	internal_check( previous != MSC_Mine );
+
+	knowledge[index] = static_cast<uint8_t>( MSC_Opened );
+	numbers[index] = static_cast<uint8_t>( number );
+	if( previous == MSC_Unknown ) {
+		removeUnknown( index );
+	}
+	if( unknownNeighbors[index] > 0 ) {
+		addToFrontier( index );
+		push( index );
+	}
+}
+
+void CMinesweeperSolver::mark( size_t index, TMinesweeperSolverCell value )
+{
+	if( Knowledge( index ) != MSC_Unknown ) {
+		return;
+	}
+
+	knowledge[index] = static_cast<uint8_t>( value );
+	if( value == MSC_Mine ) {
+		numberOfMines++;
+		for( size_t i = 0; i < NumberOfNeighbors; i++ ) {
+			mineNeighbors[index + neighborOffsets[i]]++;
+		}
+	} else {
+		safeCells.push_back( index );
+	}
+	removeUnknown( index );
+}
+
+void CMinesweeperSolver::removeUnknown( size_t index )
+{
+	numberOfUnknownCells--;
+	for( size_t i = 0; i < NumberOfNeighbors; i++ ) {
+		const size_t neighbor = index + neighborOffsets[i];
+		unknownNeighbors[neighbor]--;
+		if( Knowledge( neighbor ) == MSC_Opened ) {
+			if( unknownNeighbors[neighbor] == 0 ) {
+				removeFromFrontier( neighbor );
+			} else {
+				push( neighbor );
+			}
+		}
+	}
+}
+
+void CMinesweeperSolver::push( size_t index )
+{
+	if( queued[index] == 0 ) {
+		queued[index] = 1;
+		queue.push_back( index );
+	}
+}
+
+// Check of the opened cell A
+// I. Trivial rule:
+//    all unknown neighbors are safe if A has no remaining mines
+//    and are mines if A has as many remaining mines as unknown neighbors
+// II. Pairwise rule for each opened cell B with common unknown neighbors:
+//     the number of mines x among the common cells is limited by both cells,
+//     max( 0, rA - onlyA, rB - onlyB ) <= x <= min( common, rA, rB ),
+//     so the cells only of A are safe if rA - min( x ) == 0
+//     and are mines if rA - max( x ) == onlyA, the same for B
+
+void CMinesweeperSolver::check( size_t index )
+{
+	if( Knowledge( index ) != MSC_Opened || unknownNeighbors[index] == 0 ) {
+		return;
+	}
+
+	size_t cells[NumberOfNeighbors];
+	const size_t numberOfCells = unknownNeighborsOf( index, cells );
+	internal_check( mineNeighbors[index] <= numbers[index] );
+	const size_t remainingMines = RemainingMines( index );
+	internal_check( remainingMines <= numberOfCells );
+
+	if( remainingMines == 0 || remainingMines == numberOfCells ) {
+		const TMinesweeperSolverCell value = ( remainingMines == 0 ) ? MSC_Safe : MSC_Mine;
+		for( size_t i = 0; i < numberOfCells; i++ ) {
+			mark( cells[i], value );
+		}
+		return;
+	}
+
+	for( size_t i = 0; i < NumberOfPartners; i++ ) {
+		const size_t partner = index + partnerOffsets[i];
+		if( Knowledge( partner ) == MSC_Opened && unknownNeighbors[partner] > 0
+			&& checkPair( index, cells, numberOfCells, partner ) )
+		{
+			// the marks have queued the cell again
+			return;
+		}
+	}
+}
+
+size_t CMinesweeperSolver::unknownNeighborsOf( size_t index, size_t* cells ) const
+{
+	size_t numberOfCells = 0;
+	for( size_t i = 0; i < NumberOfNeighbors; i++ ) {
+		const size_t neighbor = index + neighborOffsets[i];
+		if( Knowledge( neighbor ) == MSC_Unknown ) {
+			cells[numberOfCells++] = neighbor;
+		}
+	}
+	return numberOfCells;
+}
+
+bool CMinesweeperSolver::checkPair( size_t index, const size_t* cells,
+	size_t numberOfCells, size_t partner )
+{
+	size_t partnerCells[NumberOfNeighbors];
+	const size_t numberOfPartnerCells = unknownNeighborsOf( partner, partnerCells );
+
+	bool isCommon[NumberOfNeighbors];
+	bool isPartnerCommon[NumberOfNeighbors];
+	fill( isCommon, isCommon + numberOfCells, false );
+	fill( isPartnerCommon, isPartnerCommon + numberOfPartnerCells, false );
+	ptrdiff_t common = 0;
+	for( size_t i = 0; i < numberOfCells; i++ ) {
+		for( size_t j = 0; j < numberOfPartnerCells; j++ ) {
+			if( cells[i] == partnerCells[j] ) {
+				isCommon[i] = true;
+				isPartnerCommon[j] = true;
+				common++;
+			}
+		}
+	}
+	if( common == 0 ) {
+		return false;
+	}
+
+	const ptrdiff_t onlyA = static_cast<ptrdiff_t>( numberOfCells ) - common;
+	const ptrdiff_t onlyB = static_cast<ptrdiff_t>( numberOfPartnerCells ) - common;
+	const ptrdiff_t minesA = static_cast<ptrdiff_t>( RemainingMines( index ) );
+	const ptrdiff_t minesB = static_cast<ptrdiff_t>( RemainingMines( partner ) );
+	const ptrdiff_t minCommon = max( max<ptrdiff_t>( 0, minesA - onlyA ), minesB - onlyB );
+	const ptrdiff_t maxCommon = min( min( common, minesA ), minesB );
+
+	TMinesweeperSolverCell valueA = MSC_Unknown;
+	if( onlyA > 0 ) {
+		if( minesA - minCommon == 0 ) {
+			valueA = MSC_Safe;
+		} else if( minesA - maxCommon == onlyA ) {
+			valueA = MSC_Mine;
+		}
+	}
+	TMinesweeperSolverCell valueB = MSC_Unknown;
+	if( onlyB > 0 ) {
+		if( minesB - minCommon == 0 ) {
+			valueB = MSC_Safe;
+		} else if( minesB - maxCommon == onlyB ) {
+			valueB = MSC_Mine;
+		}
+	}
+	if( valueA == MSC_Unknown && valueB == MSC_Unknown ) {
+		return false;
+	}
+
+	for( size_t i = 0; i < numberOfCells && valueA != MSC_Unknown; i++ ) {
+		if( !isCommon[i] ) {
+			mark( cells[i], valueA );
+		}
+	}
+	for( size_t j = 0; j < numberOfPartnerCells && valueB != MSC_Unknown; j++ ) {
+		if( !isPartnerCommon[j] ) {
+			mark( partnerCells[j], valueB );
+		}
+	}
+	return true;
+}
+
+void CMinesweeperSolver::addToFrontier( size_t index )
+{
+	if( frontierPositions[index] == NotInFrontier ) {
+		frontierPositions[index] = frontier.size();
+		frontier.push_back( index );
+	}
+}
+
+void CMinesweeperSolver::removeFromFrontier( size_t index )
+{
+	const size_t position = frontierPositions[index];
+	if( position != NotInFrontier ) {
+		frontierPositions[frontier.back()] = position;
+		frontier[position] = frontier.back();
+		frontier.pop_back();
+		frontierPositions[index] = NotInFrontier;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
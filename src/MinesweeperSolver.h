@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <Minesweeper.h>
+#include <MinesweeperCommon.h>
+#include <MinesweeperBoard.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// What the solver knows about a cell
+enum TMinesweeperSolverCell {
+	MSC_Unknown,
+	MSC_Safe, // deduced safe, not opened yet
+	MSC_Mine, // deduced or opened bomb
+	MSC_Opened,
+	MSC_Border
+};
+
+// Constraint propagation solver
+// sees the board only through the public game interface, the knowledge
+// is updated incrementally from ModifiedCells() deltas, every change
+// queues the opened cells around it, and only queued cells are checked by
+// the trivial rule (all unknown neighbors are safe or are mines) and by
+// the pairwise rule against the opened cells with common unknown neighbors
+// (which includes the subset rule), the cells are kept in planes with
+// a two cells wide border, so pairs of cells need no edge checks
+class CMinesweeperSolver {
+public:
+	static const size_t NumberOfNeighbors = 8;
+	static const size_t NumberOfPartners = 24;
+
+	CMinesweeperSolver();
+	CMinesweeperSolver( const CMinesweeperSolver& ) = delete;
+	CMinesweeperSolver& operator=( const CMinesweeperSolver& ) = delete;
+
+	// forgets everything and scans the whole board of the game
+	void Reset( const IMinesweeperGame& game );
+	// takes into account the cells modified since previous update,
+	// a restart or a new game (another size or seed) causes Reset
+	void Update( const IMinesweeperGame& game,
+		const vector<pair<size_t, size_t>>& modifiedCells );
+	// the same for a board of an engine, the board index is reported
+	// by the observer of the engine (the board must not be restarted)
+	void Reset( const CMinesweeperBoardView& board );
+	void Update( const CMinesweeperBoardView& board, size_t index );
+	// makes all deductions which follow from the queued changes
+	void Solve();
+	// returns the next deduced safe cell which is still closed
+	bool NextSafeCell( size_t& row, size_t& column );
+	// opens deduced safe cells until the game ends or no more deductions,
+	// returns the number of opened cells (the solver consumes ModifiedCells())
+	size_t Play( IMinesweeperGame& game );
+
+	size_t Rows() const { return rows; }
+	size_t Columns() const { return columns; }
+	size_t Bombs() const { return bombs; }
+	// number of deduced and opened bombs
+	size_t NumberOfMines() const { return numberOfMines; }
+	// number of cells which are neither deduced nor opened
+	size_t NumberOfUnknownCells() const { return numberOfUnknownCells; }
+	TMinesweeperSolverCell Knowledge( size_t row, size_t column ) const;
+
+	// the planes for engines built on the solver
+	size_t Stride() const { return stride; }
+	size_t Index( size_t row, size_t column ) const { return ( row + 2 ) * stride + column + 2; }
+	size_t Row( size_t index ) const { return index / stride - 2; }
+	size_t Column( size_t index ) const { return index % stride - 2; }
+	const ptrdiff_t* NeighborOffsets() const { return neighborOffsets; }
+	TMinesweeperSolverCell Knowledge( size_t index ) const;
+	// number of not deduced bombs around the opened cell
+	size_t RemainingMines( size_t index ) const;
+	// number of unknown cells around the cell
+	size_t NumberOfUnknownNeighbors( size_t index ) const { return unknownNeighbors[index]; }
+	// opened cells with unknown neighbors
+	const vector<size_t>& Frontier() const { return frontier; }
+
+private:
+	static const size_t NotInFrontier = static_cast<size_t>( -1 );
+
+	size_t rows;
+	size_t columns;
+	size_t bombs;
+	uint64_t seed;
+	size_t stride;
+	ptrdiff_t neighborOffsets[NumberOfNeighbors];
+	ptrdiff_t partnerOffsets[NumberOfPartners];
+	size_t numberOfMines;
+	size_t numberOfUnknownCells;
+	vector<uint8_t> knowledge;
+	vector<uint8_t> numbers;
+	vector<uint8_t> unknownNeighbors;
+	vector<uint8_t> mineNeighbors;
+	vector<uint8_t> queued;
+	vector<size_t> queue;
+	size_t queueHead;
+	vector<size_t> frontier;
+	vector<size_t> frontierPositions;
+	vector<size_t> safeCells;
+	// buffer of Play for the modified cells of the game
+	vector<pair<size_t, size_t>> modifiedCells;
+
+	void reset( size_t rows, size_t columns, size_t bombs );
+	bool update( const IMinesweeperGame& game, size_t row, size_t column );
+	void open( size_t index, size_t number );
+	void mark( size_t index, TMinesweeperSolverCell value );
+	void removeUnknown( size_t index );
+	void push( size_t index );
+	void check( size_t index );
+	size_t unknownNeighborsOf( size_t index, size_t* cells ) const;
+	bool checkPair( size_t index, const size_t* cells, size_t numberOfCells,
+		size_t partner );
+	void addToFrontier( size_t index );
+	void removeFromFrontier( size_t index );
+};
+
+inline TMinesweeperSolverCell CMinesweeperSolver::Knowledge( size_t index ) const
+{
+	return static_cast<TMinesweeperSolverCell>( knowledge[index] );
+}
+
+inline TMinesweeperSolverCell CMinesweeperSolver::Knowledge( size_t row, size_t column ) const
+{
+	internal_check( row < rows && column < columns );
+	return Knowledge( Index( row, column ) );
+}
+
+inline size_t CMinesweeperSolver::RemainingMines( size_t index ) const
+{
+	return numbers[index] - mineNeighbors[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
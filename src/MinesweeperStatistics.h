@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <Minesweeper.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+enum TMinesweeperCounter {
+	MC_Opens,
+	MC_FloodFills,
+	MC_FloodFillIterations,
+	MC_NeighborScans,
+	MC_CascadeCells,
+	MC_MaxCascadeCells,
+	MC_ModifiedCells,
+	MC_PlantBombs,
+	MC_PlantBombsNanoseconds,
+	MC_NumberOfCounters
+};
+
+// Statistics counters of a game
+// the counters exist only if MINESWEEPER_STATISTICS is defined, otherwise
+// all methods are empty and are compiled to nothing,
+// a game is played by a single thread, so the counters are updated by
+// relaxed loads and stores (no locked instructions), while snapshots and
+// resets may be done from any other thread
+class CMinesweeperCounters {
+public:
+	CMinesweeperCounters() { Reset(); }
+
+	void Add( TMinesweeperCounter counter, uint64_t value );
+	void Max( TMinesweeperCounter counter, uint64_t value );
+	CMinesweeperStatistics Snapshot() const;
+	void Reset();
+
+#ifdef MINESWEEPER_STATISTICS
+private:
+	atomic<uint64_t> counters[MC_NumberOfCounters];
+#endif
+};
+
+// Adds the lifetime of the timer in nanoseconds to the counter
+class CMinesweeperCounterTimer {
+public:
+	CMinesweeperCounterTimer( CMinesweeperCounters& counters, TMinesweeperCounter counter );
+	~CMinesweeperCounterTimer();
+
+#ifdef MINESWEEPER_STATISTICS
+private:
+	CMinesweeperCounters& counters;
+	const TMinesweeperCounter counter;
+	const chrono::steady_clock::time_point start;
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef MINESWEEPER_STATISTICS
+
+inline void CMinesweeperCounters::Add( TMinesweeperCounter counter, uint64_t value )
+{
+	atomic<uint64_t>& target = counters[counter];
+	target.store( target.load( memory_order_relaxed ) + value, memory_order_relaxed );
+}
+
+inline void CMinesweeperCounters::Max( TMinesweeperCounter counter, uint64_t value )
+{
+	atomic<uint64_t>& target = counters[counter];
+	if( target.load( memory_order_relaxed ) < value ) {
+		target.store( value, memory_order_relaxed );
+	}
+}
+
+inline CMinesweeperStatistics CMinesweeperCounters::Snapshot() const
+{
+	uint64_t values[MC_NumberOfCounters];
+	for( size_t i = 0; i < MC_NumberOfCounters; i++ ) {
+		values[i] = counters[i].load( memory_order_relaxed );
+	}
+	const CMinesweeperStatistics statistics = {
+		values[MC_Opens],
+		values[MC_FloodFills],
+		values[MC_FloodFillIterations],
+		values[MC_NeighborScans],
+		values[MC_CascadeCells],
+		values[MC_MaxCascadeCells],
+		values[MC_ModifiedCells],
+		values[MC_PlantBombs],
+		values[MC_PlantBombsNanoseconds]
+	};
+	return statistics;
+}
+
+inline void CMinesweeperCounters::Reset()
+{
+	for( size_t i = 0; i < MC_NumberOfCounters; i++ ) {
+		counters[i].store( 0, memory_order_relaxed );
+	}
+}
+
+inline CMinesweeperCounterTimer::CMinesweeperCounterTimer(
+	CMinesweeperCounters& _counters, TMinesweeperCounter _counter ) :
+	counters( _counters ),
+	counter( _counter ),
+	start( chrono::steady_clock::now() )
+{
+}
+
+inline CMinesweeperCounterTimer::~CMinesweeperCounterTimer()
+{
+	const chrono::nanoseconds elapsed = chrono::steady_clock::now() - start;
+	counters.Add( counter, static_cast<uint64_t>( elapsed.count() ) );
+}
+
+#else // MINESWEEPER_STATISTICS
+
+inline void CMinesweeperCounters::Add( TMinesweeperCounter, uint64_t )
+{
+}
+
+inline void CMinesweeperCounters::Max( TMinesweeperCounter, uint64_t )
+{
+}
+
+inline CMinesweeperStatistics CMinesweeperCounters::Snapshot() const
+{
+	const CMinesweeperStatistics statistics = {};
+	return statistics;
+}
+
+inline void CMinesweeperCounters::Reset()
+{
+}
+
+inline CMinesweeperCounterTimer::CMinesweeperCounterTimer(
+	CMinesweeperCounters&, TMinesweeperCounter )
+{
+}
+
+inline CMinesweeperCounterTimer::~CMinesweeperCounterTimer()
+{
+}
+
+#endif // MINESWEEPER_STATISTICS
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
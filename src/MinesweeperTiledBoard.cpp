@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <atomic>
+#include <MinesweeperTiledBoard.h>
+#include <MinesweeperRandom.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// calculates a * b / c exactly (a <= c)
+uint64_t multiplyDivide( uint64_t a, uint64_t b, uint64_t c )
+{
+	const uint64_t low32 = 0xFFFFFFFFULL;
+	const uint64_t p0 = ( a & low32 ) * ( b & low32 );
+	const uint64_t p1 = ( a & low32 ) * ( b >> 32 );
+	const uint64_t p2 = ( a >> 32 ) * ( b & low32 );
+	const uint64_t p3 = ( a >> 32 ) * ( b >> 32 );
+	const uint64_t middle = ( p0 >> 32 ) + ( p1 & low32 ) + ( p2 & low32 );
+	const uint64_t low = ( middle << 32 ) | ( p0 & low32 );
+	uint64_t remainder = p3 + ( p1 >> 32 ) + ( p2 >> 32 ) + ( middle >> 32 );
+
+	uint64_t quotient = 0;
+	for( int bit = 63; bit >= 0; bit-- ) {
+		const bool overflow = ( remainder >> 63 ) != 0;
+		remainder = ( remainder << 1 ) | ( ( low >> bit ) & 1 );
+		quotient <<= 1;
+		if( overflow || remainder >= c ) {
+			remainder -= c;
+			quotient |= 1;
+		}
+	}
+	return quotient;
+}
+
+// the numbers of the changes of all boards, zero is no change
+atomic<uint64_t> lastChangeNumber( 0 );
+
+} // end of anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperTiledBoard::CMinesweeperTiledBoard() :
+	rows( 0 ),
+	columns( 0 ),
+	bombs( 0 ),
+	seed( 0 ),
+	revealBombs( false ),
+	tileRows( 0 ),
+	tileColumns( 0 ),
+	lastTileIndex( 0 ),
+	lastTile( nullptr ),
+	sampledTileRow( 0 ),
+	firstChange( 0 ),
+	numberOfChanges( 0 )
+{
+}
+
+void CMinesweeperTiledBoard::Reset( size_t _rows, size_t _columns, size_t _bombs,
+	uint64_t _seed )
+{
+	internal_check( _bombs <= _rows * _columns );
+
+	rows = _rows;
+	columns = _columns;
+	bombs = _bombs;
+	seed = _seed;
+	revealBombs = false;
+	tileRows = ( rows + TileSize - 1 ) / TileSize;
+	tileColumns = ( columns + TileSize - 1 ) / TileSize;
+	tiles.clear();
+	lastTile = nullptr;
+	sampledTileRow = tileRows;
+	for( auto i = sampledTiles.begin(); i != sampledTiles.end(); ++i ) {
+		i->TileIndex = NotSampled;
+	}
+	for( size_t i = 0; i < numberOfChanges; i++ ) {
+		changes[( firstChange + i ) % changes.size()].Tiles.clear();
+	}
+	numberOfChanges = 0;
+}
+
+void CMinesweeperTiledBoard::Share( const CMinesweeperTiledBoard& other )
+{
+	Reset( other.rows, other.columns, other.bombs, other.seed );
+	revealBombs = other.revealBombs;
+	tiles = other.tiles;
+}
+
+void CMinesweeperTiledBoard::SetChangeDepth( size_t depth )
+{
+	for( size_t i = 0; i < numberOfChanges; i++ ) {
+		changes[( firstChange + i ) % changes.size()].Tiles.clear();
+	}
+	changes.resize( depth );
+	firstChange = 0;
+	numberOfChanges = 0;
+}
+
+void CMinesweeperTiledBoard::BeginChange()
+{
+	if( changes.empty() ) {
+		return;
+	}
+	if( numberOfChanges == changes.size() ) {
+		changes[firstChange].Tiles.clear();
+		firstChange = ( firstChange + 1 ) % changes.size();
+		numberOfChanges--;
+	}
+	numberOfChanges++;
+	CChange& change = *currentChange();
+	change.Number = ++lastChangeNumber;
+	change.RevealBombs = revealBombs;
+	internal_check( change.Tiles.empty() );
+}
+
+// The bombs are spread over the tiles proportionally to the number of cells:
+// the tiles preceding the tile (row by row) hold bombs * cellsBefore / cells
+// bombs, so each tile knows its number of bombs without other tiles
+// and the total is exactly the number of bombs of the board
+void CMinesweeperTiledBoard::generateBombs( size_t tileRow, size_t tileColumn,
+	uint64_t* mask ) const
+{
+	const size_t height = tileHeight( tileRow );
+	const size_t width = tileWidth( tileColumn );
+	const uint64_t cells = static_cast<uint64_t>( rows ) * columns;
+	const uint64_t before = cellsBefore( tileRow, tileColumn );
+	const size_t numberOfBombs = static_cast<size_t>(
+		multiplyDivide( before + height * width, bombs, cells )
+		- multiplyDivide( before, bombs, cells ) );
+
+	fill( mask, mask + TileSize, 0 );
+
+	const uint64_t tileIndex = static_cast<uint64_t>( tileRow ) * tileColumns + tileColumn;
+	CMinesweeperRandom random( seed ^ MixSeed( tileIndex ) );
+	SampleCells( random, height * width, numberOfBombs,
+		[mask, width]( size_t cell ) {
+			return ( ( mask[cell / width] >> ( cell % width ) ) & 1 ) != 0;
+		},
+		[mask, width]( size_t cell ) {
+			mask[cell / width] |= uint64_t( 1 ) << ( cell % width );
+		} );
+}
+
+bool CMinesweeperTiledBoard::isSampledBomb( size_t row, size_t column )
+{
+	const size_t tileRow = row / TileSize;
+	const size_t tileColumn = column / TileSize;
+	internal_check( tileRow < tileRows && tileColumn < tileColumns );
+	if( tileRow != sampledTileRow ) {
+		sampledBombs.resize( tileColumns * TileSize );
+		isSampled.assign( tileColumns, 0 );
+		sampledTileRow = tileRow;
+	}
+	uint64_t* const mask = sampledBombs.data() + tileColumn * TileSize;
+	if( isSampled[tileColumn] == 0 ) {
+		generateBombs( tileRow, tileColumn, mask );
+		isSampled[tileColumn] = 1;
+	}
+	return ( ( mask[row % TileSize] >> ( column % TileSize ) ) & 1 ) != 0;
+}
+
+// the bombs of a tile depend only on the board, so the sampled tiles
+// are kept until the next Reset
+const uint64_t* CMinesweeperTiledBoard::sampledTile( size_t tileRow, size_t tileColumn )
+{
+	if( tileRow == sampledTileRow && isSampled[tileColumn] != 0 ) {
+		return sampledBombs.data() + tileColumn * TileSize;
+	}
+	if( sampledTiles.empty() ) {
+		CSampledTile empty;
+		empty.TileIndex = NotSampled;
+		sampledTiles.assign( SampledSpan * SampledSpan, empty );
+	}
+	const size_t tileIndex = tileRow * tileColumns + tileColumn;
+	CSampledTile& sampled = sampledTiles[( tileRow % SampledSpan ) * SampledSpan
+		+ tileColumn % SampledSpan];
+	if( sampled.TileIndex != tileIndex ) {
+		generateBombs( tileRow, tileColumn, sampled.Bombs );
+		sampled.TileIndex = tileIndex;
+	}
+	return sampled.Bombs;
+}
+
+CMinesweeperTiledBoard::TTile* CMinesweeperTiledBoard::generate( size_t tileIndex )
+{
+	const size_t tileRow = tileIndex / tileColumns;
+	const size_t tileColumn = tileIndex % tileColumns;
+	internal_check( tileRow < tileRows );
+
+	CChange* const change = currentChange();
+	TTile tile = make_shared<CMinesweeperTile>();
+	tile->FirstRow = tileRow * TileSize;
+	tile->FirstColumn = tileColumn * TileSize;
+	tile->Height = tileHeight( tileRow );
+	tile->Width = tileWidth( tileColumn );
+	tile->Change = change != nullptr ? change->Number : 0;
+	// the tile may be sampled already as a neighbor of a generated tile
+	const uint64_t* const tileBombs = sampledTile( tileRow, tileColumn );
+	copy( tileBombs, tileBombs + TileSize, tile->Bombs );
+
+	// the tile with a one cell border taken from neighbor tiles
+	bitboard.Reset( TileSize + 2, TileSize + 2 );
+	for( int dr = -1; dr <= 1; dr++ ) {
+		for( int dc = -1; dc <= 1; dc++ ) {
+			if( ( dr < 0 && tileRow == 0 ) || ( dr > 0 && tileRow + 1 == tileRows )
+				|| ( dc < 0 && tileColumn == 0 ) || ( dc > 0 && tileColumn + 1 == tileColumns ) )
+			{
+				continue;
+			}
+
+			const size_t neighborRow = tileRow + dr;
+			const size_t neighborColumn = tileColumn + dc;
+			const uint64_t* mask = tile->Bombs;
+			if( dr != 0 || dc != 0 ) {
+				auto neighbor = tiles.find( neighborRow * tileColumns + neighborColumn );
+				mask = neighbor != tiles.end() ? neighbor->second->Bombs
+					: sampledTile( neighborRow, neighborColumn );
+			}
+
+			// only the adjacent row and column of neighbor tiles are needed
+			const size_t height = tileHeight( neighborRow );
+			const size_t width = tileWidth( neighborColumn );
+			const size_t firstRow = dr > 0 ? 0 : ( dr < 0 ? height - 1 : 0 );
+			const size_t lastRow = dr < 0 ? height - 1 : ( dr > 0 ? 0 : height - 1 );
+			const size_t firstColumn = dc > 0 ? 0 : ( dc < 0 ? width - 1 : 0 );
+			const size_t lastColumn = dc < 0 ? width - 1 : ( dc > 0 ? 0 : width - 1 );
+			for( size_t row = firstRow; row <= lastRow; row++ ) {
+				for( size_t column = firstColumn; column <= lastColumn; column++ ) {
+					if( ( ( mask[row] >> column ) & 1 ) != 0 ) {
+						bitboard.SetBomb( ( dr + 1 ) * TileSize + row + 1 - TileSize,
+							( dc + 1 ) * TileSize + column + 1 - TileSize );
+					}
+				}
+			}
+		}
+	}
+	bitboard.CalculateNumberOfNeighborBombs();
+	fill( tile->NumberOfNeighborLabeledBombs,
+		tile->NumberOfNeighborLabeledBombs + CMinesweeperTile::TileCells, 0 );
+
+	for( size_t row = 0; row < TileSize; row++ ) {
+		for( size_t column = 0; column < TileSize; column++ ) {
+			const size_t offset = row * TileSize + column;
+			if( row < tile->Height && column < tile->Width ) {
+				tile->NumberOfNeighborBombs[offset] = static_cast<uint8_t>(
+					bitboard.NumberOfNeighborBombs( row + 1, column + 1 ) );
+				tile->State[offset] = ( revealBombs && tile->IsBomb( offset ) )
+					? CMinesweeperTile::OpenedFlag : 0;
+			} else {
+				// cells outside of the board
+				tile->NumberOfNeighborBombs[offset] = 0;
+				tile->State[offset] = CMinesweeperTile::OpenedFlag;
+			}
+		}
+	}
+
+	if( change != nullptr ) {
+		change->Tiles.push_back( make_pair( tileIndex, TTile() ) );
+	}
+	return &tiles.emplace( tileIndex, move( tile ) ).first->second;
+}
+
+size_t CMinesweeperTiledBoard::cellsBefore( size_t tileRow, size_t tileColumn ) const
+{
+	return tileRow * TileSize * columns
+		+ tileHeight( tileRow ) * min( tileColumn * TileSize, columns );
+}
+
+size_t CMinesweeperTiledBoard::tileHeight( size_t tileRow ) const
+{
+	const size_t height = rows - tileRow * TileSize;
+	return height < TileSize ? height : TileSize;
+}
+
+size_t CMinesweeperTiledBoard::tileWidth( size_t tileColumn ) const
+{
+	const size_t width = columns - tileColumn * TileSize;
+	return width < TileSize ? width : TileSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
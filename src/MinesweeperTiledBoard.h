@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <Minesweeper.h>
+#include <MinesweeperCommon.h>
+#include <MinesweeperBitboard.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Square piece of a tiled board
+// the tile row r is the word Bombs[r], the cell ( r, c ) of the tile
+// has offset ( r * TileSize + c ) in the byte planes
+struct CMinesweeperTile {
+	static const size_t TileSize = 64;
+	static const size_t TileCells = TileSize * TileSize;
+
+	// bits of the State plane
+	static const uint8_t OpenedFlag = 0x01;
+	static const uint8_t VisitedFlag = 0x02;
+	static const uint8_t LabelShift = 2;
+	static const uint8_t LabelMask = 0x0C;
+
+	// position of the top left cell on the board and the size of the tile
+	// (tiles at the right and bottom edges may be smaller)
+	size_t FirstRow;
+	size_t FirstColumn;
+	size_t Height;
+	size_t Width;
+	// the change of the board which made the tile (CMinesweeperTiledBoard)
+	uint64_t Change;
+
+	uint64_t Bombs[TileSize];
+	uint8_t State[TileCells];
+	uint8_t NumberOfNeighborBombs[TileCells];
+	// numbers of neighbors labeled as bombs, kept by the game
+	uint8_t NumberOfNeighborLabeledBombs[TileCells];
+
+	bool IsBomb( size_t offset ) const;
+	bool IsOpened( size_t offset ) const { return ( State[offset] & OpenedFlag ) != 0; }
+	TMinesweeperCellLabel Label( size_t offset ) const;
+	void SetIsOpened( size_t offset ) { State[offset] |= OpenedFlag; }
+	void SetLabel( size_t offset, TMinesweeperCellLabel label );
+};
+
+inline bool CMinesweeperTile::IsBomb( size_t offset ) const
+{
+	return ( ( Bombs[offset / TileSize] >> ( offset % TileSize ) ) & 1 ) != 0;
+}
+
+inline TMinesweeperCellLabel CMinesweeperTile::Label( size_t offset ) const
+{
+	return static_cast<TMinesweeperCellLabel>( ( State[offset] & LabelMask ) >> LabelShift );
+}
+
+inline void CMinesweeperTile::SetLabel( size_t offset, TMinesweeperCellLabel label )
+{
+	State[offset] = static_cast<uint8_t>( ( State[offset] & ~LabelMask )
+		| ( static_cast<uint8_t>( label ) << LabelShift ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Tiled board storage for huge boards
+// the board is split into tiles which are allocated and generated on first
+// touch, the bombs of each tile are derived from the board seed and the tile
+// position only, so any tile can be generated independently of the others
+// and the numbers of neighbor bombs are exact across tile boundaries,
+// the tiles are shared copy on write by boards (Share) and by the kept
+// changes, so a tile is copied by the first write of MutableTile
+// while it is shared, the changes of the board since BeginChange keep
+// the previous tiles of the copied tiles and the generated tiles,
+// so UndoChange puts the tiles back without copying any cells
+class CMinesweeperTiledBoard {
+public:
+	static const size_t TileSize = CMinesweeperTile::TileSize;
+
+	CMinesweeperTiledBoard();
+	CMinesweeperTiledBoard( const CMinesweeperTiledBoard& ) = delete;
+	CMinesweeperTiledBoard& operator=( const CMinesweeperTiledBoard& ) = delete;
+
+	// drops all tiles and kept changes and starts a new board
+	void Reset( size_t rows, size_t columns, size_t bombs, uint64_t seed );
+	// takes the board of the other board and shares its tiles,
+	// only the pointers of the generated tiles are copied, no changes are kept
+	void Share( const CMinesweeperTiledBoard& other );
+
+	size_t Rows() const { return rows; }
+	size_t Columns() const { return columns; }
+	size_t Bombs() const { return bombs; }
+	uint64_t Seed() const { return seed; }
+	size_t NumberOfTiles() const { return tiles.size(); }
+
+	// whether the bombs of tiles generated from now on are opened
+	void SetRevealBombs( bool reveal ) { revealBombs = reveal; }
+	bool RevealBombs() const { return revealBombs; }
+
+	// the tile of the cell, the tile is generated if it is not yet
+	const CMinesweeperTile& Tile( size_t row, size_t column );
+	// the same, but a shared tile is copied first, so it may be modified
+	CMinesweeperTile& MutableTile( size_t row, size_t column );
+	// the tile of the cell if it is generated, nullptr otherwise
+	const CMinesweeperTile* FindTile( size_t row, size_t column );
+	// whether the cell is bomb, the tile is not generated, the bombs of the tiles
+	// which are not generated are sampled into a buffer of one row of tiles,
+	// so the whole board can be read row by row in memory of one tile row
+	bool IsBomb( size_t row, size_t column );
+	static size_t Offset( size_t row, size_t column );
+
+	// calls the action( tile ) for every generated tile, the action may
+	// get the MutableTile of the tile, but may not generate tiles
+	template<typename TAction>
+	void ForEachTile( TAction action );
+
+	// keeps up to the depth last changes, zero depth keeps no changes
+	void SetChangeDepth( size_t depth );
+	size_t NumberOfChanges() const { return numberOfChanges; }
+	// starts a change, the oldest kept change is dropped once there are depth of them
+	void BeginChange();
+	// puts back the tiles and the bomb revealing of the board before the last
+	// change, calls undone( tile, previous ) for every changed tile before it
+	// is put back, previous is nullptr for the tiles generated by the change
+	// (they are generated again with the bomb revealing of the board)
+	template<typename TUndone>
+	void UndoChange( TUndone undone );
+
+private:
+	typedef shared_ptr<CMinesweeperTile> TTile;
+
+	static const size_t NotSampled = static_cast<size_t>( -1 );
+	// the tiles sampled for the borders of generated tiles are kept in
+	// the slots of their positions modulo SampledSpan rows and columns,
+	// so the neighbors of a tile and of the tiles next to it never share a slot
+	static const size_t SampledSpan = 4;
+
+	// the bombs of the tile TileIndex, NotSampled if the slot is empty
+	struct CSampledTile {
+		size_t TileIndex;
+		uint64_t Bombs[TileSize];
+	};
+
+	// the tiles of the board before the change
+	struct CChange {
+		// the change is unique in the process, so the tiles made
+		// by the change are recognized also when they are shared by forks
+		uint64_t Number;
+		bool RevealBombs;
+		vector<pair<size_t, TTile>> Tiles;
+	};
+
+	size_t rows;
+	size_t columns;
+	size_t bombs;
+	uint64_t seed;
+	bool revealBombs;
+	size_t tileRows;
+	size_t tileColumns;
+	unordered_map<size_t, TTile> tiles;
+	// the most recently used tile, the elements of the map keep
+	// their addresses when the map grows
+	size_t lastTileIndex;
+	TTile* lastTile;
+	// buffer to calculate numbers of neighbor bombs of a tile with its border
+	CMinesweeperBitboard bitboard;
+	// the bombs of the tiles of the row of tiles which are sampled by IsBomb
+	// (TileSize words per tile), the tile row is tileRows if none is sampled
+	size_t sampledTileRow;
+	vector<uint64_t> sampledBombs;
+	vector<uint8_t> isSampled;
+	// the tiles sampled by generate (SampledSpan * SampledSpan slots)
+	vector<CSampledTile> sampledTiles;
+	// the ring of the kept changes, the last one is the current change
+	vector<CChange> changes;
+	size_t firstChange;
+	size_t numberOfChanges;
+
+	CChange* currentChange();
+	TTile& tile( size_t row, size_t column );
+	TTile* find( size_t tileIndex );
+	TTile* generate( size_t tileIndex );
+	bool isSampledBomb( size_t row, size_t column );
+	const uint64_t* sampledTile( size_t tileRow, size_t tileColumn );
+	void generateBombs( size_t tileRow, size_t tileColumn, uint64_t* mask ) const;
+	size_t cellsBefore( size_t tileRow, size_t tileColumn ) const;
+	size_t tileHeight( size_t tileRow ) const;
+	size_t tileWidth( size_t tileColumn ) const;
+};
+
+inline const CMinesweeperTile& CMinesweeperTiledBoard::Tile( size_t row, size_t column )
+{
+	return *tile( row, column );
+}
+
+inline CMinesweeperTile& CMinesweeperTiledBoard::MutableTile( size_t row, size_t column )
+{
+	TTile& result = tile( row, column );
+	CChange* const change = currentChange();
+	if( change != nullptr ? result->Change != change->Number : !IsExclusivelyOwned( result ) ) {
+		if( change != nullptr ) {
+			change->Tiles.push_back( make_pair( lastTileIndex, result ) );
+		}
+		result = make_shared<CMinesweeperTile>( *result );
+		result->Change = change != nullptr ? change->Number : 0;
+	} else if( !IsExclusivelyOwned( result ) ) {
+		// the tile of the change is shared by a fork made after the copy
+		result = make_shared<CMinesweeperTile>( *result );
+	}
+	return *result;
+}
+
+inline const CMinesweeperTile* CMinesweeperTiledBoard::FindTile( size_t row, size_t column )
+{
+	TTile* const found = find( ( row / TileSize ) * tileColumns + column / TileSize );
+	return found != nullptr ? found->get() : nullptr;
+}
+
+inline bool CMinesweeperTiledBoard::IsBomb( size_t row, size_t column )
+{
+	const CMinesweeperTile* const found = FindTile( row, column );
+	return found != nullptr ? found->IsBomb( Offset( row, column ) )
+		: isSampledBomb( row, column );
+}
+
+inline CMinesweeperTiledBoard::TTile& CMinesweeperTiledBoard::tile( size_t row, size_t column )
+{
+	const size_t tileIndex = ( row / TileSize ) * tileColumns + column / TileSize;
+	TTile* const found = find( tileIndex );
+	if( found == nullptr ) {
+		lastTile = generate( tileIndex );
+		lastTileIndex = tileIndex;
+	}
+	return *lastTile;
+}
+
+// the tile becomes the most recently used one if it is found
+inline CMinesweeperTiledBoard::TTile* CMinesweeperTiledBoard::find( size_t tileIndex )
+{
+	if( lastTile == nullptr || tileIndex != lastTileIndex ) {
+		auto found = tiles.find( tileIndex );
+		if( found == tiles.end() ) {
+			return nullptr;
+		}
+		lastTile = &found->second;
+		lastTileIndex = tileIndex;
+	}
+	return lastTile;
+}
+
+inline CMinesweeperTiledBoard::CChange* CMinesweeperTiledBoard::currentChange()
+{
+	return numberOfChanges == 0 ? nullptr
+		: &changes[( firstChange + numberOfChanges - 1 ) % changes.size()];
+}
+
+inline size_t CMinesweeperTiledBoard::Offset( size_t row, size_t column )
+{
+	return ( row % TileSize ) * TileSize + column % TileSize;
+}
+
+template<typename TAction>
+inline void CMinesweeperTiledBoard::ForEachTile( TAction action )
+{
+	for( auto tile = tiles.begin(); tile != tiles.end(); ++tile ) {
+		action( static_cast<const CMinesweeperTile&>( *tile->second ) );
+	}
+}
+
+// a change keeps every tile once, so the order of the tiles does not matter
+template<typename TUndone>
+void CMinesweeperTiledBoard::UndoChange( TUndone undone )
+{
+	internal_check( numberOfChanges > 0 );
+	CChange& change = *currentChange();
+	revealBombs = change.RevealBombs;
+	for( auto i = change.Tiles.rbegin(); i != change.Tiles.rend(); ++i ) {
+		auto found = tiles.find( i->first );
+		internal_check( found != tiles.end() );
+		undone( static_cast<const CMinesweeperTile&>( *found->second ),
+			static_cast<const CMinesweeperTile*>( i->second.get() ) );
+		if( i->second ) {
+			found->second = move( i->second );
+		} else {
+			tiles.erase( found );
+		}
+	}
+	change.Tiles.clear();
+	numberOfChanges--;
+	lastTile = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
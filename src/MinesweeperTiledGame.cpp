@@ -0,0 +1,855 @@
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <MinesweeperTiledGame.h>
+#include <MinesweeperTiledBoard.h>
+#include <MinesweeperBits.h>
+#include <MinesweeperRandom.h>
+#include <MinesweeperStatistics.h>
+#include <MinesweeperSnapshot.h>
+#include <MinesweeperMoveLog.h>
+#include <MinesweeperEncoding.h>
+#include <MinesweeperEvents.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+class CMinesweeperTiledGame;
+
+// Proxy handle of a cell of the tiled board
+class CMinesweeperTiledCell : public IMinesweeperCell {
+public:
+	CMinesweeperTiledCell( CMinesweeperTiledGame& game, size_t row, size_t column );
+	CMinesweeperTiledCell( const CMinesweeperTiledCell& ) = delete;
+	CMinesweeperTiledCell& operator=( const CMinesweeperTiledCell& ) = delete;
+
+	// IMinesweeperCell
+	virtual bool IsOpened() const;
+	virtual bool IsBomb() const;
+	virtual size_t NumberOfNeighborBombs() const;
+	virtual TMinesweeperCellLabel Label() const;
+	virtual void SetLabel( TMinesweeperCellLabel newLabel );
+	virtual void Open();
+
+private:
+	CMinesweeperTiledGame& game;
+	const size_t row;
+	const size_t column;
+
+	const CMinesweeperTile& tile() const;
+	size_t offset() const { return CMinesweeperTiledBoard::Offset( row, column ); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Game on the tiled board
+// only the tiles touched by Cell() or by opening cells are generated,
+// the modified cells and the revealed bombs are tracked for generated tiles,
+// bombs of tiles generated after the failure are opened on generation,
+// so the failure is encoded whole, the bombs of the tiles which are not
+// generated are sampled without generating them
+class CMinesweeperTiledGame : public IMinesweeperGame {
+public:
+	explicit CMinesweeperTiledGame( const CMinesweeperSizePolicy& policy );
+	CMinesweeperTiledGame( const CMinesweeperTiledGame& ) = delete;
+	CMinesweeperTiledGame& operator=( const CMinesweeperTiledGame& ) = delete;
+
+	// IMinesweeperGame
+	virtual TMinesweeperGameState GameState() const { return state; }
+	virtual size_t Rows() const { return rows; }
+	virtual size_t Columns() const { return columns; }
+	virtual size_t Bombs() const { return bombs; }
+	virtual uint64_t Seed() const { return board.Seed(); }
+	virtual size_t NumberOfOpenedCells() const { return numberOfOpenedCells; }
+	virtual void NewGame( size_t rows, size_t columns, size_t bombs );
+	virtual void NewGame( size_t rows, size_t columns, size_t bombs, uint64_t seed );
+	virtual void NewGame();
+	virtual void RestartGame();
+	// the tiles are planted from the seed on generation, so bombs cannot be
+	// moved away from the first open
+	virtual void SetFirstClick( TMinesweeperFirstClick firstClick );
+	virtual TMinesweeperFirstClick FirstClick() const { return MFC_Any; }
+	virtual void Serialize( vector<uint8_t>& buffer ) const;
+	virtual void Deserialize( const void* data, size_t size );
+	virtual void EncodeBoard( TMinesweeperBoardEncoding encoding, void* buffer,
+		size_t size, bool incremental ) const;
+	virtual void SetEventSink( IMinesweeperEventSink* sink, size_t capacity ) { events.Reset( sink, capacity ); }
+	virtual const CMinesweeperMoveLog& MoveLog() const { return moveLog; }
+	virtual shared_ptr<IMinesweeperGame> Fork() const;
+	virtual void SetUndoDepth( size_t depth );
+	virtual size_t UndoDepth() const { return undoStates.size(); }
+	virtual size_t NumberOfUndoMoves() const { return numberOfUndoStates; }
+	virtual void UndoMove();
+	virtual IMinesweeperCell* Cell( size_t row, size_t column );
+	virtual const IMinesweeperCell* Cell( size_t row, size_t column ) const;
+	virtual void ChordableCells( vector<pair<size_t, size_t>>& cells ) const;
+	virtual CMinesweeperStatistics Statistics() const { return counters.Snapshot(); }
+	virtual void ResetStatistics() { counters.Reset(); }
+	virtual vector<pair<size_t, size_t>> ModifiedCells() const;
+	virtual void ModifiedCells( vector<pair<size_t, size_t>>& cells ) const;
+	virtual void ModifiedSpans( vector<CMinesweeperCellSpan>& spans ) const;
+
+	// used by cell proxies
+	const CMinesweeperTile& Tile( size_t row, size_t column ) const { return board.Tile( row, column ); }
+	void OnOpen( size_t row, size_t column );
+	void OnSetLabel( size_t row, size_t column, TMinesweeperCellLabel newLabel );
+
+private:
+	// the state of the game before a move, the tiles are kept by the changes
+	// of the board
+	struct CUndoState {
+		TMinesweeperGameState State;
+		size_t NumberOfOpenedCells;
+		size_t MoveLogSize;
+		size_t NumberOfMoves;
+	};
+
+	const CMinesweeperSizePolicy policy;
+	TMinesweeperGameState state;
+	size_t rows;
+	size_t columns;
+	size_t bombs;
+	mutable CMinesweeperTiledBoard board;
+	mutable unordered_map<size_t, unique_ptr<CMinesweeperTiledCell>> cells;
+	size_t numberOfOpenedCells;
+	// a bitmap of a huge board is too big, so modified cells are kept in a set
+	mutable unordered_set<size_t> modifiedCellIndices;
+	mutable vector<size_t> sortedCellIndices;
+	// the cells modified since the previous encoding,
+	// they are kept only once the board is encoded
+	mutable unordered_set<size_t> encodedCellIndices;
+	mutable bool trackEncodedCells;
+	mutable bool encodeAll;
+	mutable TMinesweeperBoardEncoding lastEncoding;
+	// flood fill queue, reused by all fills
+	vector<pair<size_t, size_t>> queue;
+	CMinesweeperCounters counters;
+	CMinesweeperEventRing events;
+	// the tiles are not planted as flat boards, so the log is only a record
+	CMinesweeperMoveLog moveLog;
+	// the ring of the states before the last moves, the undo depth long
+	vector<CUndoState> undoStates;
+	size_t firstUndoState;
+	size_t numberOfUndoStates;
+
+	void start( uint64_t seed );
+	// keeps the state before the move, the board keeps the tiles changed by the move
+	void beginMove();
+	void dropUndoStates();
+	void reset();
+	void takeModifiedCells() const;
+	void resize( size_t rows, size_t columns, size_t bombs );
+	void modified( size_t row, size_t column );
+	// pushes the event of the opened or labeled cell
+	void report( const CMinesweeperTile& tile, size_t row, size_t column );
+	bool open( size_t row, size_t column );
+	void openBombs();
+	void openNeighbors( size_t row, size_t column );
+	void visit( size_t row, size_t column );
+	void addNeighborLabeledBombs( size_t row, size_t column, int change );
+	bool hasClosedNeighbor( size_t row, size_t column ) const;
+	bool hasSuccess();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperTiledCell::CMinesweeperTiledCell( CMinesweeperTiledGame& _game,
+	size_t _row, size_t _column ) :
+	game( _game ),
+	row( _row ),
+	column( _column )
+{
+}
+
+bool CMinesweeperTiledCell::IsOpened() const
+{
+	return tile().IsOpened( offset() );
+}
+
+bool CMinesweeperTiledCell::IsBomb() const
+{
+	internal_check( IsOpened() );
+	return tile().IsBomb( offset() );
+}
+
+size_t CMinesweeperTiledCell::NumberOfNeighborBombs() const
+{
+	internal_check( !IsBomb() );
+	return tile().NumberOfNeighborBombs[offset()];
+}
+
+TMinesweeperCellLabel CMinesweeperTiledCell::Label() const
+{
+	return tile().Label( offset() );
+}
+
+void CMinesweeperTiledCell::SetLabel( TMinesweeperCellLabel newLabel )
+{
+	game.OnSetLabel( row, column, newLabel );
+}
+
+void CMinesweeperTiledCell::Open()
+{
+	game.OnOpen( row, column );
+}
+
+const CMinesweeperTile& CMinesweeperTiledCell::tile() const
+{
+	return game.Tile( row, column );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CMinesweeperTiledGame::CMinesweeperTiledGame( const CMinesweeperSizePolicy& _policy ) :
+	policy( _policy ),
+	state( MGS_Failure ),
+	rows( 0 ),
+	columns( 0 ),
+	bombs( 0 ),
+	numberOfOpenedCells( 0 ),
+	trackEncodedCells( false ),
+	encodeAll( true ),
+	lastEncoding( MBE_Codes ),
+	firstUndoState( 0 ),
+	numberOfUndoStates( 0 )
+{
+}
+
+void CMinesweeperTiledGame::NewGame( size_t _rows, size_t _columns, size_t _bombs )
+{
+	resize( _rows, _columns, _bombs );
+
+	// starts the game
+	NewGame();
+}
+
+void CMinesweeperTiledGame::NewGame( size_t _rows, size_t _columns, size_t _bombs,
+	uint64_t seed )
+{
+	resize( _rows, _columns, _bombs );
+	start( seed );
+}
+
+void CMinesweeperTiledGame::NewGame()
+{
+	start( GenerateSeed() );
+}
+
+void CMinesweeperTiledGame::RestartGame()
+{
+	beginMove();
+	reset();
+	moveLog.Append( MMT_Restart, 0 );
+	events.Push( MET_Restart, 0, 0, 0 );
+	events.Flush();
+
+	// only generated tiles may have opened or labeled cells,
+	// the tiles without them are not copied
+	board.SetRevealBombs( false );
+	board.ForEachTile( [this]( const CMinesweeperTile& sharedTile ) {
+		const uint8_t* const labeledBombs = sharedTile.NumberOfNeighborLabeledBombs;
+		bool isChanged = any_of( labeledBombs, labeledBombs + CMinesweeperTile::TileCells,
+			[]( uint8_t count ) { return count != 0; } );
+		for( size_t row = 0; row < sharedTile.Height && !isChanged; row++ ) {
+			const uint8_t* const state = sharedTile.State + row * CMinesweeperTile::TileSize;
+			isChanged = any_of( state, state + sharedTile.Width,
+				[]( uint8_t cell ) { return cell != 0; } );
+		}
+		if( !isChanged ) {
+			return;
+		}
+		CMinesweeperTile& tile = board.MutableTile( sharedTile.FirstRow, sharedTile.FirstColumn );
+		fill( tile.NumberOfNeighborLabeledBombs,
+			tile.NumberOfNeighborLabeledBombs + CMinesweeperTile::TileCells, 0 );
+		for( size_t row = 0; row < tile.Height; row++ ) {
+			for( size_t column = 0; column < tile.Width; column++ ) {
+				const size_t offset = row * CMinesweeperTile::TileSize + column;
+				if( tile.State[offset] != 0 ) {
+					tile.State[offset] = 0;
+					modified( tile.FirstRow + row, tile.FirstColumn + column );
+				}
+			}
+		}
+	} );
+}
+
+void CMinesweeperTiledGame::SetFirstClick( TMinesweeperFirstClick firstClick )
+{
+	internal_check( firstClick == MFC_Any );
+}
+
+// the snapshot has every cell, the bombs of the tiles which are not
+// generated are sampled without generating them
+void CMinesweeperTiledGame::Serialize( vector<uint8_t>& buffer ) const
+{
+	internal_check( rows <= UINT32_MAX && columns <= UINT32_MAX );
+	internal_check( bombs <= UINT32_MAX );
+	CMinesweeperSnapshotHeader header = {};
+	header.Magic = CMinesweeperSnapshotHeader::SnapshotMagic;
+	header.Version = CMinesweeperSnapshotHeader::CurrentVersion;
+	header.HeaderSize = sizeof( CMinesweeperSnapshotHeader );
+	header.Rows = static_cast<uint32_t>( rows );
+	header.Columns = static_cast<uint32_t>( columns );
+	header.Bombs = static_cast<uint32_t>( bombs );
+	header.State = static_cast<uint8_t>( state );
+	header.Seed = board.Seed();
+
+	// the cells of the tiles which are not generated are closed and not labeled,
+	// only their bombs are opened by the failure
+	WriteSnapshot( header,
+		[this]( size_t row, size_t column ) {
+			return board.IsBomb( row, column );
+		},
+		[this]( size_t row, size_t column ) {
+			const CMinesweeperTile* const tile = board.FindTile( row, column );
+			return tile != nullptr ? tile->IsOpened( CMinesweeperTiledBoard::Offset( row, column ) )
+				: ( board.RevealBombs() && board.IsBomb( row, column ) );
+		},
+		[this]( size_t row, size_t column ) {
+			const CMinesweeperTile* const tile = board.FindTile( row, column );
+			return tile != nullptr ? tile->Label( CMinesweeperTiledBoard::Offset( row, column ) )
+				: MCL_None;
+		},
+		buffer );
+}
+
+// the bombs of tiles are generated from the seed, so arbitrary bombs
+// of a snapshot cannot be restored
+void CMinesweeperTiledGame::Deserialize( const void*, size_t )
+{
+	internal_check( false );
+}
+
+void CMinesweeperTiledGame::EncodeBoard( TMinesweeperBoardEncoding encoding,
+	void* buffer, size_t size, bool incremental ) const
+{
+	internal_check( size >= EncodedBoardSize( encoding, rows, columns ) );
+	CMinesweeperBoardEncoder encoder( encoding, buffer, rows * columns );
+	const auto encodeCell = [this, &encoder]( const CMinesweeperTile& tile,
+		size_t row, size_t column )
+	{
+		const size_t offset = CMinesweeperTiledBoard::Offset( row, column );
+		encoder.Set( row * columns + column, CellCode( tile.IsOpened( offset ),
+			tile.IsBomb( offset ), tile.NumberOfNeighborBombs[offset],
+			tile.Label( offset ) ) );
+	};
+
+	trackEncodedCells = true;
+	if( incremental && !encodeAll && encoding == lastEncoding ) {
+		for( auto i = encodedCellIndices.cbegin(); i != encodedCellIndices.cend(); ++i ) {
+			const size_t row = ( *i ) / columns;
+			const size_t column = ( *i ) % columns;
+			encodeCell( board.Tile( row, column ), row, column );
+		}
+		encodedCellIndices.clear();
+		return;
+	}
+
+	encodedCellIndices.clear();
+	encodeAll = false;
+	lastEncoding = encoding;
+	if( state == MGS_Failure ) {
+		// all bombs are opened, also the bombs of the tiles not generated yet,
+		// they are sampled without generating the tiles
+		for( size_t row = 0; row < rows; row++ ) {
+			for( size_t column = 0; column < columns; column++ ) {
+				const CMinesweeperTile* const tile = board.FindTile( row, column );
+				if( tile != nullptr ) {
+					encodeCell( *tile, row, column );
+				} else {
+					encoder.Set( row * columns + column,
+						board.IsBomb( row, column ) ? MCC_Bomb : MCC_Closed );
+				}
+			}
+		}
+		return;
+	}
+	// the cells of the tiles which are not generated are closed
+	encoder.Fill( MCC_Closed );
+	board.ForEachTile( [&encodeCell]( const CMinesweeperTile& tile ) {
+		for( size_t row = 0; row < tile.Height; row++ ) {
+			for( size_t column = 0; column < tile.Width; column++ ) {
+				encodeCell( tile, tile.FirstRow + row, tile.FirstColumn + column );
+			}
+		}
+	} );
+}
+
+IMinesweeperCell* CMinesweeperTiledGame::Cell( size_t row, size_t column )
+{
+	internal_check( row < rows );
+	internal_check( column < columns );
+
+	unique_ptr<CMinesweeperTiledCell>& cell = cells[row * columns + column];
+	if( !cell ) {
+		cell.reset( new CMinesweeperTiledCell( *this, row, column ) );
+	}
+	return cell.get();
+}
+
+const IMinesweeperCell* CMinesweeperTiledGame::Cell( size_t row, size_t column ) const
+{
+	return const_cast<CMinesweeperTiledGame&>( *this ).Cell( row, column );
+}
+
+// only the pointers of the generated tiles are copied
+shared_ptr<IMinesweeperGame> CMinesweeperTiledGame::Fork() const
+{
+	shared_ptr<CMinesweeperTiledGame> fork( new CMinesweeperTiledGame( policy ) );
+	fork->state = state;
+	fork->rows = rows;
+	fork->columns = columns;
+	fork->bombs = bombs;
+	fork->board.Share( board );
+	fork->numberOfOpenedCells = numberOfOpenedCells;
+	fork->moveLog = moveLog;
+	return fork;
+}
+
+void CMinesweeperTiledGame::SetUndoDepth( size_t depth )
+{
+	undoStates.assign( depth, CUndoState() );
+	board.SetChangeDepth( depth );
+	dropUndoStates();
+}
+
+// only the tiles changed by the move are compared, the cells of the tiles
+// generated by the move are compared with the cells they are generated with
+void CMinesweeperTiledGame::UndoMove()
+{
+	internal_check( numberOfUndoStates > 0 );
+	numberOfUndoStates--;
+	const CUndoState& undoState =
+		undoStates[( firstUndoState + numberOfUndoStates ) % undoStates.size()];
+	events.Push( MET_Undo, 0, 0, 0 );
+	board.UndoChange( [this]( const CMinesweeperTile& tile, const CMinesweeperTile* previous ) {
+		const uint8_t mask = CMinesweeperTile::OpenedFlag | CMinesweeperTile::LabelMask;
+		for( size_t row = 0; row < tile.Height; row++ ) {
+			for( size_t column = 0; column < tile.Width; column++ ) {
+				const size_t offset = row * CMinesweeperTile::TileSize + column;
+				const uint8_t cell = previous != nullptr ? previous->State[offset]
+					: ( ( board.RevealBombs() && tile.IsBomb( offset ) ) ? CMinesweeperTile::OpenedFlag : 0 );
+				if( ( ( tile.State[offset] ^ cell ) & mask ) == 0 ) {
+					continue;
+				}
+				modified( tile.FirstRow + row, tile.FirstColumn + column );
+				if( events.IsEnabled() ) {
+					const bool isOpened = ( cell & CMinesweeperTile::OpenedFlag ) != 0;
+					const TMinesweeperCellLabel label = static_cast<TMinesweeperCellLabel>(
+						( cell & CMinesweeperTile::LabelMask ) >> CMinesweeperTile::LabelShift );
+					events.Push( isOpened ? MET_Opened : MET_Labeled,
+						CellCode( isOpened, tile.IsBomb( offset ), tile.NumberOfNeighborBombs[offset], label ),
+						tile.FirstRow + row, tile.FirstColumn + column );
+				}
+			}
+		}
+	} );
+	// the bombs of the tiles which are not generated are closed again
+	if( state == MGS_Failure ) {
+		encodeAll = true;
+	}
+	const TMinesweeperGameState previousState = state;
+	state = undoState.State;
+	numberOfOpenedCells = undoState.NumberOfOpenedCells;
+	moveLog.Truncate( undoState.MoveLogSize, undoState.NumberOfMoves );
+	if( state != previousState ) {
+		events.Push( MET_StateChanged, static_cast<int8_t>( state ), 0, 0 );
+	}
+	events.Flush();
+}
+
+// only generated tiles may have opened cells, the cells which pass
+// the comparison of the numbers are collected first, since looking up
+// their neighbors may generate tiles
+void CMinesweeperTiledGame::ChordableCells( vector<pair<size_t, size_t>>& cells ) const
+{
+	cells.clear();
+	if( state != MGS_Active ) {
+		return;
+	}
+	sortedCellIndices.clear();
+	board.ForEachTile( [this]( const CMinesweeperTile& tile ) {
+		for( size_t row = 0; row < tile.Height; row++ ) {
+			for( size_t column = 0; column < tile.Width; column++ ) {
+				const size_t offset = row * CMinesweeperTile::TileSize + column;
+				if( tile.IsOpened( offset ) && !tile.IsBomb( offset )
+					&& tile.NumberOfNeighborBombs[offset] == tile.NumberOfNeighborLabeledBombs[offset] )
+				{
+					sortedCellIndices.push_back( ( tile.FirstRow + row ) * columns
+						+ tile.FirstColumn + column );
+				}
+			}
+		}
+	} );
+	sort( sortedCellIndices.begin(), sortedCellIndices.end() );
+	for( auto i = sortedCellIndices.cbegin(); i != sortedCellIndices.cend(); ++i ) {
+		const size_t row = ( *i ) / columns;
+		const size_t column = ( *i ) % columns;
+		if( hasClosedNeighbor( row, column ) ) {
+			cells.push_back( make_pair( row, column ) );
+		}
+	}
+}
+
+vector<pair<size_t, size_t>> CMinesweeperTiledGame::ModifiedCells() const
+{
+	vector<pair<size_t, size_t>> result;
+	ModifiedCells( result );
+	return result;
+}
+
+void CMinesweeperTiledGame::ModifiedCells( vector<pair<size_t, size_t>>& cells ) const
+{
+	takeModifiedCells();
+	cells.clear();
+	cells.reserve( sortedCellIndices.size() );
+	for( auto i = sortedCellIndices.cbegin(); i != sortedCellIndices.cend(); ++i ) {
+		cells.push_back( make_pair( ( *i ) / columns, ( *i ) % columns ) );
+	}
+}
+
+void CMinesweeperTiledGame::ModifiedSpans( vector<CMinesweeperCellSpan>& spans ) const
+{
+	takeModifiedCells();
+	spans.clear();
+	for( auto i = sortedCellIndices.cbegin(); i != sortedCellIndices.cend(); ++i ) {
+		const size_t row = ( *i ) / columns;
+		const size_t column = ( *i ) % columns;
+		if( !spans.empty() && spans.back().Row == row && spans.back().EndColumn == column ) {
+			spans.back().EndColumn++;
+		} else {
+			const CMinesweeperCellSpan span = { row, column, column + 1 };
+			spans.push_back( span );
+		}
+	}
+}
+
+void CMinesweeperTiledGame::OnOpen( size_t row, size_t column )
+{
+	internal_check( state == MGS_Active );
+	counters.Add( MC_Opens, 1 );
+	const size_t offset = CMinesweeperTiledBoard::Offset( row, column );
+	// the opens of labeled cells and the chords which open no neighbors
+	// change nothing, so they are not moves, the cells of the tiles
+	// which are not generated are closed and not labeled
+	const CMinesweeperTile* const found = board.FindTile( row, column );
+	if( found != nullptr && ( found->IsOpened( offset )
+		? ( found->NumberOfNeighborBombs[offset] != found->NumberOfNeighborLabeledBombs[offset]
+			|| !hasClosedNeighbor( row, column ) )
+		: found->Label( offset ) != MCL_None ) )
+	{
+		return;
+	}
+	beginMove();
+	const TMinesweeperGameState previousState = state;
+
+	// the tile may be copied by the open, its numbers are not changed
+	const CMinesweeperTile& tile = board.Tile( row, column );
+	const size_t numberOfNeighborBombs = tile.NumberOfNeighborBombs[offset];
+	moveLog.Append( tile.IsOpened( offset ) ? MMT_Chord : MMT_Open, row * columns + column );
+	if( tile.IsOpened( offset ) ) {
+		if( numberOfNeighborBombs == tile.NumberOfNeighborLabeledBombs[offset] ) {
+			openNeighbors( row, column );
+		}
+	} else if( open( row, column ) ) {
+		// opens of labeled cells do nothing
+		if( numberOfNeighborBombs == 0 && board.Tile( row, column ).IsOpened( offset ) ) {
+			openNeighbors( row, column );
+		}
+	}
+
+	// the last safe cells may be opened by a cascade or by opening neighbors
+	if( state == MGS_Active ) {
+		hasSuccess();
+	}
+	if( state != previousState ) {
+		events.Push( MET_StateChanged, static_cast<int8_t>( state ), 0, 0 );
+	}
+	events.Flush();
+}
+
+void CMinesweeperTiledGame::OnSetLabel( size_t row, size_t column,
+	TMinesweeperCellLabel newLabel )
+{
+	const size_t offset = CMinesweeperTiledBoard::Offset( row, column );
+	const TMinesweeperCellLabel label = board.Tile( row, column ).Label( offset );
+	internal_check( !board.Tile( row, column ).IsOpened( offset ) );
+	// setting the same label changes nothing, so it is not a move
+	if( label == newLabel ) {
+		return;
+	}
+	internal_check( state == MGS_Active );
+	beginMove();
+	const int change = ( newLabel == MCL_Bomb ? 1 : 0 ) - ( label == MCL_Bomb ? 1 : 0 );
+	CMinesweeperTile& tile = board.MutableTile( row, column );
+	tile.SetLabel( offset, newLabel );
+	modified( row, column );
+	report( tile, row, column );
+	if( change != 0 ) {
+		addNeighborLabeledBombs( row, column, change );
+	}
+	moveLog.Append( static_cast<TMinesweeperMoveType>( MMT_LabelNone + newLabel ),
+		row * columns + column );
+	events.Flush();
+}
+
+void CMinesweeperTiledGame::start( uint64_t seed )
+{
+	dropUndoStates();
+	reset();
+	// the bombs of the tiles are planted lazily, only the reset is counted
+	counters.Add( MC_PlantBombs, 1 );
+	CMinesweeperCounterTimer timer( counters, MC_PlantBombsNanoseconds );
+	board.Reset( rows, columns, bombs, seed );
+	encodedCellIndices.clear();
+	encodeAll = true;
+	moveLog.ResetNotReplayable( rows, columns, bombs, seed );
+	events.Push( MET_NewGame, 0, rows, columns );
+	events.Flush();
+}
+
+// the oldest state is dropped once the ring is full, like the oldest change of the board
+void CMinesweeperTiledGame::beginMove()
+{
+	if( undoStates.empty() ) {
+		return;
+	}
+	if( numberOfUndoStates == undoStates.size() ) {
+		firstUndoState = ( firstUndoState + 1 ) % undoStates.size();
+		numberOfUndoStates--;
+	}
+	CUndoState& undoState = undoStates[( firstUndoState + numberOfUndoStates ) % undoStates.size()];
+	undoState.State = state;
+	undoState.NumberOfOpenedCells = numberOfOpenedCells;
+	undoState.MoveLogSize = moveLog.Size();
+	undoState.NumberOfMoves = moveLog.NumberOfMoves();
+	numberOfUndoStates++;
+	board.BeginChange();
+}
+
+// the board drops its changes by the reset of a new game
+void CMinesweeperTiledGame::dropUndoStates()
+{
+	firstUndoState = 0;
+	numberOfUndoStates = 0;
+}
+
+void CMinesweeperTiledGame::reset()
+{
+	state = MGS_Active;
+	modifiedCellIndices.clear();
+	numberOfOpenedCells = 0;
+}
+
+// moves the modified cells into the sorted buffer
+void CMinesweeperTiledGame::takeModifiedCells() const
+{
+	sortedCellIndices.assign( modifiedCellIndices.cbegin(), modifiedCellIndices.cend() );
+	sort( sortedCellIndices.begin(), sortedCellIndices.end() );
+	modifiedCellIndices.clear();
+}
+
+void CMinesweeperTiledGame::resize( size_t _rows, size_t _columns, size_t _bombs )
+{
+	internal_check( policy.Allows( _rows, _columns, _bombs ) );
+
+	if( _rows != rows || _columns != columns ) {
+		cells.clear();
+	}
+	rows = _rows;
+	columns = _columns;
+	bombs = _bombs;
+}
+
+void CMinesweeperTiledGame::modified( size_t row, size_t column )
+{
+	modifiedCellIndices.insert( row * columns + column );
+	if( trackEncodedCells ) {
+		encodedCellIndices.insert( row * columns + column );
+	}
+	counters.Add( MC_ModifiedCells, 1 );
+}
+
+void CMinesweeperTiledGame::report( const CMinesweeperTile& tile, size_t row, size_t column )
+{
+	if( events.IsEnabled() ) {
+		const size_t offset = CMinesweeperTiledBoard::Offset( row, column );
+		const bool isOpened = tile.IsOpened( offset );
+		events.Push( isOpened ? MET_Opened : MET_Labeled,
+			CellCode( isOpened, tile.IsBomb( offset ), tile.NumberOfNeighborBombs[offset],
+				tile.Label( offset ) ),
+			row, column );
+	}
+}
+
+bool CMinesweeperTiledGame::open( size_t row, size_t column )
+{
+	const size_t offset = CMinesweeperTiledBoard::Offset( row, column );
+	if( !board.Tile( row, column ).IsOpened( offset )
+		&& board.Tile( row, column ).Label( offset ) == MCL_None )
+	{
+		CMinesweeperTile& tile = board.MutableTile( row, column );
+		tile.SetIsOpened( offset );
+		modified( row, column );
+		report( tile, row, column );
+
+		if( tile.IsBomb( offset ) ) {
+			openBombs();
+			return false;
+		}
+
+		numberOfOpenedCells++;
+	}
+	return true;
+}
+
+// only the bits of the bomb words of the tiles are visited,
+// the tiles are copied by their first closed bomb
+void CMinesweeperTiledGame::openBombs()
+{
+	board.ForEachTile( [this]( const CMinesweeperTile& sharedTile ) {
+		CMinesweeperTile* tile = nullptr;
+		for( size_t row = 0; row < sharedTile.Height; row++ ) {
+			for( uint64_t word = sharedTile.Bombs[row]; word != 0; word &= word - 1 ) {
+				const size_t column = CountTrailingZeros( word );
+				const size_t offset = row * CMinesweeperTile::TileSize + column;
+				if( !sharedTile.IsOpened( offset ) ) {
+					if( tile == nullptr ) {
+						tile = &board.MutableTile( sharedTile.FirstRow, sharedTile.FirstColumn );
+					}
+					tile->SetIsOpened( offset );
+					modified( sharedTile.FirstRow + row, sharedTile.FirstColumn + column );
+					events.Push( MET_Opened, MCC_Bomb, sharedTile.FirstRow + row,
+						sharedTile.FirstColumn + column );
+				}
+			}
+		}
+	} );
+	board.SetRevealBombs( true );
+	state = MGS_Failure;
+	encodeAll = true;
+}
+
+// same as CMinesweeperGame::openNeighbors, the queue holds board positions
+// and the visited cells are marked in the tiles
+void CMinesweeperTiledGame::openNeighbors( size_t row, size_t column )
+{
+	const size_t numberOfOpenedCellsBefore = numberOfOpenedCells;
+	events.Push( MET_CascadeBegin, 0, row, column );
+	queue.clear();
+	visit( row, column );
+
+	size_t numberOfScanned = 0;
+	while( numberOfScanned < queue.size() ) {
+		const size_t currentRow = queue[numberOfScanned].first;
+		const size_t currentColumn = queue[numberOfScanned].second;
+		numberOfScanned++;
+		const size_t firstRow = currentRow > 0 ? currentRow - 1 : 0;
+		const size_t lastRow = currentRow + 1 < rows ? currentRow + 1 : currentRow;
+		const size_t firstColumn = currentColumn > 0 ? currentColumn - 1 : 0;
+		const size_t lastColumn = currentColumn + 1 < columns ? currentColumn + 1 : currentColumn;
+
+		bool safe = true;
+		for( size_t r = firstRow; r <= lastRow && safe; r++ ) {
+			for( size_t c = firstColumn; c <= lastColumn && safe; c++ ) {
+				const CMinesweeperTile& tile = board.Tile( r, c );
+				const size_t offset = CMinesweeperTiledBoard::Offset( r, c );
+				if( tile.IsOpened( offset )
+					|| ( tile.State[offset] & CMinesweeperTile::VisitedFlag ) != 0 )
+				{
+					continue;
+				}
+				const size_t numberOfNeighborBombs = tile.NumberOfNeighborBombs[offset];
+				if( !open( r, c ) ) {
+					safe = false;
+				} else if( numberOfNeighborBombs == 0 ) {
+					visit( r, c );
+				}
+			}
+		}
+		if( !safe ) {
+			break;
+		}
+	}
+
+	events.Push( MET_CascadeEnd, 0, row, column );
+	const size_t numberOfCascadeCells = numberOfOpenedCells - numberOfOpenedCellsBefore;
+	counters.Add( MC_FloodFills, 1 );
+	counters.Add( MC_FloodFillIterations, queue.size() );
+	counters.Add( MC_NeighborScans, numberOfScanned );
+	counters.Add( MC_CascadeCells, numberOfCascadeCells );
+	counters.Max( MC_MaxCascadeCells, numberOfCascadeCells );
+
+	for( auto i = queue.cbegin(); i != queue.cend(); ++i ) {
+		CMinesweeperTile& tile = board.MutableTile( i->first, i->second );
+		tile.State[CMinesweeperTiledBoard::Offset( i->first, i->second )]
+			&= ~CMinesweeperTile::VisitedFlag;
+	}
+}
+
+void CMinesweeperTiledGame::visit( size_t row, size_t column )
+{
+	CMinesweeperTile& tile = board.MutableTile( row, column );
+	tile.State[CMinesweeperTiledBoard::Offset( row, column )] |= CMinesweeperTile::VisitedFlag;
+	queue.push_back( make_pair( row, column ) );
+}
+
+// the neighbors may be in other tiles, they are generated by the update
+void CMinesweeperTiledGame::addNeighborLabeledBombs( size_t row, size_t column, int change )
+{
+	counters.Add( MC_NeighborScans, 1 );
+	for( size_t r = ( row > 0 ? row - 1 : 0 ); r <= row + 1 && r < rows; r++ ) {
+		for( size_t c = ( column > 0 ? column - 1 : 0 ); c <= column + 1 && c < columns; c++ ) {
+			if( r != row || c != column ) {
+				uint8_t& count = board.MutableTile( r, c ).NumberOfNeighborLabeledBombs[
+					CMinesweeperTiledBoard::Offset( r, c )];
+				count = static_cast<uint8_t>( count + change );
+			}
+		}
+	}
+}
+
+// whether some neighbor is closed and not labeled
+bool CMinesweeperTiledGame::hasClosedNeighbor( size_t row, size_t column ) const
+{
+	for( size_t r = ( row > 0 ? row - 1 : 0 ); r <= row + 1 && r < rows; r++ ) {
+		for( size_t c = ( column > 0 ? column - 1 : 0 ); c <= column + 1 && c < columns; c++ ) {
+			const CMinesweeperTile& neighborTile = board.Tile( r, c );
+			const size_t neighborOffset = CMinesweeperTiledBoard::Offset( r, c );
+			if( !neighborTile.IsOpened( neighborOffset )
+				&& neighborTile.Label( neighborOffset ) == MCL_None )
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool CMinesweeperTiledGame::hasSuccess()
+{
+	internal_check( state == MGS_Active );
+	const size_t numberOfSafeCells = rows * columns - bombs;
+	internal_check( numberOfOpenedCells <= numberOfSafeCells );
+	if( numberOfOpenedCells == numberOfSafeCells ) {
+		state = MGS_Success;
+	}
+	return ( state == MGS_Success );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+shared_ptr<IMinesweeperGame> CreateTiledGame( size_t rows, size_t columns,
+	size_t bombs, const CMinesweeperSizePolicy& policy )
+{
+	shared_ptr<CMinesweeperTiledGame> game( new CMinesweeperTiledGame( policy ) );
+	game->NewGame( rows, columns, bombs );
+	return game;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////
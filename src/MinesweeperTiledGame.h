@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Minesweeper.h>
+
+namespace Minesweeper {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// creates a game on the tiled board storage (for huge boards)
+shared_ptr<IMinesweeperGame> CreateTiledGame( size_t rows, size_t columns,
+	size_t bombs, const CMinesweeperSizePolicy& policy );
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // end of Minesweeper namespace
+
+////////////////////////////////////////////////////////////////////////////////